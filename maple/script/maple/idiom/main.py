@@ -17,7 +17,9 @@ Authors - Jie Yu (jieyu@umich.edu)
 
 import os
 import sys
+import copy
 import subprocess
+import multiprocessing
 import optparse
 from maple.core import config
 from maple.core import logging
@@ -466,6 +468,34 @@ def register_active_cmdline_options(parser, prefix=''):
             default=1,
             metavar='N',
             help='the threshold (depends on mode)')
+    parser.add_option(
+            '--%sworkers' % prefix,
+            action='store',
+            type='int',
+            dest='%sworkers' % prefix,
+            default=1,
+            metavar='N',
+            help='the number of concurrent active testing workers')
+
+def create_active_testcase(pin, scheduler, prog_argv, mode, threshold, workers):
+    if workers <= 1:
+        test = testing.InteractiveTest(prog_argv)
+        test.set_prefix(get_prefix(pin, scheduler))
+        return idiom_testing.ActiveTestCase(test, mode, threshold, scheduler)
+    # the workers share the memoization database, and use private
+    # copies of the other output files
+    testcases = []
+    for i in range(workers):
+        worker = copy.deepcopy(scheduler)
+        worker.knobs['memo_shared'] = True
+        # each worker is pinned to its own cpu
+        worker.knobs['cpu'] = (scheduler.knobs['cpu'] + i) % multiprocessing.cpu_count()
+        for k in ['sinfo_out', 'iroot_out', 'sinst_out', 'test_history', 'stat_out']:
+            worker.knobs[k] = '%s.%d' % (scheduler.knobs[k], i)
+        test = testing.InteractiveTest(prog_argv)
+        test.set_prefix(get_prefix(pin, worker))
+        testcases.append(idiom_testing.ActiveTestCase(test, mode, threshold, worker))
+    return idiom_testing.ParallelActiveTestCase(testcases)
 
 def __command_active(argv):
     pin = pintool.Pin(config.pin_home())
@@ -482,12 +512,12 @@ def __command_active(argv):
     (options, args) = parser.parse_args(opt_argv)
     scheduler.set_cmdline_options(options, args)
     # run active test
-    test = testing.InteractiveTest(prog_argv)
-    test.set_prefix(get_prefix(pin, scheduler))
-    testcase = idiom_testing.ActiveTestCase(test,
-                                            options.mode,
-                                            options.threshold,
-                                            scheduler)
+    testcase = create_active_testcase(pin,
+                                      scheduler,
+                                      prog_argv,
+                                      options.mode,
+                                      options.threshold,
+                                      options.workers)
     testcase.run()
 
 def register_random_cmdline_options(parser, prefix=''):
@@ -756,12 +786,12 @@ def __command_default(argv):
                                                      options.profile_threshold,
                                                      profiler)
     # create active testcase
-    active_test = testing.InteractiveTest(prog_argv)
-    active_test.set_prefix(get_prefix(pin, scheduler))
-    active_testcase = idiom_testing.ActiveTestCase(active_test,
-                                                   options.active_mode,
-                                                   options.active_threshold,
-                                                   scheduler)
+    active_testcase = create_active_testcase(pin,
+                                             scheduler,
+                                             prog_argv,
+                                             options.active_mode,
+                                             options.active_threshold,
+                                             options.active_workers)
     # run idiom testcase
     idiom_testcase = idiom_testing.IdiomTestCase(profile_testcase,
                                                  active_testcase)
@@ -36,3 +36,28 @@ class MemoTool(offline_tool.OfflineTool):
     def bin_path(self):
         return os.path.join(config.build_home(self.debug), 'idiom_memo_tool')
 
+
+class PredictorLoader(offline_tool.OfflineTool):
+    def __init__(self):
+        offline_tool.OfflineTool.__init__(self, 'idiom_predictor_loader')
+        self.register_knob('debug_out', 'string', 'stdout', 'the output file for the debug messages')
+        self.register_knob('sinfo_in', 'string', 'sinfo.db', 'the input static info database path', 'PATH')
+        self.register_knob('sinfo_out', 'string', 'sinfo.db', 'the output static info database path', 'PATH')
+        self.register_knob('trace_log_path', 'string', 'trace-log', 'the trace log path', 'PATH')
+        self.register_knob('num_shards', 'int', 1, 'the number of threads replaying the trace (memory accesses are partitioned by address)', 'N')
+        self.register_knob('shard_unit', 'int', 64, 'the size of the address ranges assigned to shards (power of 2)', 'SIZE')
+        self.register_knob('memo_failed', 'bool', True, 'whether memoize fail-to-expose iroots')
+        self.register_knob('iroot_in', 'string', 'iroot.db', 'the input iroot database path', 'PATH')
+        self.register_knob('iroot_out', 'string', 'iroot.db', 'the output iroot database path', 'PATH')
+        self.register_knob('memo_in', 'string', 'memo.db', 'the input memoization database path', 'PATH')
+        self.register_knob('memo_out', 'string', 'memo.db', 'the output memoization database path', 'PATH')
+        self.register_knob('sinst_in', 'string', 'sinst.db', 'the input shared inst database path', 'PATH')
+        self.register_knob('enable_predictor', 'bool', True, 'whether enable the iroot predictor')
+        self.register_knob('sync_only', 'bool', False, 'whether only monitor synchronization accesses')
+        self.register_knob('complex_idioms', 'bool', False, 'whether target complex idioms')
+        self.register_knob('racy_only', 'bool', False, 'whether only consider sync and racy memory dependencies')
+        self.register_knob('predict_deadlock', 'bool', False, 'whether predict and trigger deadlocks (experimental)')
+        self.register_knob('unit_size', 'int', 4, 'the monitoring granularity in bytes', 'SIZE')
+        self.register_knob('vw', 'int', 1000, 'the vulnerability window (# dynamic inst)', 'SIZE')
+    def bin_path(self):
+        return os.path.join(config.build_home(self.debug), 'idiom_predictor_loader')
@@ -36,6 +36,8 @@ class Observer(analyzer.Analyzer):
         self.register_knob('complex_idioms', 'bool', False, 'whether target complex idioms')
         self.register_knob('unit_size', 'int', 4, 'the monitoring granularity in bytes', 'SIZE')
         self.register_knob('vw', 'int', 1000, 'the vulnerability window (# dynamic inst)', 'SIZE')
+        self.register_knob('observer_max_succs', 'int', 4, 'the max number of successors recorded for each local access (complex idioms)', 'SIZE')
+        self.register_knob('observer_max_local_prevs', 'int', 8, 'the max number of local predecessors recorded for each successor (idiom-5)', 'SIZE')
 
 class ObserverNew(analyzer.Analyzer):
     def __init__(self):
@@ -103,6 +105,9 @@ class PctProfiler(Profiler):
         self.register_knob('depth', 'int', 3, 'the target bug depth', 'DEPTH')
         self.register_knob('count_mem', 'bool', True, 'whether use the number of memory accesses as thread counter')
         self.register_knob('pct_history', 'string', 'pct.histo', 'the pct history file path', 'PATH')
+        self.register_knob('user_sched', 'bool', False, 'whether schedule threads in user space using per thread semaphores (threads in blocking syscalls rejoin in kernel order, which the random seed does not determine)')
+        self.register_knob('user_wake_spins', 'int', 10000, 'the max number of sched_yield calls to wait for the threads woken by a futex to rejoin', 'N')
+        self.register_knob('random_seed', 'int', 0, 'the random seed (0 means using current time)', 'SEED')
     def so_path(self):
         return os.path.join(config.build_home(self.debug), 'idiom_pct_profiler.so')
 
@@ -152,6 +157,7 @@ class Scheduler(pintool.Pintool):
         self.register_knob('random_seed',  'int', 0, 'the random seed (0 means using current time)', 'SEED')
         self.register_knob('target_iroot', 'int', 0, 'the target iroot (0 means choosing any)', 'ID')
         self.register_knob('target_idiom', 'int', 0, 'the target idiom (0 means any idiom)', 'IDIOM')
+        self.register_knob('batch_size', 'int', 1, 'the max number of disjoint iroots to test in one execution', 'N')
         self.register_knob('memo_failed', 'bool', True, 'whether memoize fail-to-expose iroots')
         self.register_knob('yield_with_delay', 'bool', True, 'whether inject delays for async iroots')
         self.register_knob('test_history', 'string', 'test.histo', 'the test history file path', 'PATH')
@@ -163,6 +169,7 @@ class Scheduler(pintool.Pintool):
         self.register_knob('iroot_out', 'string', 'iroot.db', 'the output iroot database path', 'PATH')
         self.register_knob('memo_in', 'string', 'memo.db', 'the input memoization database path', 'PATH')
         self.register_knob('memo_out', 'string', 'memo.db', 'the output memoization database path', 'PATH')
+        self.register_knob('memo_shared', 'bool', False, 'whether the memoization database is shared by concurrent runs')
         self.register_knob('sinst_in', 'string', 'sinst.db', 'the input shared inst database path', 'PATH')
         self.register_knob('sinst_out', 'string', 'sinst.db', 'the output shared inst database path', 'PATH')
         self.add_analyzer(SinstAnalyzer())
@@ -16,6 +16,7 @@ Authors - Jie Yu (jieyu@umich.edu)
 """
 
 import os
+import threading
 from maple.core import config
 from maple.core import logging
 from maple.core import static_info
@@ -145,7 +146,10 @@ class ActiveTestCase(testing.DeathTestCase):
     def __init__(self, test, mode, threshold, scheduler):
         testing.DeathTestCase.__init__(self, test, mode, threshold)
         self.scheduler = scheduler
+        self.group = None
     def threshold_check(self):
+        if self.group != None and self.group.stopping:
+            return True
         if not has_candidate(self.scheduler):
             return True
         if testing.DeathTestCase.threshold_check(self):
@@ -167,6 +171,51 @@ class ActiveTestCase(testing.DeathTestCase):
         logging.msg('%-15s %d\n' % ('active_runs', runs))
         logging.msg('%-15s %f\n' % ('active_time', used_time))
 
+class ParallelActiveTestCase(testing.TestCase):
+    """ Run several active test cases concurrently. The schedulers of
+    the workers share one memoization database (memo_shared), which
+    hands out distinct iroots to them and merges their results.
+    """
+    def __init__(self, workers):
+        testing.TestCase.__init__(self)
+        self.workers = workers
+        self.stopping = False
+        for w in self.workers:
+            w.group = self
+    def is_fatal(self):
+        assert self.done
+        for w in self.workers:
+            if w.is_fatal():
+                return True
+        return False
+    def setup(self):
+        # remove stale claims left by the previous runs
+        memo_out = self.workers[0].scheduler.knobs['memo_out']
+        journal = os.path.realpath(memo_out) + '.journal'
+        if os.path.exists(journal):
+            os.remove(journal)
+    def run_worker(self, worker):
+        worker.run()
+        # stop the other workers once a bug is found
+        if worker.is_fatal():
+            self.stopping = True
+    def body(self):
+        threads = []
+        for w in self.workers:
+            t = threading.Thread(target=self.run_worker, args=(w,))
+            t.start()
+            threads.append(t)
+        for t in threads:
+            t.join()
+    def log_stat(self):
+        runs = 0
+        for w in self.workers:
+            runs += len(w.test_history)
+        used_time = self.used_time()
+        logging.msg('%-15s %d\n' % ('active_workers', len(self.workers)))
+        logging.msg('%-15s %d\n' % ('active_runs', runs))
+        logging.msg('%-15s %f\n' % ('active_time', used_time))
+
 class IdiomTestCase(testing.TestCase):
     """ Represent the default idiom test process, that is, profile
     first then active test.
@@ -29,10 +29,13 @@ class HistoryEntry(object):
         return self.proto.inst_count
     def num_threads(self):
         return self.proto.num_threads
+    def seed(self):
+        return self.proto.seed
     def __str__(self):
         content = []
         content.append('%-4d' % self.num_threads())
-        content.append('%d' % self.inst_count())
+        content.append('%-12d' % self.inst_count())
+        content.append('%d' % self.seed())
         return ' '.join(content)
 
 class History(object):
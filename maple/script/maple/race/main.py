@@ -24,6 +24,7 @@ from maple.core import static_info
 from maple.core import pintool
 from maple.core import testing
 from maple.race import race
+from maple.race import offline_tool as race_offline_tool
 from maple.race import pintool as race_pintool
 from maple.race import testing as race_testing
 
@@ -159,6 +160,15 @@ def __command_display(argv):
     else:
         output.close()
 
+def __command_symbolize(argv):
+    usage = 'usage: <script> symbolize [options]'
+    parser = optparse.OptionParser(usage)
+    symbolizer = race_offline_tool.Symbolizer()
+    symbolizer.register_cmdline_options(parser)
+    (options, args) = parser.parse_args(argv)
+    symbolizer.set_cmdline_options(options, args)
+    symbolizer.call()
+
 def register_race_cmdline_options(parser, prefix=''):
     parser.add_option(
             '--%smode' % prefix,
@@ -0,0 +1,31 @@
+"""Copyright 2011 The University of Michigan
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Authors - Jie Yu (jieyu@umich.edu)
+"""
+
+import os
+from maple.core import config
+from maple.core import offline_tool
+
+class Symbolizer(offline_tool.OfflineTool):
+    def __init__(self):
+        offline_tool.OfflineTool.__init__(self, 'race_symbolizer')
+        self.register_knob('debug_out', 'string', 'stdout', 'the output file for the debug messages')
+        self.register_knob('sinfo_in', 'string', 'sinfo.db', 'the input static info database path', 'PATH')
+        self.register_knob('sinfo_out', 'string', 'sinfo.db', 'the output static info database path', 'PATH')
+        self.register_knob('race_in', 'string', 'race.db', 'the input race database path', 'PATH')
+        self.register_knob('exec_id', 'int', -1, 'only report races found in this execution (-1 for all executions)')
+    def bin_path(self):
+        return os.path.join(config.build_home(self.debug), 'race_symbolizer')
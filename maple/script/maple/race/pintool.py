@@ -53,6 +53,9 @@ class PctProfiler(Profiler):
         self.register_knob('depth', 'int', 3, 'the target bug depth', 'DEPTH')
         self.register_knob('count_mem', 'bool', True, 'whether use the number of memory accesses as thread counter')
         self.register_knob('pct_history', 'string', 'pct.histo', 'the pct history file path', 'PATH')
+        self.register_knob('user_sched', 'bool', False, 'whether schedule threads in user space using per thread semaphores (threads in blocking syscalls rejoin in kernel order, which the random seed does not determine)')
+        self.register_knob('user_wake_spins', 'int', 10000, 'the max number of sched_yield calls to wait for the threads woken by a futex to rejoin', 'N')
+        self.register_knob('random_seed', 'int', 0, 'the random seed (0 means using current time)', 'SEED')
     def so_path(self):
         return os.path.join(config.build_home(self.debug), 'race_pct_profiler.so')
 
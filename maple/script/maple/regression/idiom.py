@@ -25,8 +25,10 @@ from maple.core import logging
 from maple.core import pintool
 from maple.core import testing
 from maple.idiom import pintool as idiom_pintool
+from maple.idiom import offline_tool as idiom_offline_tool
 from maple.idiom import testing as idiom_testing
 from maple.regression import common
+from maple.tracer import pintool as tracer_pintool
 
 def get_prefix(pin, tool):
     c = []
@@ -128,6 +130,64 @@ def idiom_observer(suite):
             common.echo(suite, 'failed!')
         return success
 
+def idiom_loader(suite):
+    assert common.is_testcase(suite)
+    clean_currdir()
+    testcase = common.testcase_name(suite)
+    source_path = common.source_path(suite)
+    script_path = common.script_path(suite)
+    target_path = os.path.join(os.getcwd(), 'target')
+    output_path = os.path.join(os.getcwd(), 'stdout')
+    f, p, d = imp.find_module(testcase, [os.path.dirname(script_path)])
+    module = imp.load_module(testcase, f, p, d)
+    f.close()
+    flags = common.default_flags(suite)
+    if hasattr(module, 'disabled'):
+        common.echo(suite, 'disabled!')
+        return True
+    if hasattr(module, 'setup_flags'):
+        module.setup_flags(flags)
+    if not common.compile(source_path, target_path, flags, True):
+        common.echo(suite, 'failed! compile error')
+        return False
+    # record the trace
+    pin = pintool.Pin(config.pin_home())
+    recorder = tracer_pintool.Profiler()
+    recorder.knobs['enable_recorder'] = True
+    if hasattr(module, 'setup_recorder'):
+        module.setup_recorder(recorder)
+    test = testing.InteractiveTest([target_path], sout=output_path)
+    test.set_prefix(get_prefix(pin, recorder))
+    logging.message_off()
+    test.run()
+    logging.message_on()
+    # replay the trace with different numbers of shards
+    loaders = {}
+    for num_shards in module.num_shards():
+        loader = idiom_offline_tool.PredictorLoader()
+        loader.knobs['sinfo_in'] = 'sinfo.db'
+        loader.knobs['sinfo_out'] = 'sinfo-%d.db' % num_shards
+        loader.knobs['trace_log_path'] = recorder.knobs['trace_log_path']
+        loader.knobs['num_shards'] = num_shards
+        loader.knobs['iroot_in'] = 'iroot-%d.db' % num_shards
+        loader.knobs['iroot_out'] = 'iroot-%d.db' % num_shards
+        loader.knobs['memo_in'] = 'memo-%d.db' % num_shards
+        loader.knobs['memo_out'] = 'memo-%d.db' % num_shards
+        if hasattr(module, 'setup_loader'):
+            module.setup_loader(loader)
+        loader.run()
+        loaders[num_shards] = loader
+    if not hasattr(module, 'verify'):
+        common.echo(suite, 'failed! no verify')
+        return False
+    else:
+        success = module.verify(loaders)
+        if success:
+            common.echo(suite, 'succeeded!')
+        else:
+            common.echo(suite, 'failed!')
+        return success
+
 def handle(suite):
     if common.is_package(suite):
         fail = False
@@ -87,6 +87,67 @@ def systematic_chess(suite):
             common.echo(suite, 'failed!')
         return success
 
+class ReplayRun(object):
+    def __init__(self, name, target_path):
+        self.output_path = os.path.join(os.getcwd(), name + '.stdout')
+        self.controller = systematic_pintool.Controller()
+        self.controller.debug = True
+        self.test = testing.InteractiveTest([target_path],
+                                            sout=self.output_path,
+                                            serr=self.output_path)
+    def run(self, pin):
+        self.test.set_prefix(get_prefix(pin, self.controller))
+        logging.message_off()
+        self.test.run()
+        logging.message_on()
+
+def systematic_replay(suite):
+    assert common.is_testcase(suite)
+    clean_currdir()
+    testcase = common.testcase_name(suite)
+    source_path = common.source_path(suite)
+    script_path = common.script_path(suite)
+    target_path = os.path.join(os.getcwd(), 'target')
+    f, p, d = imp.find_module(testcase, [os.path.dirname(script_path)])
+    module = imp.load_module(testcase, f, p, d)
+    f.close()
+    flags = common.default_flags(suite)
+    if hasattr(module, 'disabled'):
+        common.echo(suite, 'disabled!')
+        return True
+    if hasattr(module, 'setup_flags'):
+        module.setup_flags(flags)
+    if not common.compile(source_path, target_path, flags, True):
+        common.echo(suite, 'failed! compile error')
+        return False
+    pin = pintool.Pin(config.pin_home())
+    # record a random schedule, replay it (recording again), and replay
+    # a schedule that does not exist
+    record = ReplayRun('record', target_path)
+    record.controller.knobs['enable_random_scheduler'] = True
+    record.controller.knobs['schedule_out'] = 'record.db'
+    replay = ReplayRun('replay', target_path)
+    replay.controller.knobs['enable_replay_scheduler'] = True
+    replay.controller.knobs['schedule_in'] = 'record.db'
+    replay.controller.knobs['schedule_out'] = 'replay.db'
+    missing = ReplayRun('missing', target_path)
+    missing.controller.knobs['enable_replay_scheduler'] = True
+    missing.controller.knobs['schedule_in'] = 'missing.db'
+    for r in [record, replay, missing]:
+        if hasattr(module, 'setup_controller'):
+            module.setup_controller(r.controller)
+        r.run(pin)
+    if not hasattr(module, 'verify'):
+        common.echo(suite, 'failed! no verify')
+        return False
+    else:
+        success = module.verify(record, replay, missing)
+        if success:
+            common.echo(suite, 'succeeded!')
+        else:
+            common.echo(suite, 'failed!')
+        return success
+
 def handle(suite):
     if common.is_package(suite):
         fail = False
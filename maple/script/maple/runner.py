@@ -13,11 +13,11 @@ from maple.race import testing as race_testing
 from maple.systematic import program
 from maple.systematic import search
 
-from maple.proto.systematic.search_pb2 import SearchInfoProto
 from shutil import copyfile
 import shutil
 import threading
 import signal
+import json
 
 PIN_HOME = os.environ["PIN_HOME"]
 MODE = "mode"
@@ -26,6 +26,7 @@ RACE = "race" in os.environ
 RANDOM = "random" in os.environ
 BUILD_DIR = "build-"+("debug" if DEBUG else "release")
 ATTACH = "attach" in os.environ
+THROUGHPUT = "throughput" in os.environ
 
 
 pinbin = PIN_HOME+"/"+"pin.sh"
@@ -36,6 +37,9 @@ sinfo_db = "sinfo.db"
 program_db = "program.db"
 por_info = "por_info"
 race_db = "race.db"
+stat_out = "stat.out"
+exec_result = "exec_result.json"
+exec_schedule = "exec_schedule.db"
 
 unit_size="1"
 
@@ -47,10 +51,7 @@ def done():
 #    search_info = search.SearchInfo(sinfo, program)
 #    search_info.load(sinfo_db)
     
-    searchInfo = SearchInfoProto()
-    f = open(search_db, 'rb')
-    searchInfo.ParseFromString(f.read())
-    f.close()
+    searchInfo = search.load_proto(search_db)
     #print len(searchInfo.node)
     #subprocess.call(["ls"])
     #print "Number of scheduling points: "+str(len(searchInfo.node))
@@ -86,6 +87,93 @@ def done():
     return searchInfo.done
 #    return search_info.done()
 
+def readStats(filename):
+    # parse the "name value" lines of a stat file written by the pintool
+    stats = {}
+    try:
+        with open(filename, 'r') as f:
+            for line in f:
+                if line.startswith(' '):
+                    continue
+                parts = line.split()
+                if len(parts) == 2 and parts[1].isdigit():
+                    stats[parts[0]] = int(parts[1])
+    except IOError:
+        pass
+    return stats
+
+# controller timers (in microseconds) averaged in the throughput report
+throughputTimers = ["us_startup", "us_program_load", "us_race_load",
+                    "us_sched_load", "us_program", "us_handoff",
+                    "us_sched_save", "us_program_save", "us_race_save",
+                    "us_tool"]
+
+def recordThroughput(report, seconds, stats):
+    wallUs = int(seconds * 1000000)
+    report["executions"] += 1
+    report["wall_us"] += wallUs
+    # executions that exit early (e.g. search done) have no timers
+    if "us_tool" not in stats:
+        return
+    report["timed_executions"] += 1
+    report["timed_wall_us"] += wallUs
+    report["pin_us"] += max(wallUs - stats["us_tool"], 0)
+    report["visible_ops"] += stats.get("num_handoff", 0)
+    for t in throughputTimers:
+        report[t] = report.get(t, 0) + stats.get(t, 0)
+
+def writeThroughput(report, seconds, filename):
+    def rate(n, s):
+        if s <= 0:
+            return 0.0
+        return n / float(s)
+    timed = report["timed_executions"]
+    perExecution = {}
+    if timed > 0:
+        perExecution["wall_us"] = report["timed_wall_us"] / timed
+        perExecution["pin_us"] = report["pin_us"] / timed
+        for t in throughputTimers:
+            perExecution[t] = report.get(t, 0) / timed
+        # everything but the program itself is paid once per execution
+        perExecution["fixed_us"] = perExecution["wall_us"] - perExecution["us_program"]
+    out = {"name": os.environ.get("throughput_name", ""),
+           "mode": os.environ[MODE],
+           "executions": report["executions"],
+           "timed_executions": timed,
+           "run_seconds": seconds,
+           "schedules_per_second": rate(report["executions"], seconds),
+           "visible_ops": report["visible_ops"],
+           "visible_ops_per_second": rate(report["visible_ops"], report["timed_wall_us"] / 1000000.0),
+           "per_execution": perExecution}
+    with open(filename, 'w') as f:
+        json.dump(out, f, indent=2, sort_keys=True)
+    print "throughput report: " + filename
+
+def readExecResult(filename):
+    # the result record written by the controller (-result_out)
+    try:
+        with open(filename, 'r') as f:
+            return json.loads(f.read())
+    except (IOError, ValueError):
+        return None
+
+def keepSchedule(record, schedulesDir):
+    # keep the recorded schedule of a buggy execution, it can be replayed
+    # with -enable_replay_scheduler 1 -schedule_in <file>
+    if record["bug"] in ("none", "interrupted", "step_limit", "livelock"):
+        return
+    if not os.path.exists(exec_schedule):
+        return
+    if not os.path.isdir(schedulesDir):
+        os.makedirs(schedulesDir)
+    copyfile(exec_schedule,
+             os.path.join(schedulesDir, str(record["index"]) + ".schedule.db"))
+
+def appendResult(filename, record):
+    # one json record per line, never rewritten
+    with open(filename, 'a') as f:
+        f.write(json.dumps(record, sort_keys=True) + "\n")
+
 origdir = os.path.abspath(os.curdir)
 lock = threading.RLock()
 proc = None
@@ -213,6 +301,10 @@ def main(argv):
         os.remove("search.db")
     except OSError:
         pass
+    try:
+        os.remove("search.db.log")
+    except OSError:
+        pass
     try:
         os.remove("sinfo.db")
     except OSError:
@@ -220,6 +312,8 @@ def main(argv):
     
     os.environ["LD_LIBRARY_PATH"]=os.curdir+os.pathsep+os.environ.get("LD_LIBRARY_PATH", "")
     
+    resultsOut = os.environ.get("results_out", "results.jsonl")
+    startIndex = 0
     if os.environ[MODE] == "pct" or os.environ[MODE] == "random":
         runSeed = int(os.environ["seed"])
         startIndex = int(os.environ["start_index"])
@@ -228,6 +322,10 @@ def main(argv):
         for i in range(0,startIndex):
             random.getrandbits(32)
         
+    throughputReport = {"executions": 0, "timed_executions": 0,
+                        "wall_us": 0, "timed_wall_us": 0, "pin_us": 0,
+                        "visible_ops": 0}
+    
     runStart = time.time()
     
     for i in range(1,int(os.environ["limit"])+1):
@@ -483,6 +581,13 @@ def main(argv):
         else:
             print "Need to set mode env var"
             sys.exit(2)
+        if os.environ[MODE] != "race":
+            # insert before the trailing "--"
+            pincmd[-1:-1] = ["-result_out", exec_result,
+                             "-schedule_out", exec_schedule,
+                             "-max_steps", os.environ.get("step_limit", "0"),
+                             "-livelock_windows", os.environ.get("livelock_windows", "0"),
+                             "-virtual_time", os.environ.get("virtual_time", "0")]
         pincmd.insert(1, "child")
         pincmd.insert(1, "-injection")
         if ATTACH:
@@ -494,6 +599,7 @@ def main(argv):
         print " ".join(pincmd+argv)
         
         outContentsAfter = None
+        outputMismatch = False
         
         if len(outFilename) > 0 and outContents == None:
             try:
@@ -508,6 +614,17 @@ def main(argv):
 #             sys.stdout.flush()
 #             subprocess.call(argv)
 #         else:
+        # do not pick up the results of a previous execution
+        for f in [exec_result, exec_schedule]:
+            try:
+                os.remove(f)
+            except OSError:
+                pass
+        if THROUGHPUT:
+            try:
+                os.remove(stat_out)
+            except OSError:
+                pass
         sys.stdout.flush()
         #subprocess.call(pincmd + argv)
         with lock:
@@ -525,6 +642,7 @@ def main(argv):
                     outContentsAfter = outFile.read()
                 if outContents != outContentsAfter:
                     print "ERROR: Output "+outFilename+" did not match first output!"
+                    outputMismatch = True
                     copyfile(outFilename, "DIFFERENT_OUT.txt")
             except IOError as e:
                 print "ERROR: Failed to read output file " + outFilename + "!"
@@ -537,6 +655,27 @@ def main(argv):
         sys.stdout.flush()
         sys.stderr.flush()
         
+        record = readExecResult(exec_result)
+        if record == None:
+            # the controller did not get to write a record
+            record = {"bug": "none" if proc.returncode in (0, 77, 78, 79) else "unknown"}
+            record["executed"] = False
+        else:
+            record["executed"] = True
+        if outputMismatch and record["bug"] == "none":
+            record["bug"] = "output_mismatch"
+        record["index"] = startIndex + i
+        record["mode"] = os.environ[MODE]
+        record["bound"] = int(os.environ["bound"])
+        record["exec_seed"] = executionSeed
+        record["exit_code"] = proc.returncode
+        record["wall_us"] = int((executionEnd-executionStart) * 1000000)
+        appendResult(resultsOut, record)
+        keepSchedule(record, os.environ.get("schedules_dir", "schedules"))
+        
+        if THROUGHPUT:
+            recordThroughput(throughputReport, executionEnd-executionStart, readStats(stat_out))
+        
         
         if os.environ[MODE] != "random" and os.environ[MODE] != "pct":
             if os.environ[MODE] != "chess" or proc.returncode == 77:
@@ -547,6 +686,10 @@ def main(argv):
     
     print "run time: " + str(runEnd-runStart) + " seconds"
     
+    if THROUGHPUT:
+        writeThroughput(throughputReport, runEnd-runStart,
+                        os.environ.get("throughput_out", "throughput.json"))
+    
     if os.environ["cluster"] == "1" and os.environ[MODE]=="race":
         print "Copying run_race back to home."
         sys.stdout.flush()
@@ -49,9 +49,13 @@ class Controller(pintool.Pintool):
         self.register_knob('program_out', 'string', 'program.db', 'the output database for the modeled program', 'PATH')
         self.register_knob('race_in', 'string', 'race.db', 'the input race database path', 'PATH')
         self.register_knob('race_out', 'string', 'race.db', 'the output race database path', 'PATH')
+        self.register_knob('virtual_time', 'bool', False, 'model sleeps, poll/select/epoll timeouts and clock reads with a virtual clock instead of waiting in real time')
+        self.register_knob('vtime_tick_us', 'int', 1000, 'the virtual time that passes at each clock read when virtual_time is enabled (in microseconds)', 'US')
+        self.register_knob('schedule_out', 'string', '', 'the output file for the schedule of this execution (empty to disable)', 'PATH')
         self.add_analyzer(Djit())
         self.add_scheduler(scheduler.RandomScheduler())
         self.add_scheduler(scheduler.ChessScheduler())
+        self.add_scheduler(scheduler.ReplayScheduler())
     def so_path(self):
         return os.path.join(config.build_home(self.debug), 'systematic_controller.so')
     def add_scheduler(self, s):
@@ -38,5 +38,11 @@ class ChessScheduler(Scheduler):
         self.register_knob('pb_limit', 'int', 2, 'the maximum number of preemption an execution can have', 'LIMIT')
         self.register_knob('search_in', 'string', 'search.db', 'the input file that contains the search information', 'PATH')
         self.register_knob('search_out', 'string', 'search.db', 'the output file that contains the search information', 'PATH')
+        self.register_knob('search_compact', 'int', 32, 'the number of incremental search info updates before the whole stack is rewritten (0 to always rewrite)', 'N')
         self.register_knob('por_info_path', 'string', 'por-info', 'the dir path that stores the partial order reduction information', 'PATH')
 
+class ReplayScheduler(Scheduler):
+    def __init__(self):
+        Scheduler.__init__(self, 'replay_scheduler')
+        self.register_knob('enable_replay_scheduler', 'bool', False, 'whether replay a recorded schedule')
+        self.register_knob('schedule_in', 'string', 'schedule.db', 'the input file that contains the schedule to replay', 'PATH')
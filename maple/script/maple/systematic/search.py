@@ -16,12 +16,47 @@ Authors - Jie Yu (jieyu@umich.edu)
 """
 
 import os
+import struct
 from maple.core import proto
 from maple.systematic import program
 
 def search_pb2():
     return proto.module('systematic.search_pb2')
 
+def load_proto(db_name):
+    # load the snapshot and apply the update log (db_name.log) written by
+    # the pintool, each entry is a 4-byte size and a SearchUpdateProto.
+    # entries with a different log id were written before the snapshot
+    info = search_pb2().SearchInfoProto()
+    if os.path.exists(db_name):
+        f = open(db_name, 'rb')
+        info.ParseFromString(f.read())
+        f.close()
+    log_name = db_name + '.log'
+    if not os.path.exists(log_name):
+        return info
+    f = open(log_name, 'rb')
+    data = f.read()
+    f.close()
+    pos = 0
+    while pos + 4 <= len(data):
+        size = struct.unpack('<I', data[pos:pos+4])[0]
+        pos += 4
+        if pos + size > len(data):
+            break
+        update = search_pb2().SearchUpdateProto()
+        update.ParseFromString(data[pos:pos+size])
+        pos += size
+        if update.log_id != info.log_id:
+            continue
+        del info.node[update.prefix:]
+        for node_proto in update.node:
+            info.node.add().CopyFrom(node_proto)
+        info.done = update.done
+        info.num_runs = update.num_runs
+        info.preempted_insts.extend(update.preempted_insts)
+    return info
+
 class ActionInfo(object):
     def __init__(self, proto, node):
         self.proto = proto
@@ -102,11 +137,7 @@ class SearchInfo(object):
         self.proto = search_pb2().SearchInfoProto()
         self.node_vec = []
     def load(self, db_name):
-        if not os.path.exists(db_name):
-            return
-        f = open(db_name, 'rb')
-        self.proto.ParseFromString(f.read())
-        f.close()
+        self.proto = load_proto(db_name)
         for node_proto in self.proto.node:
             node = SearchNode(node_proto, self)
             self.node_vec.append(node)
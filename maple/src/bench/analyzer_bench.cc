@@ -0,0 +1,212 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: bench/analyzer_bench.cc - Implement the command line tool that
+// measures the per event cost of analyzers.
+
+#include "bench/analyzer_bench.h"
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "core/callstack.h"
+#include "idiom/iroot.h"
+#include "idiom/memo.h"
+#include "idiom/observer.h"
+#include "idiom/predictor.h"
+#include "sinst/analyzer.h"
+#include "sinst/sinst.h"
+#include "tracer/recorder.h"
+
+// count the allocations made through operator new
+static volatile unsigned long num_allocs = 0;
+
+void *operator new(size_t size) {
+  num_allocs++;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) {
+  num_allocs++;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) {
+  free(p);
+}
+
+void operator delete[](void *p) {
+  free(p);
+}
+
+namespace bench {
+
+NullAnalyzer::NullAnalyzer() {
+  desc_.SetHookBeforeMem();
+  desc_.SetHookAfterMem();
+  desc_.SetHookPthreadFunc();
+  desc_.SetHookMallocFunc();
+  desc_.SetHookCallReturn();
+}
+
+AnalyzerBench::AnalyzerBench() {
+  // empty
+}
+
+void AnalyzerBench::HandlePreSetup() {
+  OfflineTool::HandlePreSetup();
+
+  knob_->RegisterStr("bench_analyzers", "the comma separated analyzers to measure (null, sinst, predictor, observer, recorder, callstack)", "null,sinst,predictor,observer,recorder,callstack");
+  knob_->RegisterInt("bench_threads", "the number of threads in the stream", "4");
+  knob_->RegisterInt("bench_events", "the number of events in the stream", "1000000");
+  knob_->RegisterInt("bench_insts", "the number of static instructions in the stream", "1000");
+  knob_->RegisterInt("bench_shared_size", "the bytes of data shared by all threads", "65536");
+  knob_->RegisterInt("bench_private_size", "the bytes of data accessed by each thread only", "65536");
+  knob_->RegisterInt("bench_shared_ratio", "the percentage of accesses to the shared data", "20");
+  knob_->RegisterInt("bench_write_ratio", "the percentage of accesses that are writes", "30");
+  knob_->RegisterInt("bench_lock_rate", "the number of critical sections per 1000 events", "10");
+  knob_->RegisterInt("bench_cond_rate", "the number of cond wait/signal handoffs per 1000 events", "1");
+  knob_->RegisterInt("bench_malloc_rate", "the number of malloc/free calls per 1000 events", "2");
+  knob_->RegisterInt("bench_call_rate", "the number of call/return pairs per 1000 events", "20");
+  knob_->RegisterInt("bench_seed", "the random seed of the stream", "1");
+
+  // register the knobs of the measured analyzers
+  (new sinst::SharedInstAnalyzer)->Register();
+  (new idiom::Predictor)->Register();
+  (new idiom::Observer)->Register();
+  (new tracer::RecorderAnalyzer)->Register();
+}
+
+void AnalyzerBench::HandlePostSetup() {
+  OfflineTool::HandlePostSetup();
+
+  // the benchmark instructions are not saved
+  read_only_ = true;
+
+  StreamConfig config;
+  config.num_threads = knob_->ValueInt("bench_threads");
+  config.num_events = knob_->ValueInt("bench_events");
+  config.num_insts = knob_->ValueInt("bench_insts");
+  config.shared_size = knob_->ValueInt("bench_shared_size");
+  config.private_size = knob_->ValueInt("bench_private_size");
+  config.shared_ratio = knob_->ValueInt("bench_shared_ratio");
+  config.write_ratio = knob_->ValueInt("bench_write_ratio");
+  config.lock_rate = knob_->ValueInt("bench_lock_rate");
+  config.cond_rate = knob_->ValueInt("bench_cond_rate");
+  config.malloc_rate = knob_->ValueInt("bench_malloc_rate");
+  config.call_rate = knob_->ValueInt("bench_call_rate");
+  config.seed = (unsigned int)knob_->ValueInt("bench_seed");
+  stream_.Generate(sinfo_, config);
+}
+
+void AnalyzerBench::HandleStart() {
+  printf("%lu events, %d threads\n", (unsigned long)stream_.size(),
+         knob_->ValueInt("bench_threads"));
+  printf("%-12s %12s %14s %14s\n", "analyzer", "ns/event", "allocs/event",
+         "peak rss (kB)");
+  fflush(stdout);
+
+  std::stringstream ss(knob_->ValueStr("bench_analyzers"));
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    if (name.empty())
+      continue;
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      break;
+    } else if (pid == 0) {
+      Measure(name);
+      fflush(stdout);
+      _exit(0);
+    } else {
+      int status;
+      waitpid(pid, &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status))
+        printf("%-12s failed\n", name.c_str());
+    }
+  }
+}
+
+Analyzer *AnalyzerBench::CreateAnalyzer(const std::string &name) {
+  if (name == "null") {
+    return new NullAnalyzer;
+  } else if (name == "sinst") {
+    sinst::SharedInstAnalyzer *analyzer = new sinst::SharedInstAnalyzer;
+    analyzer->Setup(CreateMutex(), new sinst::SharedInstDB(CreateMutex()));
+    return analyzer;
+  } else if (name == "predictor" || name == "observer") {
+    idiom::iRootDB *iroot_db = new idiom::iRootDB(CreateMutex());
+    idiom::Memo *memo = new idiom::Memo(CreateMutex(), iroot_db);
+    sinst::SharedInstDB *sinst_db = new sinst::SharedInstDB(CreateMutex());
+    if (name == "predictor") {
+      idiom::Predictor *analyzer = new idiom::Predictor;
+      analyzer->Setup(CreateMutex(), sinfo_, iroot_db, memo, sinst_db);
+      return analyzer;
+    } else {
+      idiom::Observer *analyzer = new idiom::Observer;
+      analyzer->Setup(CreateMutex(), sinfo_, iroot_db, memo, sinst_db);
+      return analyzer;
+    }
+  } else if (name == "recorder") {
+    tracer::RecorderAnalyzer *analyzer = new tracer::RecorderAnalyzer;
+    analyzer->Setup(CreateMutex());
+    return analyzer;
+  } else if (name == "callstack") {
+    return new CallStackTracker(new CallStackInfo(CreateMutex()));
+  }
+  return NULL;
+}
+
+void AnalyzerBench::Measure(const std::string &name) {
+  Analyzer *analyzer = CreateAnalyzer(name);
+  if (!analyzer) {
+    fprintf(stderr, "unknown analyzer: %s\n", name.c_str());
+    _exit(1);
+  }
+
+  stream_.Start(analyzer);
+  unsigned long start_allocs = num_allocs;
+  struct timeval start_time, end_time;
+  gettimeofday(&start_time, NULL);
+  stream_.Replay(analyzer);
+  gettimeofday(&end_time, NULL);
+  unsigned long allocs = num_allocs - start_allocs;
+  stream_.Exit(analyzer);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double ns = (end_time.tv_sec - start_time.tv_sec) * 1e9 +
+              (end_time.tv_usec - start_time.tv_usec) * 1e3;
+  double num_events = (double)stream_.size();
+  printf("%-12s %12.1f %14.3f %14ld\n", name.c_str(), ns / num_events,
+         (double)allocs / num_events, usage.ru_maxrss);
+}
+
+} // namespace bench
@@ -0,0 +1,69 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: bench/analyzer_bench.h - Define the command line tool that
+// measures the per event cost of analyzers.
+
+#ifndef BENCH_ANALYZER_BENCH_H_
+#define BENCH_ANALYZER_BENCH_H_
+
+#include <string>
+
+#include "core/basictypes.h"
+#include "core/analyzer.h"
+#include "core/knob.h"
+#include "core/offline_tool.h"
+#include "bench/stream.h"
+
+namespace bench {
+
+// An analyzer that hooks every event and does nothing. It measures the
+// cost of the benchmark harness itself.
+class NullAnalyzer : public Analyzer {
+ public:
+  NullAnalyzer();
+  ~NullAnalyzer() {}
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(NullAnalyzer);
+};
+
+// The analyzer benchmark drives analyzers through a synthetic event stream
+// (no PIN involved) and reports the time and the number of allocations per
+// event and the peak memory usage of each analyzer. Each analyzer runs in
+// a separate process so that the peak memory usages are not mixed up.
+class AnalyzerBench : public OfflineTool {
+ public:
+  AnalyzerBench();
+  virtual ~AnalyzerBench() {}
+
+ protected:
+  virtual void HandlePreSetup();
+  virtual void HandlePostSetup();
+  virtual void HandleStart();
+
+  Analyzer *CreateAnalyzer(const std::string &name);
+  void Measure(const std::string &name);
+
+  EventStream stream_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(AnalyzerBench);
+};
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,28 @@
+# Rules for the bench package
+
+srcs += \
+  bench/analyzer_bench.cc \
+  bench/analyzer_bench_main.cc \
+  bench/stream.cc
+
+cmdtools += \
+  analyzer_bench
+
+analyzer_bench_objs := \
+  bench/analyzer_bench.o \
+  bench/analyzer_bench_main.o \
+  bench/stream.o \
+  idiom/iroot.o \
+  idiom/iroot.pb.o \
+  idiom/memo.o \
+  idiom/memo.pb.o \
+  idiom/observer.o \
+  idiom/predictor.o \
+  sinst/analyzer.o \
+  sinst/sinst.o \
+  sinst/sinst.pb.o \
+  tracer/log.o \
+  tracer/log.pb.o \
+  tracer/recorder.o \
+  $(core_cmd_objs)
+
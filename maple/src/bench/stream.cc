@@ -0,0 +1,287 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: bench/stream.cc - Implement synthetic event streams used to drive
+// analyzers without PIN.
+
+#include "bench/stream.h"
+
+#include <cstdlib>
+
+#include "core/logging.h"
+
+// the fake address space layout of the benchmark program
+#define IMAGE_LOW_ADDR 0x400000
+#define IMAGE_HIGH_ADDR 0x500000
+#define DATA_START 0x600000
+#define SYNC_AREA_SIZE 0x1000 // mutexes and condition variables
+#define NUM_SYNC_VARS 16
+#define HEAP_START 0x10000000
+#define HEAP_BLOCK_SIZE 64
+#define MAX_LIVE_BLOCKS 8
+
+namespace bench {
+
+EventStream::EventStream()
+    : image_(NULL),
+      data_start_(0),
+      data_size_(0),
+      heap_cursor_(0),
+      rand_state_(0) {
+  // empty
+}
+
+void EventStream::Generate(StaticInfo *sinfo, const StreamConfig &config) {
+  config_ = config;
+  if (config_.num_threads < 1)
+    config_.num_threads = 1;
+  if (config_.num_insts < 1)
+    config_.num_insts = 1;
+  rand_state_ = config_.seed;
+
+  image_ = sinfo->CreateImage("bench");
+  for (int i = 0; i < config_.num_insts; i++)
+    insts_.push_back(sinfo->CreateInst(image_, (address_t)i * 4));
+
+  data_start_ = DATA_START;
+  data_size_ = SYNC_AREA_SIZE + config_.shared_size;
+  heap_cursor_ = HEAP_START;
+
+  // thread ids start from 1 (the main thread)
+  int num_threads = config_.num_threads;
+  live_blocks_.resize(num_threads + 1);
+  private_regions_.resize(num_threads + 1);
+  events_.reserve(config_.num_events + 8 * num_threads);
+
+  // the main thread starts and creates the children
+  Add(Event::THREAD_START, 1, NULL, 0, INVALID_THD_ID);
+  for (int t = 1; t <= num_threads; t++) {
+    if (t > 1) {
+      Add(Event::PTHREAD_CREATE, 1, RandomInst(), 0, t);
+      Add(Event::THREAD_START, t, NULL, 0, 1);
+    }
+    private_regions_[t] = heap_cursor_;
+    Add(Event::MALLOC, t, RandomInst(), heap_cursor_, config_.private_size);
+    heap_cursor_ += (config_.private_size + 0xfff) & ~(address_t)0xfff;
+  }
+
+  while (events_.size() < (size_t)config_.num_events) {
+    thread_id_t thd_id = 1 + Random(num_threads);
+    int r = (int)Random(1000);
+
+    if ((r -= config_.lock_rate) < 0) {
+      address_t mutex = data_start_ + Random(NUM_SYNC_VARS) * 64;
+      Add(Event::MUTEX_LOCK, thd_id, RandomInst(), mutex, 0);
+      AddAccess(thd_id, true);
+      Add(Event::MUTEX_UNLOCK, thd_id, RandomInst(), mutex, 0);
+    } else if ((r -= config_.cond_rate) < 0) {
+      if (num_threads < 2) {
+        AddAccess(thd_id, true);
+        continue;
+      }
+      // the waiter is woken up by the next thread
+      thread_id_t signaler = (thd_id % num_threads) + 1;
+      address_t mutex = data_start_ + Random(NUM_SYNC_VARS) * 64;
+      address_t cond = data_start_ + SYNC_AREA_SIZE / 2 +
+                       Random(NUM_SYNC_VARS) * 64;
+      Add(Event::MUTEX_LOCK, thd_id, RandomInst(), mutex, 0);
+      Add(Event::COND_WAIT_ENTER, thd_id, RandomInst(), cond, mutex);
+      Add(Event::MUTEX_LOCK, signaler, RandomInst(), mutex, 0);
+      AddAccess(signaler, true);
+      Add(Event::COND_SIGNAL, signaler, RandomInst(), cond, 0);
+      Add(Event::MUTEX_UNLOCK, signaler, RandomInst(), mutex, 0);
+      Add(Event::COND_WAIT_EXIT, thd_id, RandomInst(), cond, mutex);
+      Add(Event::MUTEX_UNLOCK, thd_id, RandomInst(), mutex, 0);
+    } else if ((r -= config_.malloc_rate) < 0) {
+      AddrVec &blocks = live_blocks_[thd_id];
+      if (blocks.size() >= MAX_LIVE_BLOCKS) {
+        Add(Event::FREE, thd_id, RandomInst(), blocks.front(), 0);
+        blocks.erase(blocks.begin());
+      } else {
+        Add(Event::MALLOC, thd_id, RandomInst(), heap_cursor_,
+            HEAP_BLOCK_SIZE);
+        blocks.push_back(heap_cursor_);
+        heap_cursor_ += HEAP_BLOCK_SIZE;
+      }
+    } else if ((r -= config_.call_rate) < 0) {
+      Inst *call_inst = RandomInst();
+      address_t target = IMAGE_LOW_ADDR + RandomInst()->offset();
+      address_t ret = IMAGE_LOW_ADDR + call_inst->offset() + 5;
+      Add(Event::CALL, thd_id, call_inst, target, ret);
+      Add(Event::RETURN, thd_id, RandomInst(), ret, 0);
+    } else {
+      AddAccess(thd_id, (int)Random(100) < config_.shared_ratio);
+    }
+  }
+
+  // the children exit and are joined by the main thread
+  for (int t = num_threads; t > 1; t--) {
+    Add(Event::THREAD_EXIT, t, NULL, 0, 0);
+    Add(Event::PTHREAD_JOIN, 1, RandomInst(), 0, t);
+  }
+  Add(Event::THREAD_EXIT, 1, NULL, 0, 0);
+}
+
+void EventStream::Start(Analyzer *analyzer) {
+  analyzer->ProgramStart();
+  analyzer->ImageLoad(image_, IMAGE_LOW_ADDR, IMAGE_HIGH_ADDR, data_start_,
+                      data_size_, 0, 0);
+}
+
+void EventStream::Replay(Analyzer *analyzer) {
+  Descriptor *desc = analyzer->desc();
+  bool hook_before_mem = desc->HookBeforeMem();
+  bool hook_after_mem = desc->HookAfterMem();
+  bool hook_pthread = desc->HookPthreadFunc();
+  bool hook_malloc = desc->HookMallocFunc();
+  bool hook_call_return = desc->HookCallReturn();
+  std::vector<timestamp_t> clks(config_.num_threads + 1, 0);
+
+  for (EventVec::iterator it = events_.begin(); it != events_.end(); ++it) {
+    Event &e = *it;
+    timestamp_t clk = ++clks[e.thd_id];
+    switch (e.type) {
+      case Event::THREAD_START:
+        analyzer->ThreadStart(e.thd_id, e.arg);
+        break;
+      case Event::THREAD_EXIT:
+        analyzer->ThreadExit(e.thd_id, clk);
+        break;
+      case Event::PTHREAD_CREATE:
+        if (hook_pthread) {
+          analyzer->BeforePthreadCreate(e.thd_id, clk, e.inst);
+          analyzer->AfterPthreadCreate(e.thd_id, clk, e.inst, e.arg);
+        }
+        break;
+      case Event::PTHREAD_JOIN:
+        if (hook_pthread) {
+          analyzer->BeforePthreadJoin(e.thd_id, clk, e.inst, e.arg);
+          analyzer->AfterPthreadJoin(e.thd_id, clk, e.inst, e.arg);
+        }
+        break;
+      case Event::MEM_READ:
+        if (hook_before_mem)
+          analyzer->BeforeMemRead(e.thd_id, clk, e.inst, e.addr, e.arg);
+        if (hook_after_mem)
+          analyzer->AfterMemRead(e.thd_id, clk, e.inst, e.addr, e.arg);
+        break;
+      case Event::MEM_WRITE:
+        if (hook_before_mem)
+          analyzer->BeforeMemWrite(e.thd_id, clk, e.inst, e.addr, e.arg);
+        if (hook_after_mem)
+          analyzer->AfterMemWrite(e.thd_id, clk, e.inst, e.addr, e.arg);
+        break;
+      case Event::MUTEX_LOCK:
+        if (hook_pthread) {
+          analyzer->BeforePthreadMutexLock(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterPthreadMutexLock(e.thd_id, clk, e.inst, e.addr);
+        }
+        break;
+      case Event::MUTEX_UNLOCK:
+        if (hook_pthread) {
+          analyzer->BeforePthreadMutexUnlock(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterPthreadMutexUnlock(e.thd_id, clk, e.inst, e.addr);
+        }
+        break;
+      case Event::COND_WAIT_ENTER:
+        if (hook_pthread)
+          analyzer->BeforePthreadCondWait(e.thd_id, clk, e.inst, e.addr,
+                                          e.arg);
+        break;
+      case Event::COND_WAIT_EXIT:
+        if (hook_pthread)
+          analyzer->AfterPthreadCondWait(e.thd_id, clk, e.inst, e.addr,
+                                         e.arg);
+        break;
+      case Event::COND_SIGNAL:
+        if (hook_pthread) {
+          analyzer->BeforePthreadCondSignal(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterPthreadCondSignal(e.thd_id, clk, e.inst, e.addr);
+        }
+        break;
+      case Event::MALLOC:
+        if (hook_malloc) {
+          analyzer->BeforeMalloc(e.thd_id, clk, e.inst, e.arg);
+          analyzer->AfterMalloc(e.thd_id, clk, e.inst, e.arg, e.addr);
+        }
+        break;
+      case Event::FREE:
+        if (hook_malloc) {
+          analyzer->BeforeFree(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterFree(e.thd_id, clk, e.inst, e.addr);
+        }
+        break;
+      case Event::CALL:
+        if (hook_call_return) {
+          analyzer->BeforeCall(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterCall(e.thd_id, clk, e.inst, e.addr, e.arg);
+        }
+        break;
+      case Event::RETURN:
+        if (hook_call_return) {
+          analyzer->BeforeReturn(e.thd_id, clk, e.inst, e.addr);
+          analyzer->AfterReturn(e.thd_id, clk, e.inst, e.addr);
+        }
+        break;
+      default:
+        DEBUG_ASSERT(0); // impossible
+        break;
+    }
+  }
+}
+
+void EventStream::Exit(Analyzer *analyzer) {
+  analyzer->ProgramExit();
+}
+
+void EventStream::Add(Event::Type type, thread_id_t thd_id, Inst *inst,
+                      address_t addr, address_t arg) {
+  Event e;
+  e.type = type;
+  e.thd_id = thd_id;
+  e.inst = inst;
+  e.addr = addr;
+  e.arg = arg;
+  events_.push_back(e);
+}
+
+void EventStream::AddAccess(thread_id_t thd_id, bool shared) {
+  address_t base;
+  size_t size;
+  if (shared || config_.private_size < 4) {
+    base = data_start_ + SYNC_AREA_SIZE;
+    size = config_.shared_size;
+  } else {
+    base = private_regions_[thd_id];
+    size = config_.private_size;
+  }
+  address_t addr = base + (address_t)Random(size / 4) * 4;
+  bool write = (int)Random(100) < config_.write_ratio;
+  Add(write ? Event::MEM_WRITE : Event::MEM_READ, thd_id, RandomInst(),
+      addr, 4);
+}
+
+Inst *EventStream::RandomInst() {
+  return insts_[Random(insts_.size())];
+}
+
+unsigned int EventStream::Random(unsigned int range) {
+  if (range == 0)
+    return 0;
+  return (unsigned int)rand_r(&rand_state_) % range;
+}
+
+} // namespace bench
@@ -0,0 +1,131 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: bench/stream.h - Define synthetic event streams used to drive
+// analyzers without PIN.
+
+#ifndef BENCH_STREAM_H_
+#define BENCH_STREAM_H_
+
+#include <vector>
+
+#include "core/basictypes.h"
+#include "core/analyzer.h"
+#include "core/static_info.h"
+
+namespace bench {
+
+// The shape of a synthetic stream. All the rates are per 1000 events.
+class StreamConfig {
+ public:
+  StreamConfig()
+      : num_threads(4),
+        num_events(1000000),
+        num_insts(1000),
+        shared_size(65536),
+        private_size(65536),
+        shared_ratio(20),
+        write_ratio(30),
+        lock_rate(10),
+        cond_rate(1),
+        malloc_rate(2),
+        call_rate(20),
+        seed(1) {}
+  ~StreamConfig() {}
+
+  int num_threads;
+  int num_events;
+  int num_insts;
+  size_t shared_size; // bytes of global data accessed by all threads
+  size_t private_size; // bytes of heap accessed by one thread only
+  int shared_ratio; // percentage of accesses to the shared data
+  int write_ratio; // percentage of accesses that are writes
+  int lock_rate; // critical sections (lock, access, unlock)
+  int cond_rate; // wait/signal handoffs between two threads
+  int malloc_rate; // malloc or free of small heap blocks
+  int call_rate; // call/return pairs
+  unsigned int seed;
+};
+
+// A synthetic event. The meaning of addr and arg depends on the type.
+class Event {
+ public:
+  typedef enum {
+    THREAD_START = 0, // arg: parent thread
+    THREAD_EXIT,
+    PTHREAD_CREATE, // arg: child thread
+    PTHREAD_JOIN, // arg: child thread
+    MEM_READ, // addr, arg: size
+    MEM_WRITE, // addr, arg: size
+    MUTEX_LOCK, // addr: mutex
+    MUTEX_UNLOCK, // addr: mutex
+    COND_WAIT_ENTER, // addr: cond, arg: mutex
+    COND_WAIT_EXIT, // addr: cond, arg: mutex
+    COND_SIGNAL, // addr: cond
+    MALLOC, // addr, arg: size
+    FREE, // addr
+    CALL, // addr: target, arg: return address
+    RETURN, // addr: target
+  } Type;
+
+  Type type;
+  thread_id_t thd_id;
+  Inst *inst;
+  address_t addr;
+  address_t arg;
+};
+
+// A pre-generated stream of events. The stream is generated before the
+// measurement so that only the analyzer hooks are timed.
+class EventStream {
+ public:
+  EventStream();
+  ~EventStream() {}
+
+  void Generate(StaticInfo *sinfo, const StreamConfig &config);
+  void Start(Analyzer *analyzer); // program start and image load
+  void Replay(Analyzer *analyzer); // the measured part
+  void Exit(Analyzer *analyzer); // program exit
+  size_t size() { return events_.size(); }
+
+ protected:
+  typedef std::vector<Event> EventVec;
+  typedef std::vector<address_t> AddrVec;
+
+  void Add(Event::Type type, thread_id_t thd_id, Inst *inst,
+           address_t addr, address_t arg);
+  void AddAccess(thread_id_t thd_id, bool shared);
+  Inst *RandomInst();
+  unsigned int Random(unsigned int range);
+
+  StreamConfig config_;
+  Image *image_;
+  std::vector<Inst *> insts_;
+  std::vector<AddrVec> live_blocks_; // per thread heap blocks
+  std::vector<address_t> private_regions_; // per thread
+  address_t data_start_;
+  size_t data_size_;
+  address_t heap_cursor_;
+  unsigned int rand_state_;
+  EventVec events_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(EventStream);
+};
+
+} // namespace bench
+
+#endif
@@ -69,6 +69,20 @@ void CallStack::OnReturn(Inst *inst, address_t target) {
   //DEBUG_FMT_PRINT_SAFE("(%s)\n", ToString().c_str());
 }
 
+void CallStack::Reset(const std::vector<Inst *> &frames) {
+  // The frames of a captured backtrace are ordered from the innermost to the
+  // outermost, while the stack is stored from the outermost to the innermost.
+  inst_vec_.clear();
+  target_vec_.clear();
+  signature_ = 0;
+  for (std::vector<Inst *>::const_reverse_iterator it = frames.rbegin();
+       it != frames.rend(); ++it) {
+    inst_vec_.push_back(*it);
+    target_vec_.push_back(0);
+    signature_ += (signature_t)(*it)->id();
+  }
+}
+
 std::string CallStack::ToString() {
   std::stringstream ss;
   ss << std::hex;
@@ -77,7 +91,11 @@ std::string CallStack::ToString() {
     //ss << " <" << inst_vec_[i]->image()->name() << " ";
     //ss << " " << inst_vec_[i]->image()->name() << " ";
     //ss << inst_vec_[i]->offset() << " ";
-    ss << " <" << inst_vec_[i]->image()->ShortName() << "> " << inst_vec_[i]->offset() << " " << inst_vec_[i]->DebugInfoStr() << "\n";
+    // debug info is only printed if it is already resolved, running
+    // addr2line here would stall the execution (see race/symbolizer.h)
+    Inst *inst = inst_vec_[i];
+    ss << " <" << inst->image()->ShortName() << "> " << inst->offset() << " "
+       << (inst->HasDebugInfo() ? inst->DebugInfoStr() : "??:0") << "\n";
     //ss << ">\n";
     //ss << "0x" << target_vec_[i] << ">";
     //if (i != size - 1)
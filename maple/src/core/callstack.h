@@ -36,8 +36,10 @@ class CallStack {
   ~CallStack() {}
 
   signature_t signature() { return signature_; }
+  const std::vector<Inst *> &frames() { return inst_vec_; }
   void OnCall(Inst *inst, address_t ret);
   void OnReturn(Inst *inst, address_t target);
+  void Reset(const std::vector<Inst *> &frames);
   std::string ToString();
 
  protected:
@@ -115,18 +115,21 @@ void CmdlineKnob::RegisterStr(const std::string &name, const std::string &desc,
 }
 
 bool CmdlineKnob::ValueBool(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_BOOL);
   return *((bool *)it->second.second);
 }
 
 int CmdlineKnob::ValueInt(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_INT);
   return *((int *)it->second.second);
 }
 
 std::string CmdlineKnob::ValueStr(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_STR);
   return *((std::string *)it->second.second);
@@ -25,6 +25,7 @@ Descriptor::Descriptor()
       hook_atomic_inst_(false),
       hook_pthread_func_(false),
       hook_yield_func_(false),
+      hook_time_func_(false),
       hook_malloc_func_(false),
       hook_main_func_(false),
       hook_call_return_(false),
@@ -32,6 +33,7 @@ Descriptor::Descriptor()
       hook_signal_(false),
       track_inst_count_(false),
       track_call_stack_(false),
+      lazy_call_stack_(false),
       skip_stack_access_(false) {
   // empty
 }
@@ -42,13 +44,16 @@ void Descriptor::Merge(Descriptor *desc) {
   hook_atomic_inst_ = hook_atomic_inst_ || desc->hook_atomic_inst_;
   hook_pthread_func_ = hook_pthread_func_ || desc->hook_pthread_func_;
   hook_yield_func_ = hook_yield_func_ || desc->hook_yield_func_;
+  hook_time_func_ = hook_time_func_ || desc->hook_time_func_;
   hook_malloc_func_ = hook_malloc_func_ || desc->hook_malloc_func_;
   hook_main_func_ = hook_main_func_ || desc->hook_main_func_;
   hook_call_return_ = hook_call_return_ || desc->hook_call_return_;
   hook_syscall_ = hook_syscall_ || desc->hook_syscall_;
+  syscalls_.insert(desc->syscalls_.begin(), desc->syscalls_.end());
   hook_signal_ = hook_signal_ || desc->hook_signal_;
   track_inst_count_ = track_inst_count_ || desc->track_inst_count_;
   track_call_stack_ = track_call_stack_ || desc->track_call_stack_;
+  lazy_call_stack_ = lazy_call_stack_ || desc->lazy_call_stack_;
   skip_stack_access_ = skip_stack_access_ && desc->skip_stack_access_;
 }
 
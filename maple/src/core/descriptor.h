@@ -20,6 +20,8 @@
 #ifndef CORE_DESCRIPTOR_H_
 #define CORE_DESCRIPTOR_H_
 
+#include <set>
+
 #include "core/basictypes.h"
 
 // the general descriptor for instrumenting the program.
@@ -35,27 +37,36 @@ class Descriptor {
   bool HookAtomicInst() { return hook_atomic_inst_; }
   bool HookPthreadFunc() { return hook_pthread_func_; }
   bool HookYieldFunc() { return hook_yield_func_; }
+  bool HookTimeFunc() { return hook_time_func_; }
   bool HookMallocFunc() { return hook_malloc_func_; }
   bool HookMainFunc() { return hook_main_func_; }
   bool HookCallReturn() { return hook_call_return_; }
-  bool HookSyscall() { return hook_syscall_; }
+  bool HookSyscall() { return hook_syscall_ || !syscalls_.empty(); }
+  bool HookSyscall(int syscall_num) {
+    return hook_syscall_ || syscalls_.find(syscall_num) != syscalls_.end();
+  }
+  bool HookAllSyscalls() { return hook_syscall_; }
   bool HookSignal() { return hook_signal_; }
   bool TrackInstCount() { return track_inst_count_; }
   bool TrackCallStack() { return track_call_stack_; }
+  bool LazyCallStack() { return lazy_call_stack_; }
   bool SkipStackAccess() { return skip_stack_access_; }
 
   void SetHookBeforeMem() { hook_before_mem_ = true; }
   void SetHookAfterMem() { hook_after_mem_ = true; }
   void SetHookPthreadFunc() { hook_pthread_func_ = true; }
   void SetHookYieldFunc() { hook_yield_func_ = true; }
+  void SetHookTimeFunc() { hook_time_func_ = true; }
   void SetHookMallocFunc() { hook_malloc_func_ = true; }
   void SetHookMainFunc() { hook_main_func_ = true; }
   void SetHookCallReturn() { hook_call_return_ = true; }
   void SetHookSyscall() { hook_syscall_ = true; }
+  void SetHookSyscall(int syscall_num) { syscalls_.insert(syscall_num); }
   void SetHookSignal() { hook_signal_ = true; }
   void SetHookAtomicInst() { hook_atomic_inst_ = true; }
   void SetTrackInstCount() { track_inst_count_ = true; }
   void SetTrackCallStack() { track_call_stack_ = true; }
+  void SetLazyCallStack() { lazy_call_stack_ = true; }
   void SetNoSkipStackAccess() { skip_stack_access_ = false; }
 
  protected:
@@ -64,13 +75,16 @@ class Descriptor {
   bool hook_atomic_inst_;
   bool hook_pthread_func_;
   bool hook_yield_func_;
+  bool hook_time_func_;
   bool hook_malloc_func_;
   bool hook_main_func_;
   bool hook_call_return_;
-  bool hook_syscall_;
+  bool hook_syscall_; // whether hook all syscalls
+  std::set<int> syscalls_; // the syscall numbers to hook
   bool hook_signal_;
   bool track_inst_count_;
   bool track_call_stack_;
+  bool lazy_call_stack_; // whether remember the context of mem accesses
   bool skip_stack_access_;
 
  private:
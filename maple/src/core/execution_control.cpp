@@ -35,7 +35,15 @@ ExecutionControl::ExecutionControl()
       debug_analyzer_(NULL),
       main_thread_started_(false),
       main_thd_id_(INVALID_THD_ID) {
-  // Empty.
+  for (THREADID tid = 0; tid < PIN_MAX_THREADS; tid++) {
+    tls_thd_id_[tid] = INVALID_THD_ID;
+    tls_wrapper_[tid] = NULL;
+    tls_mem_inst_[tid] = NULL;
+    tls_mem_fp_[tid] = 0;
+    tls_syscall_hooked_[tid] = false;
+  }
+  for (int num = 0; num < SYSCALL_FILTER_SIZE; num++)
+    syscall_filter_[num] = false;
 }
 
 void ExecutionControl::Initialize() {
@@ -86,9 +94,14 @@ void ExecutionControl::PostSetup() {
     AddAnalyzer(debug_analyzer_);
   }
 
-  // Setup call stack info if needed.
+  // Call stacks are captured lazily at reporting points (see GetCallStack).
+  // A shadow call stack is only maintained if some analyzer asks for it.
+  callstack_info_ = new CallStackInfo(CreateMutex());
+
+  HandlePostSetup();
+
+  // Setup the shadow call stack if needed.
   if (desc_.TrackCallStack()) {
-    callstack_info_ = new CallStackInfo(CreateMutex());
     for (AnalyzerContainer::iterator it = analyzers_.begin();
          it != analyzers_.end(); ++it) {
       Analyzer *analyzer = *it;
@@ -101,16 +114,23 @@ void ExecutionControl::PostSetup() {
       = new CallStackTracker(callstack_info_);
     AddAnalyzer(callstack_tracker);
   }
-  
-  HandlePostSetup();
 
+  // Setup the runtime syscall filter.
+  for (int num = 0; num < SYSCALL_FILTER_SIZE; num++)
+    syscall_filter_[num] = desc_.HookSyscall(num);
+
+  // Knobs used after this point should be bound to handles.
+  knob_->Seal();
 }
 
 void ExecutionControl::InstrumentTrace(TRACE trace, VOID *v) {
   HandlePreInstrumentTrace(trace);
 
+  // Only some syscalls are hooked, instrument the syscall instructions.
+  bool hook_syscall_ins = desc_.HookSyscall() && !desc_.HookAllSyscalls();
+
   if (!desc_.HookMem() && !desc_.HookAtomicInst() && !desc_.TrackInstCount()
-      && !desc_.HookCallReturn()) {
+      && !desc_.HookCallReturn() && !hook_syscall_ins) {
     HandlePostInstrumentTrace(trace);
     return;
   }
@@ -152,6 +172,9 @@ void ExecutionControl::InstrumentTrace(TRACE trace, VOID *v) {
         Inst *inst = GetInst(INS_Address(ins));
         UpdateInstOpcode(inst, ins);
 
+        if (desc_.LazyCallStack())
+          InstrumentMemContext(ins, inst);
+
         INS_InsertCall(ins, IPOINT_BEFORE,
                        (AFUNPTR)__BeforeAtomicInst,
                        IARG_THREAD_ID,
@@ -180,6 +203,14 @@ void ExecutionControl::InstrumentTrace(TRACE trace, VOID *v) {
       }
     } // if (desc_.HookAtomicInst()) {
 
+    // Instrumentation to track the hooked syscalls.
+    if (hook_syscall_ins) {
+      for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
+        if (INS_IsSyscall(ins))
+          InstrumentSyscall(ins);
+      }
+    } // if (hook_syscall_ins) {
+
     // Decide whether to instrument mem access.
     if (HandleIgnoreMemAccess(img))
       continue;
@@ -201,6 +232,9 @@ void ExecutionControl::InstrumentTrace(TRACE trace, VOID *v) {
 
           // Instrument before mem accesses.
           if (desc_.HookBeforeMem()) {
+            if (desc_.LazyCallStack())
+              InstrumentMemContext(ins, inst);
+
             if (INS_IsMemoryRead(ins)) {
               INS_InsertCall(ins, IPOINT_BEFORE,
                              (AFUNPTR)__BeforeMemRead,
@@ -348,6 +382,8 @@ void ExecutionControl::ImageLoad(IMG img, VOID *v) {
     ReplacePthreadCreateWrapper(img);
   if (desc_.HookYieldFunc())
     ReplaceYieldWrappers(img);
+  if (desc_.HookTimeFunc())
+    ReplaceTimeWrappers(img);
   if (desc_.HookMallocFunc())
     ReplaceMallocWrappers(img);
 
@@ -371,18 +407,98 @@ void ExecutionControl::ImageUnload(IMG img, VOID *v) {
 
 void ExecutionControl::SyscallEntry(THREADID tid, CONTEXT *ctxt,
                                     SYSCALL_STANDARD std, VOID *v) {
-  if (desc_.HookSyscall()) {
+  if (desc_.HookAllSyscalls()) {
     HandleSyscallEntry(tid, ctxt, std);
   }
 }
 
 void ExecutionControl::SyscallExit(THREADID tid, CONTEXT *ctxt,
                                    SYSCALL_STANDARD std, VOID *v) {
-  if (desc_.HookSyscall()) {
+  if (desc_.HookAllSyscalls()) {
     HandleSyscallExit(tid, ctxt, std);
   }
 }
 
+void ExecutionControl::InstrumentMemContext(INS ins, Inst *inst) {
+  // Remember where the thread is, so that its call stack can be captured
+  // at a reporting point (see CaptureCallStack).
+  INS_InsertCall(ins, IPOINT_BEFORE,
+                 (AFUNPTR)__MemContext,
+                 IARG_FAST_ANALYSIS_CALL,
+                 IARG_THREAD_ID,
+                 IARG_PTR, inst,
+                 IARG_REG_VALUE, REG_GBP,
+                 IARG_END);
+}
+
+void ExecutionControl::InstrumentSyscall(INS ins) {
+  // Skip the syscall if its number is known and not hooked.
+  int num = GetStaticSyscallNumber(ins);
+  if (num >= 0 && !desc_.HookSyscall(num))
+    return;
+
+  if (num >= 0) {
+    INS_InsertCall(ins, IPOINT_BEFORE,
+                   (AFUNPTR)__SyscallEntry,
+                   IARG_THREAD_ID,
+                   IARG_CONTEXT,
+                   IARG_UINT32, INS_SyscallStd(ins),
+                   IARG_END);
+  } else {
+    INS_InsertIfCall(ins, IPOINT_BEFORE,
+                     (AFUNPTR)__SyscallFilter,
+                     IARG_FAST_ANALYSIS_CALL,
+                     IARG_SYSCALL_NUMBER,
+                     IARG_END);
+    INS_InsertThenCall(ins, IPOINT_BEFORE,
+                       (AFUNPTR)__SyscallEntry,
+                       IARG_THREAD_ID,
+                       IARG_CONTEXT,
+                       IARG_UINT32, INS_SyscallStd(ins),
+                       IARG_END);
+  }
+
+  if (INS_HasFallThrough(ins)) {
+    INS_InsertIfCall(ins, IPOINT_AFTER,
+                     (AFUNPTR)__SyscallExitFilter,
+                     IARG_FAST_ANALYSIS_CALL,
+                     IARG_THREAD_ID,
+                     IARG_END);
+    INS_InsertThenCall(ins, IPOINT_AFTER,
+                       (AFUNPTR)__SyscallExit,
+                       IARG_THREAD_ID,
+                       IARG_CONTEXT,
+                       IARG_UINT32, INS_SyscallStd(ins),
+                       IARG_END);
+  }
+}
+
+int ExecutionControl::GetStaticSyscallNumber(INS ins) {
+  // Find the last instruction before the syscall (in the same trace) that
+  // writes the syscall number register (or any part of it). The number is
+  // only known if it is an immediate move to the full register, e.g.
+  // "mov $0xe7, %eax" (a 32-bit write clears the upper half of rax).
+  for (INS prev = INS_Prev(ins); INS_Valid(prev); prev = INS_Prev(prev)) {
+    REG dst = REG_INVALID();
+    for (UINT32 i = 0; i < INS_MaxNumWRegs(prev); i++) {
+      REG reg = INS_RegW(prev, i);
+      if (REG_valid(reg) && REG_FullRegName(reg) == REG_GAX) {
+        dst = reg;
+        break;
+      }
+    }
+    if (!REG_valid(dst))
+      continue;
+    if ((dst == REG_GAX || REG_is_gr32(dst)) &&
+        INS_IsMov(prev) && INS_OperandCount(prev) >= 2 &&
+        INS_OperandIsReg(prev, 0) && INS_OperandReg(prev, 0) == dst &&
+        INS_OperandIsImmediate(prev, 1))
+      return (int)INS_OperandImmediate(prev, 1);
+    return -1;
+  }
+  return -1;
+}
+
 void ExecutionControl::IntSignal(THREADID tid, INT32 sig, CONTEXT *ctxt,
                                  BOOL hasHandler,
                                  const EXCEPTION_INFO *pExceptInfo, VOID *v) {
@@ -410,6 +526,8 @@ void ExecutionControl::ProgramStart() {
 
 void ExecutionControl::ProgramExit(INT32 code, VOID *v) {
   std::cout << "Program EXIT" << std::endl;
+  // only lookups between setup and exit are reported
+  knob_->Unseal();
   HandleProgramExit();
 
   // save static info
@@ -436,6 +554,10 @@ void ExecutionControl::ThreadStart(THREADID tid, CONTEXT *ctxt, INT32 flags,
 
   LockKernel();
   tls_thd_clock_[tid] = 0; // init thd clock
+  tls_thd_id_[tid] = curr_thd_id;
+  tls_wrapper_[tid] = NULL;
+  tls_mem_inst_[tid] = NULL;
+  tls_mem_fp_[tid] = 0;
   thd_create_sem_map_[os_tid] = CreateSemaphore(0);
   os_tid_map_[os_tid] = curr_thd_id;
   // notify the parent that the new thread start
@@ -553,7 +675,11 @@ void ExecutionControl::HandleSyscallEntry(THREADID tid, CONTEXT *ctxt,
   timestamp_t curr_thd_clk = GetThdClk(tid);
   int syscall_num = (int)PIN_GetSyscallNumber(ctxt, std);
   tls_syscall_num_[tid] = syscall_num;
-  CALL_ANALYSIS_FUNC2(Syscall, SyscallEntry, self, curr_thd_clk, syscall_num);
+  for (AnalyzerContainer::iterator it = analyzers_.begin();
+       it != analyzers_.end(); ++it) {
+    if ((*it)->desc()->HookSyscall(syscall_num))
+      (*it)->SyscallEntry(self, curr_thd_clk, syscall_num);
+  }
 }
 
 void ExecutionControl::HandleSyscallExit(THREADID tid, CONTEXT *ctxt,
@@ -561,7 +687,11 @@ void ExecutionControl::HandleSyscallExit(THREADID tid, CONTEXT *ctxt,
   thread_id_t self = Self();
   timestamp_t curr_thd_clk = GetThdClk(tid);
   int syscall_num = tls_syscall_num_[tid];
-  CALL_ANALYSIS_FUNC2(Syscall, SyscallExit, self, curr_thd_clk, syscall_num);
+  for (AnalyzerContainer::iterator it = analyzers_.begin();
+       it != analyzers_.end(); ++it) {
+    if ((*it)->desc()->HookSyscall(syscall_num))
+      (*it)->SyscallExit(self, curr_thd_clk, syscall_num);
+  }
 }
 
 void ExecutionControl::HandleSignalReceived(THREADID tid, INT32 sig,
@@ -681,7 +811,9 @@ void ExecutionControl::HandleAfterReturn(THREADID tid, Inst *inst,
 }
 
 void ExecutionControl::HandleBeforeWrapper(WrapperBase *wrapper) {
-  // Nothing.
+  // Remember the active wrapper so that the call stack of a thread blocked
+  // inside a wrapper can be captured later at a reporting point.
+  tls_wrapper_[wrapper->tid()] = wrapper;
 }
 
 void ExecutionControl::HandleAfterWrapper(WrapperBase *wrapper) {
@@ -693,8 +825,19 @@ void ExecutionControl::HandleAfterWrapper(WrapperBase *wrapper) {
     CallStack *callstack = callstack_info_->GetCallStack(Self());
     callstack->OnReturn(NULL, wrapper->ret_addr());
   }
+  tls_wrapper_[wrapper->tid()] = NULL;
+}
+
+CallStack *ExecutionControl::GetCallStack(thread_id_t thd_id) {
+  DEBUG_ASSERT(callstack_info_);
+  CallStack *callstack = callstack_info_->GetCallStack(thd_id);
+  // The shadow call stack is always up to date.
+  if (!desc_.TrackCallStack())
+    CaptureCallStack(thd_id, callstack);
+  return callstack;
 }
 
+
 void ExecutionControl::Abort(const std::string &msg) {
   fprintf(stderr, "%s", msg.c_str());
   assert(0);
@@ -717,11 +860,7 @@ Inst *ExecutionControl::GetInst(ADDRINT pc) {
   Inst *inst = image->Find(offset);
   if (!inst) {
     inst = sinfo_->CreateInst(image, offset);
-    if (!inst->HasDebugInfo()) {
-    }
-    
-    
-    //UpdateInstDebugInfo(inst, pc);
+    // debug info is resolved offline (see race/symbolizer.h)
   }
   inst->pc = pc;
   PIN_UnlockClient();
@@ -734,15 +873,40 @@ void ExecutionControl::UpdateInstOpcode(Inst *inst, INS ins) {
     inst->SetOpcode(INS_Opcode(ins));
 }
 
-void ExecutionControl::UpdateInstDebugInfo(Inst *inst, ADDRINT pc) {
-  if (!inst->HasDebugInfo()) {
-    std::string file_name;
-    int line = 0;
-    int column = 0;
-    PIN_GetSourceLocation(pc, &column, &line, &file_name);
-    if (!file_name.empty())
-      inst->SetDebugInfo(file_name, line, column);
+void ExecutionControl::CaptureCallStack(thread_id_t thd_id,
+                                        CallStack *callstack) {
+  // Find the pin thread id of the given thread.
+  THREADID tid = INVALID_THREADID;
+  for (THREADID i = 0; i < PIN_MAX_THREADS; i++) {
+    if (tls_thd_id_[i] == thd_id) {
+      tid = i;
+      break;
+    }
+  }
+
+  // The application context of a thread is known either from the wrapper
+  // it is in, or from its last instrumented memory access (which is where
+  // the memory schedule points and the race reports are).
+  std::vector<Inst *> insts;
+  ADDRINT frames[MAX_CALLSTACK_DEPTH];
+  size_t num_frames = 0;
+  if (tid != INVALID_THREADID && tls_wrapper_[tid]) {
+    // The context is taken at the entry of the wrapped function, so the
+    // frame pointer still belongs to the caller.
+    WrapperBase *wrapper = tls_wrapper_[tid];
+    frames[0] = wrapper->ret_addr();
+    ADDRINT fp = PIN_GetContextReg(wrapper->ctxt(), REG_GBP);
+    num_frames = 1 + WalkFramePointers(fp, frames + 1,
+                                       MAX_CALLSTACK_DEPTH - 1);
+  } else if (tid != INVALID_THREADID && tls_mem_inst_[tid]) {
+    // The frame pointer belongs to the function doing the access.
+    insts.push_back(tls_mem_inst_[tid]);
+    num_frames = WalkFramePointers(tls_mem_fp_[tid], frames,
+                                   MAX_CALLSTACK_DEPTH - 1);
   }
+  for (size_t i = 0; i < num_frames; i++)
+    insts.push_back(GetInst(frames[i]));
+  callstack->Reset(insts);
 }
 
 void ExecutionControl::AddAnalyzer(Analyzer *analyzer) {
@@ -829,6 +993,16 @@ void ExecutionControl::ReplaceYieldWrappers(IMG img) {
   ACTIVATE_WRAPPER_HANDLER(SchedYield);
 }
 
+void ExecutionControl::ReplaceTimeWrappers(IMG img) {
+  ACTIVATE_WRAPPER_HANDLER(Nanosleep);
+  ACTIVATE_OPTIONAL_WRAPPER_HANDLER(ClockNanosleep);
+  ACTIVATE_WRAPPER_HANDLER(Gettimeofday);
+  ACTIVATE_OPTIONAL_WRAPPER_HANDLER(ClockGettime);
+  ACTIVATE_WRAPPER_HANDLER(Poll);
+  ACTIVATE_WRAPPER_HANDLER(Select);
+  ACTIVATE_OPTIONAL_WRAPPER_HANDLER(EpollWait);
+}
+
 void ExecutionControl::InstrumentStartupFunc(IMG img) {
   if (!IMG_IsMainExecutable(img) &&
       IMG_Name(img).find("libpthread") == std::string::npos)
@@ -880,6 +1054,13 @@ void ExecutionControl::__ThreadMain(THREADID tid, CONTEXT *ctxt) {
   ctrl_->HandleThreadMain(tid, ctxt);
 }
 
+void PIN_FAST_ANALYSIS_CALL ExecutionControl::__MemContext(THREADID tid,
+                                                           Inst *inst,
+                                                           ADDRINT fp) {
+  ctrl_->tls_mem_inst_[tid] = inst;
+  ctrl_->tls_mem_fp_[tid] = fp;
+}
+
 void ExecutionControl::__BeforeMemRead(THREADID tid, Inst *inst,
                                        ADDRINT addr, UINT32 size) {
   ctrl_->HandleBeforeMemRead(tid, inst, addr, size);
@@ -957,6 +1138,27 @@ void ExecutionControl::__AfterReturn(THREADID tid, Inst *inst,
   ctrl_->HandleAfterReturn(tid, inst, target);
 }
 
+ADDRINT PIN_FAST_ANALYSIS_CALL ExecutionControl::__SyscallFilter(ADDRINT num) {
+  return num < SYSCALL_FILTER_SIZE && ctrl_->syscall_filter_[num];
+}
+
+ADDRINT PIN_FAST_ANALYSIS_CALL
+ExecutionControl::__SyscallExitFilter(THREADID tid) {
+  return ctrl_->tls_syscall_hooked_[tid];
+}
+
+void ExecutionControl::__SyscallEntry(THREADID tid, CONTEXT *ctxt,
+                                      UINT32 std) {
+  ctrl_->tls_syscall_hooked_[tid] = true;
+  ctrl_->HandleSyscallEntry(tid, ctxt, (SYSCALL_STANDARD)std);
+}
+
+void ExecutionControl::__SyscallExit(THREADID tid, CONTEXT *ctxt,
+                                     UINT32 std) {
+  ctrl_->tls_syscall_hooked_[tid] = false;
+  ctrl_->HandleSyscallExit(tid, ctxt, (SYSCALL_STANDARD)std);
+}
+
 IMPLEMENT_WRAPPER_HANDLER(PthreadCreate, ExecutionControl) {
   thread_id_t self = Self();
   Inst *inst = GetInst(wrapper->ret_addr());
@@ -1220,6 +1422,34 @@ IMPLEMENT_WRAPPER_HANDLER(SchedYield, ExecutionControl) {
   wrapper->CallOriginal();
 }
 
+IMPLEMENT_WRAPPER_HANDLER(Nanosleep, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(ClockNanosleep, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Gettimeofday, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(ClockGettime, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Poll, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Select, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(EpollWait, ExecutionControl) {
+  wrapper->CallOriginal();
+}
+
 IMPLEMENT_WRAPPER_HANDLER(Malloc, ExecutionControl) {
   thread_id_t self = Self();
   Inst *inst = GetInst(wrapper->ret_addr());
@@ -37,6 +37,9 @@
 #include "core/wrapper.hpp"
 
 // Define macros for calling analysis functions.
+// The maximum number of frames captured for a call stack.
+#define MAX_CALLSTACK_DEPTH 64
+
 #define CALL_ANALYSIS_FUNC(func,...)                                        \
   for (AnalyzerContainer::iterator it = analyzers_.begin();                 \
        it != analyzers_.end(); ++it) {                                      \
@@ -76,6 +79,9 @@
 #define ACTIVATE_WRAPPER_HANDLER(name)                                      \
   ACTIVATE_WRAPPER(name, img, STATIC_WRAPPER_HANDLER(name));
 
+#define ACTIVATE_OPTIONAL_WRAPPER_HANDLER(name)                             \
+  ACTIVATE_OPTIONAL_WRAPPER(name, img, STATIC_WRAPPER_HANDLER(name));
+
 // Define macros for the main entry functions.
 #define MAIN_ENTRY(controller)                                              \
   static controller *ctrl = new controller;                                 \
@@ -144,8 +150,10 @@
     TRACE_AddInstrumentFunction(I_InstrumentTrace, NULL);                   \
     IMG_AddInstrumentFunction(I_ImageLoad, NULL);                           \
     IMG_AddUnloadFunction(I_ImageUnload, NULL);                             \
-    PIN_AddSyscallEntryFunction(I_SyscallEntry, NULL);                      \
-    PIN_AddSyscallExitFunction(I_SyscallExit, NULL);                        \
+    if (ctrl->HookAllSyscalls()) {                                          \
+      PIN_AddSyscallEntryFunction(I_SyscallEntry, NULL);                    \
+      PIN_AddSyscallExitFunction(I_SyscallExit, NULL);                      \
+    }                                                                       \
     PIN_InterceptSignal(SIGUSR2, I_IntSignal, NULL);                        \
     PIN_AddContextChangeFunction(I_ContextChange, NULL);                    \
     PIN_AddFiniFunction(I_ProgramExit, NULL);                               \
@@ -155,6 +163,9 @@
     PIN_StartProgram();                                                     \
   }
 
+// The size of the table used to filter syscalls at runtime.
+#define SYSCALL_FILTER_SIZE 1024
+
 // The main controller for the dynamic program analysis.
 class ExecutionControl {
  public:
@@ -177,6 +188,11 @@ class ExecutionControl {
   void ProgramExit(INT32 code, VOID *v);
   void ThreadStart(THREADID tid, CONTEXT *ctxt, INT32 flags, VOID *v);
   void ThreadExit(THREADID tid, const CONTEXT *ctxt, INT32 code, VOID *v);
+  CallStack *GetCallStack(thread_id_t thd_id);
+  // Whether every syscall goes through the pin syscall callbacks. If only
+  // some syscalls are hooked, the syscall instructions that may execute
+  // them are instrumented instead (see InstrumentSyscall).
+  bool HookAllSyscalls() { return desc_.HookAllSyscalls(); }
 
  protected:
   typedef std::list<Analyzer *> AnalyzerContainer;
@@ -232,7 +248,7 @@ class ExecutionControl {
   void Abort(const std::string &msg);
   Inst *GetInst(ADDRINT pc);
   void UpdateInstOpcode(Inst *inst, INS ins);
-  void UpdateInstDebugInfo(Inst *inst, ADDRINT pc);
+  void CaptureCallStack(thread_id_t thd_id, CallStack *callstack);
   void AddAnalyzer(Analyzer *analyzer);
   thread_id_t GetThdID(pthread_t thread);
   thread_id_t GetParent();
@@ -248,6 +264,7 @@ class ExecutionControl {
   void ReplacePthreadCreateWrapper(IMG img);
   void ReplacePthreadWrappers(IMG img);
   void ReplaceYieldWrappers(IMG img);
+  void ReplaceTimeWrappers(IMG img);
   void ReplaceMallocWrappers(IMG img);
 
   Mutex *kernel_lock_;
@@ -267,6 +284,12 @@ class ExecutionControl {
   address_t tls_read2_addr_[PIN_MAX_THREADS];
   address_t tls_atomic_addr_[PIN_MAX_THREADS];
   int tls_syscall_num_[PIN_MAX_THREADS];
+  bool tls_syscall_hooked_[PIN_MAX_THREADS];
+  bool syscall_filter_[SYSCALL_FILTER_SIZE]; // the syscalls to hook
+  thread_id_t tls_thd_id_[PIN_MAX_THREADS];
+  WrapperBase *tls_wrapper_[PIN_MAX_THREADS]; // the active wrapper
+  Inst *tls_mem_inst_[PIN_MAX_THREADS]; // the last mem access (lazy only)
+  ADDRINT tls_mem_fp_[PIN_MAX_THREADS]; // the frame pointer at tls_mem_inst_
   std::map<OS_THREAD_ID, Semaphore *> thd_create_sem_map_; // init = 0
   std::map<OS_THREAD_ID, thread_id_t> child_thd_map_;
   std::map<OS_THREAD_ID, thread_id_t> os_tid_map_;
@@ -277,6 +300,9 @@ class ExecutionControl {
 
  private:
   void InstrumentStartupFunc(IMG img);
+  void InstrumentSyscall(INS ins);
+  void InstrumentMemContext(INS ins, Inst *inst);
+  static int GetStaticSyscallNumber(INS ins);
 
   static void PIN_FAST_ANALYSIS_CALL __InstCount(THREADID tid);
   static void PIN_FAST_ANALYSIS_CALL __InstCount2(THREADID tid, UINT32 c);
@@ -293,12 +319,18 @@ class ExecutionControl {
   static void __AfterMemRead2(THREADID tid, Inst *inst);
   static void __BeforeAtomicInst(THREADID tid, Inst *inst, UINT32 opcode,
                                  ADDRINT addr);
+  static void PIN_FAST_ANALYSIS_CALL __MemContext(THREADID tid, Inst *inst,
+                                                  ADDRINT fp);
   static void __AfterAtomicInst(THREADID tid, Inst *inst, UINT32 opcode);
   static void __BeforeCall(THREADID tid, Inst *inst, ADDRINT target);
   static void __AfterCall(THREADID tid, Inst *inst, ADDRINT target,
                           ADDRINT ret);
   static void __BeforeReturn(THREADID tid, Inst *inst, ADDRINT target);
   static void __AfterReturn(THREADID tid, Inst *inst, ADDRINT target);
+  static ADDRINT PIN_FAST_ANALYSIS_CALL __SyscallFilter(ADDRINT num);
+  static ADDRINT PIN_FAST_ANALYSIS_CALL __SyscallExitFilter(THREADID tid);
+  static void __SyscallEntry(THREADID tid, CONTEXT *ctxt, UINT32 std);
+  static void __SyscallExit(THREADID tid, CONTEXT *ctxt, UINT32 std);
 
   DISALLOW_COPY_CONSTRUCTORS(ExecutionControl);
 
@@ -320,6 +352,14 @@ class ExecutionControl {
   DECLARE_WRAPPER_HANDLER(Usleep);
   DECLARE_WRAPPER_HANDLER(SchedYield);
 
+  DECLARE_WRAPPER_HANDLER(Nanosleep);
+  DECLARE_WRAPPER_HANDLER(ClockNanosleep);
+  DECLARE_WRAPPER_HANDLER(Gettimeofday);
+  DECLARE_WRAPPER_HANDLER(ClockGettime);
+  DECLARE_WRAPPER_HANDLER(Poll);
+  DECLARE_WRAPPER_HANDLER(Select);
+  DECLARE_WRAPPER_HANDLER(EpollWait);
+
   DECLARE_WRAPPER_HANDLER(Malloc);
   DECLARE_WRAPPER_HANDLER(Calloc);
   DECLARE_WRAPPER_HANDLER(Realloc);
@@ -18,5 +18,33 @@
 
 #include "core/knob.h"
 
+#include "core/logging.h"
+
 Knob *Knob::knob_ = NULL;
 
+void Knob::Bind(const std::string &name, BoolKnobHandle *handle) {
+  handle->value_ = ValueBool(name);
+  handle->bound_ = true;
+}
+
+void Knob::Bind(const std::string &name, IntKnobHandle *handle) {
+  handle->value_ = ValueInt(name);
+  handle->bound_ = true;
+}
+
+void Knob::Bind(const std::string &name, StrKnobHandle *handle) {
+  handle->value_ = ValueStr(name);
+  handle->bound_ = true;
+}
+
+void Knob::ReportLookup(const std::string &name) {
+#ifdef _DEBUG
+  g_print_lock->Lock();
+  if (late_lookups_.insert(name).second) {
+    __DEBUG_FMT("knob '%s' is looked up by name after setup\n",
+                name.c_str());
+  }
+  g_print_lock->Unlock();
+#endif
+}
+
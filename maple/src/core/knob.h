@@ -19,12 +19,37 @@
 #ifndef CORE_KNOB_H_
 #define CORE_KNOB_H_
 
+#include <set>
+
 #include "core/basictypes.h"
 
+// A typed handle to the value of a knob. Knob values do not change once
+// the command line is parsed, so a handle is resolved once (see Knob::Bind)
+// and then read without any name lookup.
+template <typename T>
+class KnobHandle {
+ public:
+  KnobHandle() : value_(), bound_(false) {}
+  ~KnobHandle() {}
+
+  const T &Value() const { return value_; }
+  bool bound() const { return bound_; }
+
+ private:
+  friend class Knob;
+
+  T value_;
+  bool bound_;
+};
+
+typedef KnobHandle<bool> BoolKnobHandle;
+typedef KnobHandle<int> IntKnobHandle;
+typedef KnobHandle<std::string> StrKnobHandle;
+
 // The interface class for the command line switches.
 class Knob {
  public:
-  Knob() {}
+  Knob() : sealed_(false) {}
   virtual ~Knob() {}
 
   virtual void RegisterBool(const std::string &name, const std::string &desc,
@@ -37,10 +62,30 @@ class Knob {
   virtual int ValueInt(const std::string &name) = 0;
   virtual std::string ValueStr(const std::string &name) = 0;
 
+  // resolve typed handles (should be called during setup)
+  void Bind(const std::string &name, BoolKnobHandle *handle);
+  void Bind(const std::string &name, IntKnobHandle *handle);
+  void Bind(const std::string &name, StrKnobHandle *handle);
+
+  // mark the end of setup. in debug builds, name based lookups after that
+  // are reported (once per knob), as they should use bound handles
+  void Seal() { sealed_ = true; }
+  // mark the start of exit, where one-shot lookups are fine again
+  void Unseal() { sealed_ = false; }
+
   static void Initialize(Knob *knob) { knob_ = knob; }
   static Knob *Get() { return knob_; }
 
  protected:
+  void CheckLookup(const std::string &name) {
+    if (sealed_)
+      ReportLookup(name);
+  }
+  void ReportLookup(const std::string &name);
+
+  bool sealed_;
+  std::set<std::string> late_lookups_; // the reported knobs
+
   static Knob *knob_;
 
  private:
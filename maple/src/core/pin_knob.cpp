@@ -59,18 +59,21 @@ void PinKnob::RegisterStr(const std::string &name, const std::string &desc,
 }
 
 bool PinKnob::ValueBool(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_BOOL);
   return ((KNOB<bool> *)it->second.second)->Value();
 }
 
 int PinKnob::ValueInt(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_INT);
   return ((KNOB<int> *)it->second.second)->Value();
 }
 
 std::string PinKnob::ValueStr(const std::string &name) {
+  CheckLookup(name);
   KnobNameMap::iterator it = knob_table_.find(name);
   DEBUG_ASSERT(it != knob_table_.end() && it->second.first == KNOB_TYPE_STR);
   return ((KNOB<std::string> *)it->second.second)->Value();
@@ -62,3 +62,23 @@ bool BBLContainMemOp(BBL bbl) {
   return false;
 }
 
+
+size_t WalkFramePointers(ADDRINT fp, ADDRINT *frames, size_t max_frames) {
+  size_t num_frames = 0;
+  while (fp && num_frames < max_frames) {
+    // Each frame starts with the saved frame pointer of the caller, followed
+    // by the return address.
+    ADDRINT frame[2];
+    if (PIN_SafeCopy(frame, (VOID *)fp, sizeof(frame)) != sizeof(frame))
+      break;
+    if (!frame[1])
+      break;
+    frames[num_frames++] = frame[1];
+    // The stack grows downwards, so the caller's frame must be above us.
+    // Otherwise, the binary is not compiled with frame pointers.
+    if (frame[0] <= fp)
+      break;
+    fp = frame[0];
+  }
+  return num_frames;
+}
@@ -34,5 +34,11 @@ extern IMG GetImgByTrace(TRACE trace);
 // Return whether the given bbl contains non-stack memory access.
 extern bool BBLContainMemOp(BBL bbl);
 
+// Walk the frame pointer chain of the application starting from the frame
+// pointer fp. The return addresses are stored in frames, from the innermost
+// to the outermost. Return the number of frames found.
+extern size_t WalkFramePointers(ADDRINT fp, ADDRINT *frames,
+                                size_t max_frames);
+
 #endif
 
@@ -19,6 +19,7 @@
 #ifndef CORE_SYNC_H_
 #define CORE_SYNC_H_
 
+#include <pthread.h>
 #include <semaphore.h>
 
 #include "core/basictypes.h"
@@ -98,6 +99,23 @@ class NullRWMutex : public RWMutex {
   DISALLOW_COPY_CONSTRUCTORS(NullRWMutex);
 };
 
+// Define the mutex implemented by the underlying os (used in
+// multi-threaded offline tools).
+class SysMutex : public Mutex {
+ public:
+  SysMutex() { pthread_mutex_init(&mutex_, NULL); }
+  ~SysMutex() { pthread_mutex_destroy(&mutex_); }
+
+  void Lock() { pthread_mutex_lock(&mutex_); }
+  void Unlock() { pthread_mutex_unlock(&mutex_); }
+  Mutex *Clone() { return new SysMutex; }
+
+ private:
+  pthread_mutex_t mutex_;
+
+  DISALLOW_COPY_CONSTRUCTORS(SysMutex);
+};
+
 // Define the semaphore implemented by the underlying os.
 class SysSemaphore : public Semaphore {
  public:
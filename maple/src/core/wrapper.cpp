@@ -31,6 +31,14 @@ REGISTER_WRAPPER(Valloc);
 REGISTER_WRAPPER(Sleep);
 REGISTER_WRAPPER(Usleep);
 
+REGISTER_WRAPPER(Nanosleep);
+REGISTER_WRAPPER(ClockNanosleep);
+REGISTER_WRAPPER(Gettimeofday);
+REGISTER_WRAPPER(ClockGettime);
+REGISTER_WRAPPER(Poll);
+REGISTER_WRAPPER(Select);
+REGISTER_WRAPPER(EpollWait);
+
 REGISTER_WRAPPER(Exit);
 
 REGISTER_WRAPPER(SchedSetScheduler);
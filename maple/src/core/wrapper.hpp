@@ -21,8 +21,13 @@
 
 #include "pin.H"
 
+#include <poll.h>
 #include <pthread.h>
 #include <sched.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <cassert>
@@ -72,6 +77,7 @@ class WrapperBase {
 #define MEMBER_ARGS_2 MEMBER_ARGS_1; A1 arg1_
 #define MEMBER_ARGS_3 MEMBER_ARGS_2; A2 arg2_
 #define MEMBER_ARGS_4 MEMBER_ARGS_3; A3 arg3_
+#define MEMBER_ARGS_5 MEMBER_ARGS_4; A4 arg4_
 #define MEMBER_ARGS(i) MEMBER_ARGS_##i
 
 #define ARGS_0
@@ -79,6 +85,7 @@ class WrapperBase {
 #define ARGS_2 ARGS_1, A1 arg1
 #define ARGS_3 ARGS_2, A2 arg2
 #define ARGS_4 ARGS_3, A3 arg3
+#define ARGS_5 ARGS_4, A4 arg4
 #define ARGS(i) ARGS_##i
 
 #define SET_ARGS_0
@@ -86,6 +93,7 @@ class WrapperBase {
 #define SET_ARGS_2 SET_ARGS_1; wrapper.arg1_ = arg1
 #define SET_ARGS_3 SET_ARGS_2; wrapper.arg2_ = arg2
 #define SET_ARGS_4 SET_ARGS_3; wrapper.arg3_ = arg3
+#define SET_ARGS_5 SET_ARGS_4; wrapper.arg4_ = arg4
 #define SET_ARGS(i) SET_ARGS_##i
 
 #define PARGS_0
@@ -93,6 +101,7 @@ class WrapperBase {
 #define PARGS_2 PARGS_1 PIN_PARG(A1), arg1_,
 #define PARGS_3 PARGS_2 PIN_PARG(A2), arg2_,
 #define PARGS_4 PARGS_3 PIN_PARG(A3), arg3_,
+#define PARGS_5 PARGS_4 PIN_PARG(A4), arg4_,
 #define PARGS(i) PARGS_##i
 
 #define PROTO_PARGS_0
@@ -100,6 +109,7 @@ class WrapperBase {
 #define PROTO_PARGS_2 PROTO_PARGS_1 PIN_PARG(A1),
 #define PROTO_PARGS_3 PROTO_PARGS_2 PIN_PARG(A2),
 #define PROTO_PARGS_4 PROTO_PARGS_3 PIN_PARG(A3),
+#define PROTO_PARGS_5 PROTO_PARGS_4 PIN_PARG(A4),
 #define PROTO_PARGS(i) PROTO_PARGS_##i
 
 #define IARGS_0
@@ -107,6 +117,7 @@ class WrapperBase {
 #define IARGS_2 IARGS_1 IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
 #define IARGS_3 IARGS_2 IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
 #define IARGS_4 IARGS_3 IARG_FUNCARG_ENTRYPOINT_VALUE, 3,
+#define IARGS_5 IARGS_4 IARG_FUNCARG_ENTRYPOINT_VALUE, 4,
 #define IARGS(i) IARGS_##i
 
 #define TYPENAME_ARGS_0
@@ -114,6 +125,7 @@ class WrapperBase {
 #define TYPENAME_ARGS_2 TYPENAME_ARGS_1, typename A1
 #define TYPENAME_ARGS_3 TYPENAME_ARGS_2, typename A2
 #define TYPENAME_ARGS_4 TYPENAME_ARGS_3, typename A3
+#define TYPENAME_ARGS_5 TYPENAME_ARGS_4, typename A4
 #define TYPENAME_ARGS(i) TYPENAME_ARGS_##i
 
 #define PARAM_ARGS_0
@@ -121,6 +133,7 @@ class WrapperBase {
 #define PARAM_ARGS_2 PARAM_ARGS_1, A1
 #define PARAM_ARGS_3 PARAM_ARGS_2, A2
 #define PARAM_ARGS_4 PARAM_ARGS_3, A3
+#define PARAM_ARGS_5 PARAM_ARGS_4, A4
 #define PARAM_ARGS(i) PARAM_ARGS_##i
 
 #define ARG_ACCESSORS_0
@@ -128,8 +141,17 @@ class WrapperBase {
 #define ARG_ACCESSORS_2 ARG_ACCESSORS_1 A1 arg1() { return arg1_; }
 #define ARG_ACCESSORS_3 ARG_ACCESSORS_2 A2 arg2() { return arg2_; }
 #define ARG_ACCESSORS_4 ARG_ACCESSORS_3 A3 arg3() { return arg3_; }
+#define ARG_ACCESSORS_5 ARG_ACCESSORS_4 A4 arg4() { return arg4_; }
 #define ARG_ACCESSORS(i) ARG_ACCESSORS_##i
 
+#define ARG_SETTERS_0
+#define ARG_SETTERS_1 void set_arg0(A0 arg0) { arg0_ = arg0; }
+#define ARG_SETTERS_2 ARG_SETTERS_1 void set_arg1(A1 arg1) { arg1_ = arg1; }
+#define ARG_SETTERS_3 ARG_SETTERS_2 void set_arg2(A2 arg2) { arg2_ = arg2; }
+#define ARG_SETTERS_4 ARG_SETTERS_3 void set_arg3(A3 arg3) { arg3_ = arg3; }
+#define ARG_SETTERS_5 ARG_SETTERS_4 void set_arg4(A4 arg4) { arg4_ = arg4; }
+#define ARG_SETTERS(i) ARG_SETTERS_##i
+
 // Define member functions.
 #define MEMBERS(R, NUM_ARGS)                                                \
   R ret_val_;                                                               \
@@ -141,10 +163,12 @@ class WrapperBase {
 #define ACCESSORS(R, NUM_ARGS)                                              \
   R ret_val() { return ret_val_; }                                          \
   void set_ret_val(R ret_val) { ret_val_ = ret_val; }                       \
-  ARG_ACCESSORS(NUM_ARGS)
+  ARG_ACCESSORS(NUM_ARGS)                                                   \
+  ARG_SETTERS(NUM_ARGS)
 
 #define ACCESSORS_NORET(NUM_ARGS)                                           \
-  ARG_ACCESSORS(NUM_ARGS)
+  ARG_ACCESSORS(NUM_ARGS)                                                   \
+  ARG_SETTERS(NUM_ARGS)
 
 #define CALL_ORIGINAL(R, NUM_ARGS)                                          \
   void CallOriginal() {                                                     \
@@ -318,12 +342,14 @@ WRAPPER_TEMPLATE(1);
 WRAPPER_TEMPLATE(2);
 WRAPPER_TEMPLATE(3);
 WRAPPER_TEMPLATE(4);
+WRAPPER_TEMPLATE(5);
 
 WRAPPER_TEMPLATE_NORET(0);
 WRAPPER_TEMPLATE_NORET(1);
 WRAPPER_TEMPLATE_NORET(2);
 WRAPPER_TEMPLATE_NORET(3);
 WRAPPER_TEMPLATE_NORET(4);
+WRAPPER_TEMPLATE_NORET(5);
 
 // The factory class for function wrappers.
 class WrapperFactory {
@@ -418,6 +444,25 @@ class WrapperFactory {
     }                                                                       \
   } while (0)
 
+// Same as ACTIVATE_WRAPPER, but skip the function if the library does not
+// define it (e.g. functions that moved between libc and librt).
+#define ACTIVATE_OPTIONAL_WRAPPER(name, img, handler)                       \
+  do {                                                                      \
+    WRAPPER_CLASS(name) *wrapper =                                          \
+      WrapperFactory::Find<WRAPPER_CLASS(name)>(#name);                     \
+    assert(wrapper);                                                        \
+    if (IMG_Name(img).find(wrapper->lib()) != std::string::npos) {          \
+      RTN rtn = FindRTN(img, wrapper->func());                              \
+      if (RTN_Valid(rtn)) {                                                 \
+        DEBUG_FMT_PRINT_SAFE("Activate wrapper %s in %s\n",                 \
+                             wrapper->func().c_str(),                       \
+                             wrapper->lib().c_str());                       \
+        wrapper->set_ori_funptr(RTN_Funptr(rtn));                           \
+        wrapper->Activate(rtn, handler);                                    \
+      }                                                                     \
+    }                                                                       \
+  } while (0)
+
 // Declare wrappers.
 WRAPPER(Malloc, "malloc", "libc.so", "malloc", void *(size_t));
 WRAPPER(Calloc, "calloc", "libc.so", "malloc", void *(size_t, size_t));
@@ -430,6 +475,14 @@ WRAPPER(Exit, "exit", "libc.so", "pthread", void (int));
 WRAPPER(Sleep, "sleep", "libc.so", "unistd", unsigned int(unsigned int));
 WRAPPER(Usleep, "usleep", "libc.so", "unistd", int(useconds_t));
 
+WRAPPER(Nanosleep, "nanosleep", "libc.so", "time", int(const struct timespec *, struct timespec *));
+WRAPPER(ClockNanosleep, "clock_nanosleep", "libc.so", "time", int(clockid_t, int, const struct timespec *, struct timespec *));
+WRAPPER(Gettimeofday, "gettimeofday", "libc.so", "time", int(struct timeval *, struct timezone *));
+WRAPPER(ClockGettime, "clock_gettime", "libc.so", "time", int(clockid_t, struct timespec *));
+WRAPPER(Poll, "poll", "libc.so", "time", int(struct pollfd *, nfds_t, int));
+WRAPPER(Select, "select", "libc.so", "time", int(int, fd_set *, fd_set *, fd_set *, struct timeval *));
+WRAPPER(EpollWait, "epoll_wait", "libc.so", "time", int(int, struct epoll_event *, int, int));
+
 WRAPPER(SchedSetScheduler, "sched_setscheduler", "libc.so", "sched", int(pid_t, int, struct sched_param *));
 WRAPPER(SchedYield, "sched_yield", "libc.so", "sched", int(void));
 WRAPPER(SchedSetAffinity, "sched_setaffinity", "libc.so", "sched", int(pid_t, size_t, cpu_set_t *));
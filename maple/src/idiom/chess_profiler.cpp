@@ -55,6 +55,10 @@ void ChessProfiler::HandlePreSetup() {
 void ChessProfiler::HandlePostSetup() {
   systematic::Controller::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("ignore_lib", &ignore_lib_);
+  knob_->Bind("ignore_ic_pthread", &ignore_ic_pthread_);
+
   // load iroot db
   iroot_db_ = new iRootDB(CreateMutex());
   iroot_db_->Load(knob_->ValueStr("iroot_in"), sinfo_);
@@ -89,7 +93,7 @@ void ChessProfiler::HandlePostSetup() {
 }
 
 bool ChessProfiler::HandleIgnoreInstCount(IMG img) {
-  if (knob_->ValueBool("ignore_ic_pthread")) {
+  if (ignore_ic_pthread_.Value()) {
     if (!IMG_Valid(img))
       return false;
     Image *image = sinfo_->FindImage(IMG_Name(img));
@@ -107,7 +111,7 @@ bool ChessProfiler::HandleIgnoreMemAccess(IMG img) {
   DEBUG_ASSERT(image);
   if (image->IsPthread())
     return true;
-  if (knob_->ValueBool("ignore_lib")) {
+  if (ignore_lib_.Value()) {
     if (image->IsCommonLib())
       return true;
   }
@@ -50,6 +50,9 @@ class ChessProfiler : public systematic::Controller {
   sinst::SharedInstAnalyzer *sinst_analyzer_;
   Observer *observer_;
   ObserverNew *observer_new_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
+  BoolKnobHandle ignore_ic_pthread_;
 
   DISALLOW_COPY_CONSTRUCTORS(ChessProfiler);
 };
@@ -20,19 +20,28 @@
 
 #include <fstream>
 
+#include "core/logging.h"
+
 namespace idiom {
 
 void TestHistory::CreateEntry(iRoot *iroot) {
+  // one entry for each iroot tested in the current execution
   curr_proto_ = table_proto_.add_history();
   curr_proto_->set_iroot_id(iroot->id());
+  curr_proto_map_[iroot->id()] = curr_proto_;
 }
 
 void TestHistory::UpdateSeed(unsigned int seed) {
-  curr_proto_->set_seed(seed);
+  for (CurrProtoMap::iterator it = curr_proto_map_.begin();
+       it != curr_proto_map_.end(); ++it) {
+    it->second->set_seed(seed);
+  }
 }
 
-void TestHistory::UpdateResult(bool success) {
-  curr_proto_->set_success(success);
+void TestHistory::UpdateResult(iRoot *iroot, bool success) {
+  CurrProtoMap::iterator it = curr_proto_map_.find(iroot->id());
+  DEBUG_ASSERT(it != curr_proto_map_.end());
+  it->second->set_success(success);
 }
 
 int TestHistory::TotalTestRuns(iRoot *iroot) {
@@ -19,6 +19,7 @@
 #ifndef IDIOM_HISTORY_H_
 #define IDIOM_HISTORY_H_
 
+#include <map>
 #include <vector>
 
 #include "core/basictypes.h"
@@ -35,14 +36,17 @@ class TestHistory {
 
   void CreateEntry(iRoot *iroot);
   void UpdateSeed(unsigned int seed);
-  void UpdateResult(bool success);
+  void UpdateResult(iRoot *iroot, bool success);
   int TotalTestRuns(iRoot *iroot);
   void Load(const std::string &file_name);
   void Save(const std::string &file_name);
 
  private:
+  typedef std::map<iroot_id_t, HistoryProto *> CurrProtoMap;
+
   HistoryTableProto table_proto_;
   HistoryProto *curr_proto_;
+  CurrProtoMap curr_proto_map_; // the entries of the current execution
 
   DISALLOW_COPY_CONSTRUCTORS(TestHistory);
 };
@@ -129,6 +129,24 @@ iRoot *iRootDB::FindiRoot(iroot_id_t iroot_id, bool locking) {
     return it->second;
 }
 
+iRoot *iRootDB::ImportiRoot(iRoot *other, bool locking) {
+  // get the iroot that has the same idiom and events as the given iroot,
+  // which may belong to another iroot database
+  ScopedLock locker(internal_lock_, locking);
+
+  iRootEventVec events;
+  for (int i = 0; i < iRoot::GetNumEvents(other->idiom()); i++) {
+    iRootEvent *other_event = other->GetEvent(i);
+    events.push_back(GetiRootEvent(other_event->inst(), other_event->type(),
+                                   false));
+  }
+
+  iRoot *iroot = FindiRoot(other->idiom(), &events, false);
+  if (!iroot)
+    iroot = CreateiRoot(other->idiom(), &events, false);
+  return iroot;
+}
+
 iRootEvent *iRootDB::FindiRootEvent(Inst *inst, iRootEventType type,
                                     bool locking) {
   ScopedLock locker(internal_lock_, locking);
@@ -110,6 +110,7 @@ class iRootDB {
   iRootEvent *FindiRootEvent(iroot_event_id_t event_id, bool locking);
   iRoot *GetiRoot(IdiomType idiom, bool locking, ...);
   iRoot *FindiRoot(iroot_id_t iroot_id, bool locking);
+  iRoot *ImportiRoot(iRoot *other, bool locking);
   void Load(const std::string &db_name, StaticInfo *sinfo);
   void Save(const std::string &db_name, StaticInfo *sinfo);
 
@@ -18,8 +18,16 @@
 
 #include "idiom/memo.h"
 
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
 #include <cassert>
+#include <cstdio>
 #include <algorithm>
+#include <fstream>
 #include "core/logging.h"
 
 namespace idiom {
@@ -114,6 +122,68 @@ iRoot *Memo::ChooseForTest(iroot_id_t iroot_id) {
   return iroot;
 }
 
+void Memo::ChooseBatchForTest(iRoot *first, IdiomType idiom, size_t max_size,
+                              std::vector<iRoot *> *batch) {
+  // choose a batch of iroots that can be tested in one execution, starting
+  // from the given iroot. the events of the iroots in a batch should not
+  // share any instruction, so that each instruction drives at most one
+  // state machine in the active scheduler. the candidates are considered in
+  // the same order as in ChooseForTest: by idiom priority, then iroots from
+  // the application first, then the smallest number of test runs.
+  // IDIOM_INVALID means any idiom.
+  //
+  // the initial priority order of an execution alternates with the number
+  // of test runs of the first iroot. only the iroots whose own next order
+  // is the same are added, so that each iroot in a batch is still tested
+  // with both orders before it is given up.
+  std::tr1::unordered_set<Inst *> used_inst_set;
+  batch->clear();
+  batch->push_back(first);
+  for (int i = 0; i < iRoot::GetNumEvents(first->idiom()); i++)
+    used_inst_set.insert(first->GetEvent(i)->inst());
+  int first_parity = TotalTestRuns(first, false) % 2;
+
+  // the key is ((idiom, lib), (test runs, iroot id))
+  typedef std::pair<std::pair<int, int>, std::pair<int, iroot_id_t> > Key;
+  std::map<Key, iRootInfo *> candidates;
+  for (CandidateMap::iterator it = candidate_map_.begin();
+       it != candidate_map_.end(); ++it) {
+    iRootInfo *iroot_info = it->first;
+    iRoot *iroot = iroot_info->iroot();
+    if (iroot == first)
+      continue;
+    if (idiom != IDIOM_INVALID && iroot->idiom() != idiom)
+      continue;
+    if (iroot_info->total_test_runs() % 2 != first_parity)
+      continue;
+    int lib = iroot->HasCommonLibEvent() ? 1 : 0;
+    Key key(std::make_pair((int)iroot->idiom(), lib),
+            std::make_pair(iroot_info->total_test_runs(), iroot->id()));
+    candidates[key] = iroot_info;
+  }
+
+  for (std::map<Key, iRootInfo *>::iterator it = candidates.begin();
+       it != candidates.end(); ++it) {
+    if (batch->size() >= max_size)
+      return;
+    iRoot *iroot = it->second->iroot();
+    int num_events = iRoot::GetNumEvents(iroot->idiom());
+    bool disjoint = true;
+    for (int i = 0; i < num_events; i++) {
+      if (used_inst_set.find(iroot->GetEvent(i)->inst()) !=
+          used_inst_set.end()) {
+        disjoint = false;
+        break;
+      }
+    }
+    if (!disjoint)
+      continue;
+    batch->push_back(iroot);
+    for (int i = 0; i < num_events; i++)
+      used_inst_set.insert(iroot->GetEvent(i)->inst());
+  }
+}
+
 void Memo::TestSuccess(iRoot *iroot, bool locking) {
   ScopedLock locker(internal_lock_, locking);
 
@@ -311,6 +381,19 @@ void Memo::Merge(Memo *other) {
   }
 }
 
+void Memo::MergePredicted(Memo *other, bool locking) {
+  // the iroots of the other memo may come from another iroot database
+  ScopedLock locker(internal_lock_, locking);
+
+  for (iRootInfoSet::iterator it = other->predicted_set_.begin();
+       it != other->predicted_set_.end(); ++it) {
+    iRoot *iroot = iroot_db_->ImportiRoot((*it)->iroot(), false);
+    Predicted(iroot, false);
+    if ((*it)->async())
+      SetAsync(iroot, false);
+  }
+}
+
 void Memo::RefineCandidate(bool memo_failed) {
   iRootInfoSet to_remove;
 
@@ -341,6 +424,13 @@ void Memo::RefineCandidate(bool memo_failed) {
   }
 }
 
+void Memo::Exclude(iRoot *iroot) {
+  // do not choose the given iroot in this process
+  iRootInfo *iroot_info = FindiRootInfo(iroot, false);
+  if (iroot_info)
+    candidate_map_.erase(iroot_info);
+}
+
 void Memo::SampleCandidate(IdiomType idiom, size_t num) {
   // Find all the iroot info that match the given idiom.
   std::vector<iRootInfo *> iroot_info_vec;
@@ -461,10 +551,19 @@ void Memo::Save(const std::string &db_name, StaticInfo *sinfo) {
     candidate_proto->set_test_runs(it->second);
   }
 
+  // write to a temporary file first so that concurrent readers always see
+  // a complete database
+  std::string tmp_name = db_name + ".tmp";
   std::fstream out;
-  out.open(db_name.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+  out.open(tmp_name.c_str(),
+           std::ios::out | std::ios::trunc | std::ios::binary);
   proto_.SerializeToOstream(&out);
   out.close();
+  if (rename(tmp_name.c_str(), db_name.c_str()) != 0) {
+    fprintf(stderr, "failed to save the memo db %s: %s\n", db_name.c_str(),
+            strerror(errno));
+    assert(0);
+  }
 }
 
 iRootInfo *Memo::GetiRootInfo(iRoot *iroot, bool locking) {
@@ -497,5 +596,85 @@ iRootInfo *Memo::CreateiRootInfo(iRoot *iroot, bool locking) {
   return iroot_info;
 }
 
-} // namespace idiom
+MemoJournal::MemoJournal(const std::string &db_name)
+    : journal_name_(db_name + ".journal"),
+      lock_name_(db_name + ".lock"),
+      lock_fd_(-1) {
+  // empty
+}
+
+MemoJournal::~MemoJournal() {
+  if (lock_fd_ >= 0)
+    close(lock_fd_);
+}
+
+void MemoJournal::Lock() {
+  if (lock_fd_ < 0) {
+    lock_fd_ = open(lock_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    DEBUG_ASSERT(lock_fd_ >= 0);
+  }
+  while (flock(lock_fd_, LOCK_EX) != 0) {
+    // retry if interrupted
+  }
+}
 
+void MemoJournal::Unlock() {
+  DEBUG_ASSERT(lock_fd_ >= 0);
+  flock(lock_fd_, LOCK_UN);
+}
+
+void MemoJournal::Exclude(Memo *memo, iRootDB *iroot_db) {
+  // replay the journal to find the iroots being tested. each entry records
+  // the pid of the run, and the claims of the runs that are no longer alive
+  // (e.g. killed or crashed) are expired.
+  std::map<iroot_id_t, std::map<pid_t, int> > claimed;
+  std::ifstream in(journal_name_.c_str());
+  char op;
+  iroot_id_t iroot_id;
+  pid_t pid;
+  while (in >> op >> iroot_id >> pid) {
+    if (op == '+')
+      claimed[iroot_id][pid]++;
+    else if (op == '-')
+      claimed[iroot_id][pid]--;
+  }
+  in.close();
+
+  std::map<pid_t, bool> alive;
+  for (std::map<iroot_id_t, std::map<pid_t, int> >::iterator it =
+       claimed.begin(); it != claimed.end(); ++it) {
+    bool active = false;
+    for (std::map<pid_t, int>::iterator pit = it->second.begin();
+         pit != it->second.end() && !active; ++pit) {
+      if (pit->second <= 0)
+        continue;
+      std::map<pid_t, bool>::iterator ait = alive.find(pit->first);
+      if (ait == alive.end()) {
+        bool is_alive = kill(pit->first, 0) == 0 || errno == EPERM;
+        ait = alive.insert(std::make_pair(pit->first, is_alive)).first;
+      }
+      active = ait->second;
+    }
+    if (!active)
+      continue;
+    iRoot *iroot = iroot_db->FindiRoot(it->first, false);
+    if (iroot)
+      memo->Exclude(iroot);
+  }
+}
+
+void MemoJournal::Claim(iRoot *iroot) {
+  Append('+', iroot);
+}
+
+void MemoJournal::Release(iRoot *iroot) {
+  Append('-', iroot);
+}
+
+void MemoJournal::Append(char op, iRoot *iroot) {
+  std::ofstream out(journal_name_.c_str(), std::ios::out | std::ios::app);
+  out << op << " " << iroot->id() << " " << getpid() << std::endl;
+  out.close();
+}
+
+} // namespace idiom
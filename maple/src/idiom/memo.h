@@ -19,6 +19,7 @@
 #ifndef IDIOM_MEMO_H_
 #define IDIOM_MEMO_H_
 
+#include <vector>
 #include <tr1/unordered_map>
 #include <tr1/unordered_set>
 
@@ -69,6 +70,8 @@ class Memo {
   iRoot *ChooseForTest();
   iRoot *ChooseForTest(IdiomType idiom);
   iRoot *ChooseForTest(iroot_id_t iroot_id);
+  void ChooseBatchForTest(iRoot *first, IdiomType idiom, size_t max_size,
+                          std::vector<iRoot *> *batch);
   void TestSuccess(iRoot *iroot, bool locking);
   void TestFail(iRoot *iroot, bool locking);
   void Predicted(iRoot *iroot, bool locking);
@@ -80,7 +83,9 @@ class Memo {
   size_t TotalExposed(IdiomType idiom, bool shadow, bool locking);
   size_t TotalPredicted(bool locking);
   void Merge(Memo *other);
+  void MergePredicted(Memo *other, bool locking);
   void RefineCandidate(bool memo_failed);
+  void Exclude(iRoot *iroot);
   void SampleCandidate(IdiomType idiom, size_t num);
   void Load(const std::string &db_name, StaticInfo *sinfo);
   void Save(const std::string &db_name, StaticInfo *sinfo);
@@ -110,6 +115,35 @@ class Memo {
   DISALLOW_COPY_CONSTRUCTORS(Memo);
 };
 
+// The journal of a memoization database that is shared by concurrent
+// active testing runs. Each run claims the iroots it is going to test so
+// that the other runs will not choose them, and releases them after its
+// results are merged back into the database. The journal is append-only,
+// and is protected (together with the database) by a file lock. Claims are
+// tagged with the pid of the run, and expire when that run is gone.
+class MemoJournal {
+ public:
+  explicit MemoJournal(const std::string &db_name);
+  ~MemoJournal();
+
+  void Lock();
+  void Unlock();
+  // the following functions should be called with the lock held
+  void Exclude(Memo *memo, iRootDB *iroot_db);
+  void Claim(iRoot *iroot);
+  void Release(iRoot *iroot);
+
+ protected:
+  void Append(char op, iRoot *iroot);
+
+  std::string journal_name_;
+  std::string lock_name_;
+  int lock_fd_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(MemoJournal);
+};
+
 } // namespace idiom
 
 #endif
@@ -19,9 +19,80 @@
 #include "idiom/observer.h"
 
 #include "core/logging.h"
+#include "core/stat.h"
 
 namespace idiom {
 
+void ObserverLocalInfo::Init(size_t capacity, size_t max_succs,
+                             size_t max_local_prevs) {
+  size_t size = 1;
+  while (size < capacity)
+    size <<= 1;
+  max_succs_ = max_succs;
+  max_local_prevs_ = max_local_prevs;
+  entries_.resize(size);
+  succs_.resize(size * max_succs);
+  local_prevs_.resize(size * max_succs * max_local_prevs);
+  for (size_t i = 0; i < size; i++) {
+    entries_[i].succs = &succs_[i * max_succs];
+    for (size_t j = 0; j < max_succs; j++) {
+      size_t idx = i * max_succs + j;
+      succs_[idx].local_prevs = max_local_prevs ?
+          &local_prevs_[idx * max_local_prevs] : NULL;
+    }
+  }
+  Clear();
+}
+
+ObserverLocalInfo::EntryType *ObserverLocalInfo::Push() {
+  // overwrite the oldest entry if the buffer is full
+  if (size_ == entries_.size())
+    PopFront();
+  EntryType *entry = &Get(size_);
+  size_++;
+  entry->superseded = false;
+  entry->num_succs = 0;
+  return entry;
+}
+
+void ObserverLocalInfo::PopFront() {
+  DEBUG_ASSERT(size_ > 0);
+  head_ = (head_ + 1) & (entries_.size() - 1);
+  size_--;
+}
+
+size_t ObserverLocalInfo::LowerBound(timestamp_t clk) {
+  // binary search the first entry whose clock is not less than clk
+  size_t low = 0;
+  size_t high = size_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (Get(mid).access.clk_ < clk)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+size_t ObserverLocalInfo::NumSuccs(EntryType *entry) {
+  if (entry->num_succs < max_succs_)
+    return entry->num_succs;
+  else
+    return max_succs_;
+}
+
+void ObserverLocalInfo::AddSucc(EntryType *entry, SuccEntry *succ_entry) {
+  if (entry->num_succs >= max_succs_)
+    STAT_INC_SAFE("ob_dropped_succs", 1);
+  SuccEntry &se = entry->succs[entry->num_succs % max_succs_];
+  se.succ = succ_entry->succ;
+  se.num_local_prevs = succ_entry->num_local_prevs;
+  for (size_t i = 0; i < succ_entry->num_local_prevs; i++)
+    se.local_prevs[i] = succ_entry->local_prevs[i];
+  entry->num_succs++;
+}
+
 Observer::Observer()
     : internal_lock_(NULL),
       sinfo_(NULL),
@@ -33,6 +104,8 @@ Observer::Observer()
       unit_size_(4),
       complex_idioms_(false),
       vw_(1000),
+      max_succs_(4),
+      max_local_prevs_(8),
       filter_(NULL) {
   // empty
 }
@@ -49,6 +122,8 @@ void Observer::Register() {
   knob_->RegisterBool("complex_idioms", "whether target complex idioms", "0");
   knob_->RegisterInt("unit_size", "the monitoring granularity in bytes", "4");
   knob_->RegisterInt("vw", "the vulnerability window (# dynamic inst)", "1000");
+  knob_->RegisterInt("observer_max_succs", "the max number of successors recorded for each local access (complex idioms)", "4");
+  knob_->RegisterInt("observer_max_local_prevs", "the max number of local predecessors recorded for each successor (idiom-5)", "8");
 }
 
 bool Observer::Enabled() {
@@ -68,6 +143,11 @@ void Observer::Setup(Mutex *lock, StaticInfo *sinfo, iRootDB *iroot_db,
   unit_size_ = knob_->ValueInt("unit_size");
   complex_idioms_ = knob_->ValueBool("complex_idioms");
   vw_ = knob_->ValueInt("vw");
+  max_succs_ = (size_t)knob_->ValueInt("observer_max_succs");
+  max_local_prevs_ = (size_t)knob_->ValueInt("observer_max_local_prevs");
+  if (max_succs_ < 1)
+    max_succs_ = 1;
+  local_prevs_buf_.resize(max_local_prevs_);
   filter_ = new RegionFilter(internal_lock_->Clone());
 
   if (!sync_only_)
@@ -112,7 +192,8 @@ void Observer::ThreadStart(thread_id_t curr_thd_id, thread_id_t parent_thd_id) {
 void Observer::ThreadExit(thread_id_t curr_thd_id, timestamp_t curr_thd_clk) {
   ScopedLock locker(internal_lock_);
 
-  local_info_map_[curr_thd_id].Clear();
+  // release the local access buffer
+  local_info_map_.erase(curr_thd_id);
 }
 
 void Observer::BeforeMemRead(thread_id_t curr_thd_id, timestamp_t curr_thd_clk,
@@ -439,77 +520,81 @@ void Observer::UpdateLocalInfo(ObserverAccess *curr_access, address_t addr,
   thread_id_t curr_thd_id = curr_access->thd_id_;
   timestamp_t curr_time = curr_access->clk_;
   ObserverLocalInfo &curr_li = local_info_map_[curr_thd_id];
+  if (!curr_li.Initialized())
+    curr_li.Init(vw_, max_succs_, max_local_prevs_);
 
   // iterator recent accesses, calculate distance, discover complex iroots
-  std::tr1::unordered_set<address_t> touched_addr_set;
-  std::vector<ObserverAccess> local_prev_vec;
-  for (ObserverLocalInfo::EntryMap::reverse_iterator mit =
-          curr_li.entries_.rbegin(); mit != curr_li.entries_.rend(); ++mit) {
-    timestamp_t time = mit->first;
-
-    if (TIME_DISTANCE(time, curr_time) < vw_) {
-      bool need_break = false;
-      for (ObserverLocalInfo::EntryVec::reverse_iterator vit =
-              mit->second.rbegin(); vit != mit->second.rend(); ++vit) {
-        ObserverLocalInfo::EntryType &entry = *vit;
-        if (touched_addr_set.find(entry.addr) != touched_addr_set.end())
-          continue;
-        // add to the touched address set
-        touched_addr_set.insert(entry.addr);
-        if (time != curr_time) {
-          local_prev_vec.push_back(entry.access);
-          UpdateComplexiRoots(curr_access, preds, &entry.access, &entry.succs,
-                              (entry.addr == addr));
-        }
-        if (entry.addr == addr) {
-          need_break = true;
-          break;
-        }
-      } // end of for
-      if (need_break)
-        break;
-    } else {
+  ObserverLocalInfo::SuccEntry succ_entry;
+  succ_entry.succ = *curr_access;
+  succ_entry.num_local_prevs = 0;
+  succ_entry.local_prevs = local_prevs_buf_.empty() ? NULL
+                                                    : &local_prevs_buf_[0];
+  size_t num_dropped_local_prevs = 0;
+  ObserverLocalInfo::EntryType *same_addr_entry = NULL;
+  for (size_t idx = curr_li.size_; idx > 0; idx--) {
+    ObserverLocalInfo::EntryType &entry = curr_li.Get(idx - 1);
+    timestamp_t time = entry.access.clk_;
+    if (TIME_DISTANCE(time, curr_time) >= vw_)
+      break;
+    // only consider the most recent access to each address
+    if (entry.superseded)
+      continue;
+    if (time != curr_time) {
+      if (succ_entry.num_local_prevs < max_local_prevs_) {
+        ObserverLocalInfo::LocalPrev &local_prev
+            = succ_entry.local_prevs[succ_entry.num_local_prevs++];
+        local_prev.clk = entry.access.clk_;
+        local_prev.type = entry.access.type_;
+        local_prev.inst = entry.access.inst_;
+      } else {
+        num_dropped_local_prevs++;
+      }
+      UpdateComplexiRoots(curr_access, preds, &entry, (entry.addr == addr));
+    }
+    if (entry.addr == addr) {
+      same_addr_entry = &entry;
       break;
     }
   }
+  if (num_dropped_local_prevs)
+    STAT_INC_SAFE("ob_dropped_local_prevs", num_dropped_local_prevs);
 
   // add curr_access to the succ of all the pred entries
   for (std::vector<ObserverAccess>::iterator it = preds->begin();
        it != preds->end(); ++it) {
     ObserverAccess &access = *it;
-    timestamp_t time = access.clk_;
-    ObserverLocalInfo &li = local_info_map_[access.thd_id_];
-    ObserverLocalInfo::EntryMap::iterator mit = li.entries_.find(time);
-    if (mit != li.entries_.end()) {
-      for (ObserverLocalInfo::EntryVec::iterator vit = mit->second.begin();
-           vit != mit->second.end(); ++vit) {
-        if (addr == vit->addr &&
-            access.type_ == vit->access.type_ &&
-            access.inst_ == vit->access.inst_) {
-          ObserverLocalInfo::SuccEntry succ_entry;
-          succ_entry.succ = *curr_access;
-          succ_entry.local_prev_vec = local_prev_vec;
-          vit->succs.push_back(succ_entry);
-        }
+    std::map<thread_id_t, ObserverLocalInfo>::iterator lit
+        = local_info_map_.find(access.thd_id_);
+    if (lit == local_info_map_.end())
+      continue;
+    ObserverLocalInfo &li = lit->second;
+    for (size_t idx = li.LowerBound(access.clk_); idx < li.size_; idx++) {
+      ObserverLocalInfo::EntryType &entry = li.Get(idx);
+      if (entry.access.clk_ != access.clk_)
+        break;
+      if (addr == entry.addr &&
+          access.type_ == entry.access.type_ &&
+          access.inst_ == entry.access.inst_) {
+        li.AddSucc(&entry, &succ_entry);
       }
     }
   }
 
-  // remove stale entries if local info is so large
-  while (!curr_li.entries_.empty()) {
-    ObserverLocalInfo::EntryMap::iterator it = curr_li.entries_.begin();
-    if (TIME_DISTANCE(it->first, curr_time) >= vw_) {
-      curr_li.entries_.erase(it);
-    } else {
-      break;
-    }
+  // the previous local access to the same address is no longer the most
+  // recent one (mark it before it could be overwritten below)
+  if (same_addr_entry)
+    same_addr_entry->superseded = true;
+
+  // remove stale entries
+  while (curr_li.size_ > 0 &&
+         TIME_DISTANCE(curr_li.Get(0).access.clk_, curr_time) >= vw_) {
+    curr_li.PopFront();
   }
 
   // add entry
-  ObserverLocalInfo::EntryType new_entry;
-  new_entry.addr = addr;
-  new_entry.access = *curr_access;
-  curr_li.entries_[curr_time].push_back(new_entry);
+  ObserverLocalInfo::EntryType *new_entry = curr_li.Push();
+  new_entry->addr = addr;
+  new_entry->access = *curr_access;
 }
 
 void Observer::UpdateiRoots(ObserverAccess *curr_access,
@@ -530,21 +615,24 @@ void Observer::UpdateiRoots(ObserverAccess *curr_access,
 
 void Observer::UpdateComplexiRoots(ObserverAccess *curr_access,
                                    std::vector<ObserverAccess> *preds,
-                                   ObserverAccess *prev_access,
-                                   ObserverLocalInfo::SuccVec *succs,
+                                   ObserverLocalInfo::EntryType *prev_entry,
                                    bool same_addr) {
-  if (preds->empty() || succs->empty())
+  size_t num_succs = prev_entry->num_succs < max_succs_ ? prev_entry->num_succs
+                                                       : max_succs_;
+  if (preds->empty() || num_succs == 0)
     return;
 
+  ObserverAccess *prev_access = &prev_entry->access;
+
   if (same_addr) {
     // for idiom-2, idiom-3
     for (std::vector<ObserverAccess>::iterator pit = preds->begin();
          pit != preds->end(); ++pit) {
       ObserverAccess &pa = *pit;
       bool idiom2_exists = false;
-      for (ObserverLocalInfo::SuccVec::iterator sit = succs->begin();
-           sit != succs->end(); ++sit) {
-        ObserverAccess &sa = (*sit).succ;
+      for (size_t i = 0; i < num_succs; i++) {
+        ObserverLocalInfo::SuccEntry &se = prev_entry->succs[i];
+        ObserverAccess &sa = se.succ;
 
         if (sa.thd_id_ == pa.thd_id_ && sa.clk_ < pa.clk_) {
           iRootEvent *e0 = iroot_db_->GetiRootEvent(prev_access->inst_,
@@ -586,9 +674,9 @@ void Observer::UpdateComplexiRoots(ObserverAccess *curr_access,
     for (std::vector<ObserverAccess>::iterator pit = preds->begin();
          pit != preds->end(); ++pit) {
       ObserverAccess &pa = *pit;
-      for (ObserverLocalInfo::SuccVec::iterator sit = succs->begin();
-           sit != succs->end(); ++sit) {
-        ObserverAccess &sa = (*sit).succ;
+      for (size_t i = 0; i < num_succs; i++) {
+        ObserverLocalInfo::SuccEntry &se = prev_entry->succs[i];
+        ObserverAccess &sa = se.succ;
 
         if (sa.thd_id_ == pa.thd_id_) {
           if (sa.clk_ < pa.clk_) {
@@ -611,12 +699,11 @@ void Observer::UpdateComplexiRoots(ObserverAccess *curr_access,
               // need to check whether there exists access between sa
               // and pa that accesses the same location as sa or pa
               // check whether pa is in local_prev_vec
-              for (std::vector<ObserverAccess>::iterator it =
-                      (*sit).local_prev_vec.begin();
-                      it != (*sit).local_prev_vec.end(); ++it) {
-                if ((*it).clk_ == pa.clk_ &&
-                    (*it).type_ == pa.type_ &&
-                    (*it).inst_ == pa.inst_) {
+              for (size_t j = 0; j < se.num_local_prevs; j++) {
+                ObserverLocalInfo::LocalPrev &lp = se.local_prevs[j];
+                if (lp.clk == pa.clk_ &&
+                    lp.type == pa.type_ &&
+                    lp.inst == pa.inst_) {
                   iRootEvent *e0 = iroot_db_->GetiRootEvent(prev_access->inst_,
                                                             prev_access->type_,
                                                             false);
@@ -78,6 +78,7 @@ class ObserverAccess {
   Inst *inst_;
 
   friend class Observer;
+  friend class ObserverLocalInfo;
 
   // using default copy constructor and assignment operator
 };
@@ -126,33 +127,68 @@ class ObserverMutexMeta : public ObserverMeta {
   DISALLOW_COPY_CONSTRUCTORS(ObserverMutexMeta);
 };
 
-// Local information.
+// Local information. The recent accesses of a thread are kept in a circular
+// buffer ordered by thread clock. The buffer is allocated once and sized
+// from the vulnerability window, so that no memory is allocated or freed on
+// the per-access path. Each entry records at most max_succs successors
+// (the oldest ones are overwritten), and each successor records at most
+// max_local_prevs local predecessors (the most recent ones, used to verify
+// idiom-5 iroots). The drops are counted in the statistics.
 class ObserverLocalInfo {
  public:
-  ObserverLocalInfo() {}
+  ObserverLocalInfo()
+      : head_(0),
+        size_(0),
+        max_succs_(0),
+        max_local_prevs_(0) {}
   ~ObserverLocalInfo() {}
 
-  void Clear() { entries_.clear(); }
+  void Init(size_t capacity, size_t max_succs, size_t max_local_prevs);
+  void Clear() { head_ = 0; size_ = 0; }
+  bool Initialized() { return !entries_.empty(); }
 
  private:
+  typedef struct {
+    timestamp_t clk;
+    iRootEventType type;
+    Inst *inst;
+  } LocalPrev;
   typedef struct {
     ObserverAccess succ;
-    std::vector<ObserverAccess> local_prev_vec; // for idiom-5
+    size_t num_local_prevs;
+    LocalPrev *local_prevs; // for idiom-5 (points into local_prevs_)
   } SuccEntry;
-  typedef std::vector<SuccEntry> SuccVec;
   typedef struct {
     address_t addr;
     ObserverAccess access;
-    SuccVec succs;
+    bool superseded; // whether a later local access touches the same addr
+    size_t num_succs; // the total number of successors ever added
+    SuccEntry *succs; // points into succs_
   } EntryType;
   typedef std::vector<EntryType> EntryVec;
-  typedef std::map<timestamp_t, EntryVec> EntryMap;
 
-  EntryMap entries_;
+  // idx 0 is the oldest entry
+  EntryType &Get(size_t idx) {
+    return entries_[(head_ + idx) & (entries_.size() - 1)];
+  }
+  EntryType *Push();
+  void PopFront();
+  size_t LowerBound(timestamp_t clk);
+  size_t NumSuccs(EntryType *entry);
+  void AddSucc(EntryType *entry, SuccEntry *succ_entry);
+
+  EntryVec entries_; // the size is always a power of 2
+  std::vector<SuccEntry> succs_; // max_succs_ for each entry
+  std::vector<LocalPrev> local_prevs_; // max_local_prevs_ for each succ
+  size_t head_;
+  size_t size_;
+  size_t max_succs_;
+  size_t max_local_prevs_;
 
   friend class Observer;
 
-  // using default copy constructor and assignment operator
+  // using default copy constructor and assignment operator (only before
+  // Init, as the entries point into the vectors)
 };
 
 // iRoot observer which analyzes which iRoots are tested.
@@ -231,8 +267,7 @@ class Observer : public Analyzer {
                     std::vector<ObserverAccess> *preds);
   void UpdateComplexiRoots(ObserverAccess *curr_access,
                            std::vector<ObserverAccess> *preds,
-                           ObserverAccess *prev_access,
-                           ObserverLocalInfo::SuccVec *succs,
+                           ObserverLocalInfo::EntryType *prev_entry,
                            bool same_addr);
 
   Mutex *internal_lock_;
@@ -245,6 +280,9 @@ class Observer : public Analyzer {
   address_t unit_size_;
   bool complex_idioms_;
   timestamp_t vw_; // vulnerability window
+  size_t max_succs_; // the max number of succs of a local access
+  size_t max_local_prevs_; // the max number of local prevs of a succ
+  std::vector<ObserverLocalInfo::LocalPrev> local_prevs_buf_;
   RegionFilter *filter_;
   std::map<thread_id_t, ObserverLocalInfo> local_info_map_;
   MetaMap meta_map_;
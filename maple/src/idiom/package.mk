@@ -21,6 +21,8 @@ srcs += \
   idiom/pct_profiler.cpp \
   idiom/pct_profiler_main.cpp \
   idiom/predictor.cc \
+  idiom/predictor_loader.cc \
+  idiom/predictor_loader_main.cc \
   idiom/predictor_new.cc \
   idiom/profiler.cpp \
   idiom/profiler_main.cpp \
@@ -38,7 +40,8 @@ pintools += \
   idiom_scheduler.so
 
 cmdtools += \
-  idiom_memo_tool
+  idiom_memo_tool \
+  idiom_predictor_loader
 
 iroot_objs += \
   idiom/history.o \
@@ -129,3 +132,14 @@ idiom_memo_tool_objs := \
   idiom/memo_tool_main.o \
   $(core_cmd_objs)
 
+idiom_predictor_loader_objs := \
+  idiom/iroot.o \
+  idiom/iroot.pb.o \
+  idiom/memo.o \
+  idiom/memo.pb.o \
+  idiom/predictor.o \
+  idiom/predictor_loader.o \
+  idiom/predictor_loader_main.o \
+  $(tracer_cmd_objs) \
+  $(sinst_cmd_objs) \
+  $(core_cmd_objs)
@@ -193,6 +193,7 @@ void Predictor::ThreadExit(thread_id_t curr_thd_id, timestamp_t curr_thd_clk) {
   exit_vc_map_[curr_thd_id] = curr_vc_map_[curr_thd_id];
   curr_vc_map_.erase(curr_thd_id);
   curr_ls_map_.erase(curr_thd_id);
+  epoch_vc_map_.erase(curr_thd_id);
 }
 
 void Predictor::BeforeMemRead(thread_id_t curr_thd_id, timestamp_t curr_thd_clk,
@@ -796,8 +797,8 @@ void Predictor::UpdateForRead(thread_id_t curr_thd_id,
       // iterate each vector clock value
       for (PredictorMemMeta::PerThreadAccesses::reverse_iterator lit =
               accesses.rbegin(); lit != accesses.rend(); ++lit) {
-        VectorClock &vc = lit->first;
-        PredictorMemMeta::AccessVec &access_vec = lit->second;
+        VectorClock &vc = *lit->vc;
+        PredictorMemMeta::AccessVec &access_vec = lit->access_vec;
 
         if (vc.HappensAfter(curr_vc)) {
           // successive accesses
@@ -966,8 +967,8 @@ void Predictor::UpdateForWrite(thread_id_t curr_thd_id,
       // iterate each vector clock value
       for (PredictorMemMeta::PerThreadAccesses::reverse_iterator lit =
               accesses.rbegin(); lit != accesses.rend(); ++lit) {
-        VectorClock &vc = lit->first;
-        PredictorMemMeta::AccessVec &access_vec = lit->second;
+        VectorClock &vc = *lit->vc;
+        PredictorMemMeta::AccessVec &access_vec = lit->access_vec;
 
         if (vc.HappensAfter(curr_vc)) {
           // successive accesses
@@ -1154,8 +1155,8 @@ void Predictor::FindSuccForRead(thread_id_t curr_thd_id,
     // iterate all the accesses in this thread
     for (PredictorMemMeta::PerThreadAccesses::iterator lit =
             accesses.begin(); lit != accesses.end(); ++lit) {
-      VectorClock &vc = lit->first;
-      PredictorMemMeta::AccessVec &access_vec = lit->second;
+      VectorClock &vc = *lit->vc;
+      PredictorMemMeta::AccessVec &access_vec = lit->access_vec;
 
       if (vc.HappensBefore(curr_reader_vc)) {
         // precedent accesses
@@ -1292,8 +1293,8 @@ void Predictor::FindSuccForWrite(thread_id_t curr_thd_id,
     // iterate all the accesses in this thread
     for (PredictorMemMeta::PerThreadAccesses::iterator lit = accesses.begin();
          lit != accesses.end(); ++lit) {
-      VectorClock &vc = lit->first;
-      PredictorMemMeta::AccessVec &access_vec = lit->second;
+      VectorClock &vc = *lit->vc;
+      PredictorMemMeta::AccessVec &access_vec = lit->access_vec;
 
       if (vc.HappensBefore(curr_writer_vc)) {
         // precedent accesses
@@ -1399,36 +1400,32 @@ void Predictor::UpdateMemAccess(thread_id_t thd_id, VectorClock *vc,
 
   PredictorMemMeta::AccessMap &access_map = meta->history_->access_map;
   PredictorMemMeta::PerThreadAccesses &per_thd_accesses = access_map[thd_id];
-
-  if (per_thd_accesses.empty()) {
-    PredictorMemMeta::AccessVec access_vec;
-    access_vec.push_back(*access);
-    per_thd_accesses.push_back(
-        PredictorMemMeta::TimedAccessVec(*vc, access_vec));
-    meta->history_->last_gc_vec_size[thd_id] = 0;
+  PredictorMemMeta::SharedVC epoch_vc = GetEpochVC(thd_id, vc);
+
+  if (!per_thd_accesses.empty() && per_thd_accesses.back().vc == epoch_vc) {
+    // no need to create a new vector clock value
+    PredictorMemMeta::TimedAccessVec &last = per_thd_accesses.back();
+    last.access_vec.push_back(*access);
+    last.clk = access->clk_;
+    // selectively compress the last access_vec depending on gc status
+    CheckCompress(thd_id, &last.access_vec, meta);
   } else {
-    // obtain the last vector clock and the associated access vector
-    VectorClock &last_vc = per_thd_accesses.back().first;
-    PredictorMemMeta::AccessVec &last_access_vec
-        = per_thd_accesses.back().second;
-    if (last_vc.Equal(vc)) {
-      // no need to create a new vector clock value
-      last_access_vec.push_back(*access);
-      // selectively compress the last_access_vec depending on gc status
-      CheckCompress(thd_id, &last_access_vec, meta);
-    } else {
-      DEBUG_ASSERT(last_vc.HappensBefore(vc));
-      // compress last_access_vec
-      Compress(&last_access_vec, meta);
-      // create a new access_vec
-      PredictorMemMeta::AccessVec access_vec;
-      access_vec.push_back(*access);
-      per_thd_accesses.push_back(
-          PredictorMemMeta::TimedAccessVec(*vc, access_vec));
-      meta->history_->last_gc_vec_size[thd_id] = 0;
-      CheckGC(meta);
+    if (!per_thd_accesses.empty()) {
+      DEBUG_ASSERT(per_thd_accesses.back().vc->HappensBefore(vc));
+      // compress the last access_vec
+      Compress(&per_thd_accesses.back().access_vec, meta);
     }
+    // create a new epoch
+    per_thd_accesses.push_back(PredictorMemMeta::TimedAccessVec());
+    PredictorMemMeta::TimedAccessVec &last = per_thd_accesses.back();
+    last.vc = epoch_vc;
+    last.clk = access->clk_;
+    last.summary = false;
+    last.access_vec.push_back(*access);
+    meta->history_->last_gc_vec_size[thd_id] = 0;
   }
+
+  Evict(access->clk_, &per_thd_accesses);
 }
 
 VectorClock *Predictor::FindLastVC(thread_id_t thd_id, PredictorMemMeta *meta) {
@@ -1439,7 +1436,7 @@ VectorClock *Predictor::FindLastVC(thread_id_t thd_id, PredictorMemMeta *meta) {
   if (accesses.empty()) {
     return NULL;
   } else {
-    return &accesses.back().first;
+    return accesses.back().vc.get();
   }
 }
 
@@ -1452,17 +1449,18 @@ PredictorMemAccess *Predictor::FindLastAccess(thread_id_t thd_id,
   if (accesses.empty()) {
     return NULL;
   } else {
-    DEBUG_ASSERT(!accesses.back().second.empty());
-    return &accesses.back().second.back();
+    DEBUG_ASSERT(!accesses.back().access_vec.empty());
+    return &accesses.back().access_vec.back();
   }
 }
 
-bool Predictor::CheckGC(PredictorMemMeta *meta) {
-  DEBUG_ASSERT(meta->history_);
-
-  GC(meta);
-
-  return true;
+PredictorMemMeta::SharedVC Predictor::GetEpochVC(thread_id_t thd_id,
+                                                 VectorClock *vc) {
+  // a thread enters a new epoch whenever its vector clock changes
+  PredictorMemMeta::SharedVC &epoch_vc = epoch_vc_map_[thd_id];
+  if (!epoch_vc || !epoch_vc->Equal(vc))
+    epoch_vc.reset(new VectorClock(*vc));
+  return epoch_vc;
 }
 
 bool Predictor::CheckCompress(thread_id_t thd_id,
@@ -1484,76 +1482,39 @@ bool Predictor::CheckCompress(thread_id_t thd_id,
   return true;
 }
 
-void Predictor::GC(PredictorMemMeta *meta) {
-  // only do GC for shared meta
-  if (!meta->history_)
-    return;
-
-  PredictorMemMeta::AccessMap &access_map = meta->history_->access_map;
-
-  std::map<thread_id_t, VectorClock *> last_access_vc_table;
-  for (PredictorMemMeta::AccessMap::iterator mit = access_map.begin();
-       mit != access_map.end(); ++mit) {
-    thread_id_t thd_id = mit->first;
-
-    VectorClock *last_vc = FindLastVC(thd_id, meta);
-    if (last_vc) {
-      last_access_vc_table[thd_id] = last_vc;
-    }
-  }
-
-  // iterate each thread access history
-  for (PredictorMemMeta::AccessMap::iterator mit = access_map.begin();
-       mit != access_map.end(); ++mit) {
-    thread_id_t thd_id = mit->first;
-    PredictorMemMeta::PerThreadAccesses &accesses = mit->second;
-
-    // reverse iterate each vector clock value
-    PredictorMemMeta::PerThreadAccesses::iterator lit;
-    for (lit = accesses.end(); lit != accesses.begin(); ) {
-      --lit;
-
-      VectorClock &vc = lit->first;
-
-      // check whether vc is earlier than all curr_vc && last_access_vc
-      // if yes, clear the remaining access vectors
-      bool collect = true;
-      for (std::map<thread_id_t, VectorClock *>::iterator vcit =
-              curr_vc_map_.begin(); vcit != curr_vc_map_.end(); ++vcit) {
-        // skip the same thread
-        if (vcit->first == thd_id)
-          continue;
-
-        if (!vc.HappensBefore(vcit->second)) {
-          collect = false;
-          break;
-        }
-
-        std::map<thread_id_t, VectorClock *>::iterator luit =
-            last_access_vc_table.find(vcit->first);
-        if (luit != last_access_vc_table.end()) {
-          if (!vc.HappensBefore(luit->second)) {
-            collect = false;
-            break;
-          }
-        }
-      }
+void Predictor::Evict(timestamp_t curr_clk,
+                      PredictorMemMeta::PerThreadAccesses *accesses) {
+  // Drop the epochs whose last access is out of the vulnerability window of
+  // the thread's latest access. The latest epoch is always kept. The last
+  // write among the dropped epochs is kept as well, in a summary epoch at
+  // the front, because it is still the precedent of later remote accesses.
+  while (true) {
+    size_t idx = accesses->front().summary ? 1 : 0;
+    if (idx + 1 >= accesses->size())
+      break;
+    PredictorMemMeta::TimedAccessVec &epoch = (*accesses)[idx];
+    if (TIME_DISTANCE(epoch.clk, curr_clk) < vw_)
+      break;
 
-      if (collect) {
+    PredictorMemMeta::AccessVec::reverse_iterator wit;
+    for (wit = epoch.access_vec.rbegin(); wit != epoch.access_vec.rend();
+         ++wit) {
+      if (wit->IsWrite())
         break;
-      }
     }
 
-    // delete [begin(), lit)
-    for (PredictorMemMeta::PerThreadAccesses::iterator it = lit;
-         it != accesses.begin(); ) {
-      --it;
-      //DEBUG_FMT_PRINT_SAFE("<GC> %lu mem accesses in T%lx are collected\n",
-      //                     (*it).second.size(), thd_id);
+    if (wit != epoch.access_vec.rend()) {
+      // the epoch has a newer write than the summary, fold it
+      PredictorMemAccess last_write = *wit;
+      epoch.access_vec.clear();
+      epoch.access_vec.push_back(last_write);
+      epoch.summary = true;
+      if (idx)
+        accesses->pop_front();
+    } else {
+      accesses->erase(accesses->begin() + idx);
     }
-
-    accesses.erase(accesses.begin(), lit);
-  } // end for each thread
+  }
 }
 
 void Predictor::Compress(PredictorMemMeta::AccessVec *access_vec,
@@ -20,8 +20,10 @@
 #define IDIOM_PREDICTOR_H_
 
 #include <list>
+#include <deque>
 #include <vector>
 #include <map>
+#include <tr1/memory>
 #include <tr1/unordered_map>
 #include <tr1/unordered_set>
 
@@ -133,9 +135,20 @@ class PredictorMemMeta : public PredictorMeta {
   ~PredictorMemMeta() {}
 
  private:
+  // Vector clocks are shared by all the accesses made by a thread in the
+  // same epoch, no matter which addresses they touch.
+  typedef std::tr1::shared_ptr<VectorClock> SharedVC;
   typedef std::vector<PredictorMemAccess> AccessVec;
-  typedef std::pair<VectorClock, AccessVec> TimedAccessVec;
-  typedef std::list<TimedAccessVec> PerThreadAccesses;
+  typedef struct {
+    SharedVC vc;
+    timestamp_t clk; // thread clock of the last access in this epoch
+    bool summary; // only holds the last write of the evicted epochs
+    AccessVec access_vec;
+  } TimedAccessVec;
+  // Epochs are ordered by thread clock. Epochs that fall out of the
+  // vulnerability window are evicted from the front, except for the last
+  // write to the address (see Predictor::Evict).
+  typedef std::deque<TimedAccessVec> PerThreadAccesses;
   typedef std::map<thread_id_t, PerThreadAccesses> AccessMap;
   typedef struct {
     AccessMap access_map;
@@ -474,11 +487,12 @@ class Predictor : public Analyzer {
                        PredictorMemAccess *access, PredictorMemMeta *meta);
   VectorClock *FindLastVC(thread_id_t thd_id, PredictorMemMeta *meta);
   PredictorMemAccess *FindLastAccess(thread_id_t thd_id,PredictorMemMeta *meta);
-  bool CheckGC(PredictorMemMeta *meta);
+  PredictorMemMeta::SharedVC GetEpochVC(thread_id_t thd_id, VectorClock *vc);
   bool CheckCompress(thread_id_t thd_id,
                      PredictorMemMeta::AccessVec *access_vec,
                      PredictorMemMeta *meta);
-  void GC(PredictorMemMeta *meta);
+  void Evict(timestamp_t curr_clk,
+             PredictorMemMeta::PerThreadAccesses *accesses);
   void Compress(PredictorMemMeta::AccessVec *access_vec,
                 PredictorMemMeta *meta);
 
@@ -535,6 +549,7 @@ class Predictor : public Analyzer {
   std::map<thread_id_t, VectorClock *> curr_vc_map_;
   std::map<thread_id_t, LockSet *> curr_ls_map_;
   std::map<thread_id_t, VectorClock *> exit_vc_map_;
+  std::map<thread_id_t, PredictorMemMeta::SharedVC> epoch_vc_map_;
   std::map<thread_id_t, bool> monitored_thd_map_;
   std::map<thread_id_t, bool> async_map_;
   std::map<thread_id_t, timestamp_t> async_start_time_map_;
@@ -0,0 +1,120 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: idiom/predictor_loader.cc - Implement the trace loader that
+// predicts iroots from a recorded trace.
+
+#include "idiom/predictor_loader.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace idiom {
+
+PredictorLoader::PredictorLoader()
+    : iroot_db_(NULL),
+      memo_(NULL),
+      sinst_db_(NULL),
+      predictor_(NULL) {
+  // empty
+}
+
+void PredictorLoader::HandlePreSetup() {
+  tracer::Loader::HandlePreSetup();
+
+  knob_->RegisterBool("memo_failed", "whether memoize fail-to-expose iroots", "1");
+  knob_->RegisterStr("iroot_in", "the input iroot database path", "iroot.db");
+  knob_->RegisterStr("iroot_out", "the output iroot database path", "iroot.db");
+  knob_->RegisterStr("memo_in", "the input memoization database path", "memo.db");
+  knob_->RegisterStr("memo_out", "the output memoization database path", "memo.db");
+  knob_->RegisterStr("sinst_in", "the input shared inst database path", "sinst.db");
+
+  predictor_ = new Predictor;
+  predictor_->Register();
+}
+
+void PredictorLoader::HandlePostSetup() {
+  tracer::Loader::HandlePostSetup();
+
+  iroot_db_ = new iRootDB(CreateMutex());
+  iroot_db_->Load(knob_->ValueStr("iroot_in"), sinfo_);
+  memo_ = new Memo(CreateMutex(), iroot_db_);
+  memo_->Load(knob_->ValueStr("memo_in"), sinfo_);
+  sinst_db_ = new sinst::SharedInstDB(CreateMutex());
+  sinst_db_->Load(knob_->ValueStr("sinst_in"), sinfo_);
+
+  if (!predictor_->Enabled())
+    return;
+
+  if (knob_->ValueInt("num_shards") <= 1) {
+    predictor_->Setup(CreateMutex(), sinfo_, iroot_db_, memo_, sinst_db_);
+    AddAnalyzer(predictor_);
+    return;
+  }
+
+  // complex idioms relate accesses to different addresses, which may
+  // belong to different shards
+  if (knob_->ValueBool("complex_idioms")) {
+    printf("Complex idioms can not be predicted in shards\n");
+    exit(1);
+  }
+  // a monitoring unit should not be split between shards
+  int unit_size = knob_->ValueInt("unit_size");
+  if (knob_->ValueInt("shard_unit") % unit_size) {
+    printf("The shard unit should be a multiple of the unit size\n");
+    exit(1);
+  }
+}
+
+void PredictorLoader::HandleExit() {
+  tracer::Loader::HandleExit();
+
+  memo_->RefineCandidate(knob_->ValueBool("memo_failed"));
+  iroot_db_->Save(knob_->ValueStr("iroot_out"), sinfo_);
+  memo_->Save(knob_->ValueStr("memo_out"), sinfo_);
+}
+
+void PredictorLoader::HandleShardSetup(int shard_id,
+                                       AnalyzerContainer *analyzers) {
+  if (!predictor_->Enabled())
+    return;
+
+  ShardPredictor shard_predictor;
+  shard_predictor.iroot_db = new iRootDB(CreateMutex());
+  shard_predictor.memo = new Memo(CreateMutex(), shard_predictor.iroot_db);
+  shard_predictor.predictor = new Predictor;
+  shard_predictor.predictor->Setup(CreateMutex(), sinfo_,
+                                   shard_predictor.iroot_db,
+                                   shard_predictor.memo, sinst_db_);
+  analyzers->push_back(shard_predictor.predictor);
+  DEBUG_ASSERT((int)shard_predictors_.size() == shard_id);
+  shard_predictors_.push_back(shard_predictor);
+}
+
+void PredictorLoader::HandleShardMerge(int shard_id,
+                                       AnalyzerContainer *analyzers) {
+  if (!predictor_->Enabled())
+    return;
+
+  ShardPredictor &shard_predictor = shard_predictors_[shard_id];
+  memo_->MergePredicted(shard_predictor.memo, false);
+  delete shard_predictor.predictor;
+  delete shard_predictor.memo;
+  delete shard_predictor.iroot_db;
+  analyzers->clear();
+}
+
+} // namespace idiom
@@ -0,0 +1,74 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: idiom/predictor_loader.h - Define the trace loader that predicts
+// iroots from a recorded trace.
+
+#ifndef IDIOM_PREDICTOR_LOADER_H_
+#define IDIOM_PREDICTOR_LOADER_H_
+
+#include <vector>
+
+#include "core/basictypes.h"
+#include "tracer/loader.h"
+#include "sinst/sinst.h"
+#include "idiom/iroot.h"
+#include "idiom/memo.h"
+#include "idiom/predictor.h"
+
+namespace idiom {
+
+// Run the iroot predictor on a recorded trace. When the trace is replayed
+// in multiple shards, each shard runs its own predictor on a private iroot
+// database and memoization database, and the predicted iroots are merged
+// into the output databases when the shard finishes. Only idiom-1 iroots
+// (and deadlocks) can be predicted in shards since both accesses of an
+// idiom-1 iroot are to the same address. The race detectors are not
+// supported here as they depend on the PIN execution control.
+class PredictorLoader : public tracer::Loader {
+ public:
+  PredictorLoader();
+  virtual ~PredictorLoader() {}
+
+ protected:
+  // the per shard predictor and its private databases
+  struct ShardPredictor {
+    iRootDB *iroot_db;
+    Memo *memo;
+    Predictor *predictor;
+  };
+
+  typedef std::vector<ShardPredictor> ShardPredictorVec;
+
+  virtual void HandlePreSetup();
+  virtual void HandlePostSetup();
+  virtual void HandleExit();
+  virtual void HandleShardSetup(int shard_id, AnalyzerContainer *analyzers);
+  virtual void HandleShardMerge(int shard_id, AnalyzerContainer *analyzers);
+
+  iRootDB *iroot_db_;
+  Memo *memo_;
+  sinst::SharedInstDB *sinst_db_;
+  Predictor *predictor_;
+  ShardPredictorVec shard_predictors_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(PredictorLoader);
+};
+
+} // namespace idiom
+
+#endif
@@ -0,0 +1,32 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: idiom/predictor_loader_main.cc - Tha main entrance of the trace
+// loader that predicts iroots.
+
+#include "idiom/predictor_loader.h"
+
+static idiom::PredictorLoader *loader = new idiom::PredictorLoader;
+
+int main(int argc, char *argv[]) {
+  loader->Initialize();
+  loader->PreSetup();
+  loader->Parse(argc, argv);
+  loader->PostSetup();
+  loader->Start();
+  loader->Exit();
+  return 0;
+}
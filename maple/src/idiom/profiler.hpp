@@ -52,6 +52,9 @@ class Profiler : public ExecutionControl {
   ObserverNew *observer_new_;
   Predictor *predictor_;
   PredictorNew *predictor_new_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
+  BoolKnobHandle ignore_ic_pthread_;
 
   DISALLOW_COPY_CONSTRUCTORS(Profiler);
 };
@@ -61,6 +61,10 @@ void RandSchedProfiler::HandlePreSetup() {
 void RandSchedProfiler::HandlePostSetup() {
   randsched::Scheduler::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("ignore_lib", &ignore_lib_);
+  knob_->Bind("ignore_ic_pthread", &ignore_ic_pthread_);
+
   // load iroot db
   iroot_db_ = new iRootDB(CreateMutex());
   iroot_db_->Load(knob_->ValueStr("iroot_in"), sinfo_);
@@ -111,7 +115,7 @@ void RandSchedProfiler::HandlePostSetup() {
 }
 
 bool RandSchedProfiler::HandleIgnoreInstCount(IMG img) {
-  if (knob_->ValueBool("ignore_ic_pthread")) {
+  if (ignore_ic_pthread_.Value()) {
     if (!IMG_Valid(img))
       return false;
     Image *image = sinfo_->FindImage(IMG_Name(img));
@@ -129,7 +133,7 @@ bool RandSchedProfiler::HandleIgnoreMemAccess(IMG img) {
   DEBUG_ASSERT(image);
   if (image->IsPthread())
     return true;
-  if (knob_->ValueBool("ignore_lib")) {
+  if (ignore_lib_.Value()) {
     if (image->IsCommonLib())
       return true;
   }
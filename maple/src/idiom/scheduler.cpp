@@ -23,6 +23,7 @@ namespace idiom {
 
 Scheduler::Scheduler()
     : memo_(NULL),
+      memo_journal_(NULL),
       sinst_db_(NULL),
       sinst_analyzer_(NULL),
       observer_(NULL),
@@ -38,9 +39,11 @@ void Scheduler::HandlePreSetup() {
   knob_->RegisterBool("memo_failed", "whether memoize fail-to-expose iroots", "1");
   knob_->RegisterStr("memo_in", "the input memoization database path", "memo.db");
   knob_->RegisterStr("memo_out", "the output memoization database path", "memo.db");
+  knob_->RegisterBool("memo_shared", "whether the memoization database is shared by concurrent runs", "0");
   knob_->RegisterStr("sinst_in", "the input shared inst database path", "sinst.db");
   knob_->RegisterStr("sinst_out", "the output shared inst database path", "sinst.db");
   knob_->RegisterInt("target_idiom", "the target idiom (0 means any idiom)", "0");
+  knob_->RegisterInt("batch_size", "the max number of disjoint iroots to test in one execution", "1");
 
   sinst_analyzer_ = new sinst::SharedInstAnalyzer;
   sinst_analyzer_->Register();
@@ -53,9 +56,20 @@ void Scheduler::HandlePreSetup() {
 void Scheduler::HandlePostSetup() {
   SchedulerCommon::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("ignore_lib", &ignore_lib_);
+  knob_->Bind("ignore_ic_pthread", &ignore_ic_pthread_);
+  knob_->Bind("memo_failed", &memo_failed_);
+  knob_->Bind("target_idiom", &target_idiom_);
+  knob_->Bind("batch_size", &batch_size_);
+  knob_->Bind("memo_out", &memo_out_);
+  knob_->Bind("sinst_out", &sinst_out_);
+
   // load memoization db
   memo_ = new Memo(CreateMutex(), iroot_db_);
   memo_->Load(knob_->ValueStr("memo_in"), sinfo_);
+  if (knob_->ValueBool("memo_shared"))
+    memo_journal_ = new MemoJournal(memo_out_.Value());
   // load shared inst db
   sinst_db_ = new sinst::SharedInstDB(CreateMutex());
   sinst_db_->Load(knob_->ValueStr("sinst_in"), sinfo_);
@@ -84,7 +98,7 @@ void Scheduler::HandlePostSetup() {
 }
 
 bool Scheduler::HandleIgnoreInstCount(IMG img) {
-  if (knob_->ValueBool("ignore_ic_pthread")) {
+  if (ignore_ic_pthread_.Value()) {
     if (!IMG_Valid(img))
       return false;
     Image *image = sinfo_->FindImage(IMG_Name(img));
@@ -102,7 +116,7 @@ bool Scheduler::HandleIgnoreMemAccess(IMG img) {
   DEBUG_ASSERT(image);
   if (image->IsPthread())
     return true;
-  if (knob_->ValueBool("ignore_lib")) {
+  if (ignore_lib_.Value()) {
     if (image->IsCommonLib())
       return true;
   }
@@ -113,62 +127,118 @@ void Scheduler::HandleProgramExit() {
   SchedulerCommon::HandleProgramExit();
 
   // save memoization
-  memo_->RefineCandidate(knob_->ValueBool("memo_failed"));
-  memo_->Save(knob_->ValueStr("memo_out"), sinfo_);
+  if (memo_journal_) {
+    SaveSharedMemo();
+  } else {
+    memo_->RefineCandidate(memo_failed_.Value());
+    memo_->Save(memo_out_.Value(), sinfo_);
+  }
   // save shared instruction db
-  sinst_db_->Save(knob_->ValueStr("sinst_out"), sinfo_);
+  sinst_db_->Save(sinst_out_.Value(), sinfo_);
 }
 
 void Scheduler::Choose() {
+  // the journal is locked until the chosen iroots are claimed
+  if (memo_journal_)
+    SyncSharedMemo();
+
   // set current iroot to test
-  int target_iroot_id = knob_->ValueInt("target_iroot");
-  int target_idiom_int = knob_->ValueInt("target_idiom");
+  iRoot *iroot = NULL;
+  int target_iroot_id = target_iroot_.Value();
+  int target_idiom_int = target_idiom_.Value();
   if (target_iroot_id) {
-    curr_iroot_ = memo_->ChooseForTest((iroot_id_t)target_iroot_id);
+    iroot = memo_->ChooseForTest((iroot_id_t)target_iroot_id);
   } else {
     if (target_idiom_int) {
-      curr_iroot_ = memo_->ChooseForTest((IdiomType)target_idiom_int);
+      iroot = memo_->ChooseForTest((IdiomType)target_idiom_int);
     } else {
-      curr_iroot_ = memo_->ChooseForTest();
+      iroot = memo_->ChooseForTest();
     }
   }
 
-  if (!curr_iroot_) {
+  if (!iroot) {
+    if (memo_journal_)
+      memo_journal_->Unlock();
     printf("No iRoot to test, exit...\n");
     exit(0);
   }
+
+  // test a batch of iroots with disjoint events if requested
+  int batch_size = batch_size_.Value();
+  if (target_iroot_id || batch_size <= 1) {
+    CreateSlot(iroot);
+  } else {
+    std::vector<iRoot *> batch;
+    memo_->ChooseBatchForTest(iroot, (IdiomType)target_idiom_int,
+                              (size_t)batch_size, &batch);
+    for (size_t i = 0; i < batch.size(); i++)
+      CreateSlot(batch[i]);
+  }
+
+  if (memo_journal_) {
+    for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it)
+      memo_journal_->Claim((*it)->iroot());
+    memo_journal_->Unlock();
+  }
 }
 
-void Scheduler::TestSuccess() {
-  SchedulerCommon::TestSuccess();
-  if (!knob_->ValueInt("target_iroot")) {
-    memo_->TestSuccess(curr_iroot_, true);
+void Scheduler::TestSuccess(iRoot *iroot) {
+  SchedulerCommon::TestSuccess(iroot);
+  if (!target_iroot_.Value()) {
+    memo_->TestSuccess(iroot, true);
   }
 }
 
-void Scheduler::TestFail() {
-  SchedulerCommon::TestFail();
-  if (!knob_->ValueInt("target_iroot")) {
-    memo_->TestFail(curr_iroot_, false);
+void Scheduler::TestFail(iRoot *iroot) {
+  SchedulerCommon::TestFail(iroot);
+  if (!target_iroot_.Value()) {
+    memo_->TestFail(iroot, false);
   }
 }
 
 bool Scheduler::UseDecreasingPriorities() {
-  if (knob_->ValueInt("target_iroot")) {
-    return history_->TotalTestRuns(curr_iroot_) % 2 == 0;
+  if (target_iroot_.Value()) {
+    return history_->TotalTestRuns(PrimaryiRoot()) % 2 == 0;
   } else {
-    return memo_->TotalTestRuns(curr_iroot_, true) % 2 == 0;
+    return memo_->TotalTestRuns(PrimaryiRoot(), true) % 2 == 0;
   }
 }
 
 bool Scheduler::YieldWithDelay() {
-  if (knob_->ValueBool("yield_with_delay")) {
-    if (memo_->Async(curr_iroot_, true)) {
+  if (yield_with_delay_.Value()) {
+    if (memo_->Async(CurriRoot(), true)) {
       return true;
     }
   }
   return false;
 }
 
+void Scheduler::SyncSharedMemo() {
+  // lock the journal, pick up the results of the concurrent runs, and
+  // exclude the iroots that are being tested by them
+  memo_journal_->Lock();
+  Memo *latest = new Memo(CreateMutex(), iroot_db_);
+  latest->Load(memo_out_.Value(), sinfo_);
+  memo_->Merge(latest);
+  memo_->RefineCandidate(memo_failed_.Value());
+  delete latest;
+  memo_journal_->Exclude(memo_, iroot_db_);
+}
+
+void Scheduler::SaveSharedMemo() {
+  // merge the results of this run into the latest shared memo db, and
+  // release the iroots tested in this run
+  memo_journal_->Lock();
+  Memo *latest = new Memo(CreateMutex(), iroot_db_);
+  latest->Load(memo_out_.Value(), sinfo_);
+  latest->Merge(memo_);
+  latest->RefineCandidate(memo_failed_.Value());
+  latest->Save(memo_out_.Value(), sinfo_);
+  delete latest;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it)
+    memo_journal_->Release((*it)->iroot());
+  memo_journal_->Unlock();
+}
+
 } // namespace idiom
 
@@ -43,16 +43,29 @@ class Scheduler : public SchedulerCommon {
 
   // functions to override
   void Choose();
-  void TestSuccess();
-  void TestFail();
+  void TestSuccess(iRoot *iroot);
+  void TestFail(iRoot *iroot);
   bool UseDecreasingPriorities();
   bool YieldWithDelay();
 
+  // shared memoization
+  void SyncSharedMemo();
+  void SaveSharedMemo();
+
   Memo *memo_;
+  MemoJournal *memo_journal_; // NULL if the memo db is not shared
   sinst::SharedInstDB *sinst_db_;
   sinst::SharedInstAnalyzer *sinst_analyzer_;
   Observer *observer_;
   ObserverNew *observer_new_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
+  BoolKnobHandle ignore_ic_pthread_;
+  BoolKnobHandle memo_failed_;
+  IntKnobHandle target_idiom_;
+  IntKnobHandle batch_size_;
+  StrKnobHandle memo_out_;
+  StrKnobHandle sinst_out_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(Scheduler);
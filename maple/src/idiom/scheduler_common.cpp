@@ -132,6 +132,23 @@ Idiom5SchedStatus::Idiom5SchedStatus() {
   window_[1] = 0;
 }
 
+SchedSlot::SchedSlot(iRoot *iroot)
+    : iroot_(iroot),
+      idiom1_sched_status_(NULL),
+      idiom2_sched_status_(NULL),
+      idiom3_sched_status_(NULL),
+      idiom4_sched_status_(NULL),
+      idiom5_sched_status_(NULL),
+      test_success_(false),
+      watching_(false),
+      giveup_time_delayed_total_(0) {
+  for (int i = 0; i < SCHED_SLOT_MAX_GIVEUPS; i++) {
+    giveup_last_state_[i] = 0; // IDIOMx_STATE_INVALID
+    giveup_last_thd_[i] = INVALID_THD_ID;
+    giveup_time_delayed_each_[i] = 0;
+  }
+}
+
 SchedulerCommon::SchedulerCommon()
     : iroot_db_(NULL),
       history_(NULL),
@@ -143,17 +160,12 @@ SchedulerCommon::SchedulerCommon()
       new_thread_priorities_cursor_(0),
       unit_size_(0),
       vw_(0),
-      curr_iroot_(NULL),
-      idiom1_sched_status_(NULL),
-      idiom2_sched_status_(NULL),
-      idiom3_sched_status_(NULL),
-      idiom4_sched_status_(NULL),
-      idiom5_sched_status_(NULL),
       sched_status_lock_(NULL),
       misc_lock_(NULL),
       start_schedule_(false),
-      test_success_(false) {
-  // empty
+      watching_(false) {
+  for (UINT32 i = 0; i < PIN_MAX_THREADS; i++)
+    tls_curr_slot_[i] = NULL;
 }
 
 void SchedulerCommon::HandlePreSetup() {
@@ -182,6 +194,18 @@ void SchedulerCommon::HandlePreSetup() {
 void SchedulerCommon::HandlePostSetup() {
   ExecutionControl::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("strict", &strict_);
+  knob_->Bind("ordered_new_thread_prio", &ordered_new_thread_prio_);
+  knob_->Bind("yield_with_delay", &yield_with_delay_);
+  knob_->Bind("yield_delay_unit", &yield_delay_unit_);
+  knob_->Bind("yield_delay_min_each", &yield_delay_min_each_);
+  knob_->Bind("yield_delay_max_total", &yield_delay_max_total_);
+  knob_->Bind("target_iroot", &target_iroot_);
+  knob_->Bind("cpu", &cpu_);
+  knob_->Bind("test_history", &test_history_);
+  knob_->Bind("iroot_out", &iroot_out_);
+
   // set analysis desc
   desc_.SetHookMainFunc();
   desc_.SetHookSyscall();
@@ -191,7 +215,7 @@ void SchedulerCommon::HandlePostSetup() {
   iroot_db_->Load(knob_->ValueStr("iroot_in"), sinfo_);
   // load test history
   history_ = new TestHistory;
-  history_->Load(knob_->ValueStr("test_history"));
+  history_->Load(test_history_.Value());
 
   // calculate priorities
   CalculatePriorities();
@@ -228,7 +252,7 @@ void SchedulerCommon::HandlePreInstrumentTrace(TRACE trace) {
   ExecutionControl::HandlePreInstrumentTrace(trace);
 
   // no need to instrument if no memory iroot event exists
-  if (curr_iroot_->HasMem()) {
+  if (HasMem()) {
     InstrumentMemiRootEvent(trace);
     InstrumentWatchInstCount(trace);
     InstrumentWatchMem(trace);
@@ -240,7 +264,7 @@ void SchedulerCommon::HandlePreInstrumentTrace(TRACE trace) {
 void SchedulerCommon::HandleImageLoad(IMG img, Image *image) {
   if (!desc_.HookPthreadFunc()) {
     // no need to wrap mutex functions if no sync iroot event exists
-    if (curr_iroot_->HasSync()) {
+    if (HasSync()) {
       ReplacePthreadMutexWrappers(img);
     }
   }
@@ -263,48 +287,30 @@ void SchedulerCommon::HandleSyscallEntry(THREADID tid, CONTEXT *ctxt,
 }
 
 void SchedulerCommon::HandleProgramStart() {
-  // set current iroot to test
+  // set the iroots to test
   Choose();
-  DEBUG_ASSERT(curr_iroot_);
-  history_->CreateEntry(curr_iroot_);
+  DEBUG_ASSERT(!slots_.empty());
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it)
+    history_->CreateEntry((*it)->iroot());
   history_->UpdateSeed(random_seed_);
-  history_->Save(knob_->ValueStr("test_history"));
-
-  // set sched status
-  switch (curr_iroot_->idiom()) {
-    case IDIOM_1:
-      idiom1_sched_status_ = new Idiom1SchedStatus;
-      break;
-    case IDIOM_2:
-      idiom2_sched_status_ = new Idiom2SchedStatus;
-      break;
-    case IDIOM_3:
-      idiom3_sched_status_ = new Idiom3SchedStatus;
-      break;
-    case IDIOM_4:
-      idiom4_sched_status_ = new Idiom4SchedStatus;
-      break;
-    case IDIOM_5:
-      idiom5_sched_status_ = new Idiom5SchedStatus;
-      break;
-    default:
-      Abort("invalid idiom\n");
-      break;
-  }
+  history_->Save(test_history_.Value());
 }
 
 void SchedulerCommon::HandleProgramExit() {
   ExecutionControl::HandleProgramExit();
 
-  if (!test_success_) {
-    TestFail();
-    history_->UpdateResult(false);
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    if (!slot->test_success_) {
+      TestFail(slot->iroot());
+      history_->UpdateResult(slot->iroot(), false);
+    }
   }
 
   // save test history
-  history_->Save(knob_->ValueStr("test_history"));
+  history_->Save(test_history_.Value());
   // save iroot db
-  iroot_db_->Save(knob_->ValueStr("iroot_out"), sinfo_);
+  iroot_db_->Save(iroot_out_.Value(), sinfo_);
 }
 
 void SchedulerCommon::HandleThreadStart() {
@@ -361,37 +367,101 @@ void SchedulerCommon::HandleThreadMain(THREADID tid, CONTEXT *ctxt) {
 }
 
 void SchedulerCommon::Choose() {
-  // this function should setup the curr_iroot_ field
-  int target_iroot_id = knob_->ValueInt("target_iroot");
-  curr_iroot_ = iroot_db_->FindiRoot((iroot_id_t)target_iroot_id, false);
-  if (!curr_iroot_) {
+  // this function should setup the slots_ field
+  int target_iroot_id = target_iroot_.Value();
+  iRoot *iroot = iroot_db_->FindiRoot((iroot_id_t)target_iroot_id, false);
+  if (!iroot) {
     Abort("target iroot invalid\n");
   }
+  CreateSlot(iroot);
 }
 
 bool SchedulerCommon::UseDecreasingPriorities() {
-  return history_->TotalTestRuns(curr_iroot_) % 2 == 0;
+  return history_->TotalTestRuns(PrimaryiRoot()) % 2 == 0;
 }
 
 bool SchedulerCommon::YieldWithDelay() {
-  if (knob_->ValueBool("yield_with_delay"))
+  if (yield_with_delay_.Value())
     return true;
   else
     return false;
 }
 
+void SchedulerCommon::CreateSlot(iRoot *iroot) {
+  SchedSlot *slot = new SchedSlot(iroot);
+
+  // set sched status
+  switch (iroot->idiom()) {
+    case IDIOM_1:
+      slot->idiom1_sched_status_ = new Idiom1SchedStatus;
+      break;
+    case IDIOM_2:
+      slot->idiom2_sched_status_ = new Idiom2SchedStatus;
+      break;
+    case IDIOM_3:
+      slot->idiom3_sched_status_ = new Idiom3SchedStatus;
+      break;
+    case IDIOM_4:
+      slot->idiom4_sched_status_ = new Idiom4SchedStatus;
+      break;
+    case IDIOM_5:
+      slot->idiom5_sched_status_ = new Idiom5SchedStatus;
+      break;
+    default:
+      Abort("invalid idiom\n");
+      break;
+  }
+  slots_.push_back(slot);
+}
+
+bool SchedulerCommon::HasMem() {
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    if ((*it)->iroot()->HasMem())
+      return true;
+  }
+  return false;
+}
+
+bool SchedulerCommon::HasSync() {
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    if ((*it)->iroot()->HasSync())
+      return true;
+  }
+  return false;
+}
+
+void SchedulerCommon::UpdateWatching() {
+  // called with the sched status lock held
+  bool watching = false;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    if ((*it)->watching_) {
+      watching = true;
+      break;
+    }
+  }
+  watching_ = watching;
+}
+
 void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace) {
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    int idx = size - 1 - i;
-    iRootEvent *e = curr_iroot_->GetEvent(idx);
-    if (e->IsMem())
-      InstrumentMemiRootEvent(trace, idx);
+  // most traces do not contain any memory iroot event
+  if (!ContainCandidates(trace))
+    return;
+
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      int idx = size - 1 - i;
+      iRootEvent *e = slot->iroot()->GetEvent(idx);
+      if (e->IsMem())
+        InstrumentMemiRootEvent(trace, slot, idx);
+    }
   }
 }
 
-void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
-  iRootEvent *e = curr_iroot_->GetEvent(idx);
+void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, SchedSlot *slot,
+                                              UINT32 idx) {
+  iRootEvent *e = slot->iroot()->GetEvent(idx);
 
   DEBUG_ASSERT(e->IsMem());
 
@@ -419,6 +489,7 @@ void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
         if (INS_IsMemoryRead(ins)) {
           INS_InsertCall(ins, IPOINT_BEFORE,
                          (AFUNPTR)__BeforeiRootMemRead,
+                         IARG_PTR, slot,
                          IARG_UINT32, idx,
                          IARG_MEMORYREAD_EA,
                          IARG_MEMORYREAD_SIZE,
@@ -428,6 +499,7 @@ void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
         if (INS_IsMemoryWrite(ins)) {
           INS_InsertCall(ins, IPOINT_BEFORE,
                          (AFUNPTR)__BeforeiRootMemWrite,
+                         IARG_PTR, slot,
                          IARG_UINT32, idx,
                          IARG_MEMORYWRITE_EA,
                          IARG_MEMORYWRITE_SIZE,
@@ -437,6 +509,7 @@ void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
         if (INS_HasMemoryRead2(ins)) {
           INS_InsertCall(ins, IPOINT_BEFORE,
                          (AFUNPTR)__BeforeiRootMemRead,
+                         IARG_PTR, slot,
                          IARG_UINT32, idx,
                          IARG_MEMORYREAD2_EA,
                          IARG_MEMORYREAD_SIZE,
@@ -446,6 +519,7 @@ void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
         if (INS_HasFallThrough(ins)) {
           INS_InsertCall(ins, IPOINT_AFTER,
                          (AFUNPTR)__AfteriRootMem,
+                         IARG_PTR, slot,
                          IARG_UINT32, idx,
                          IARG_END);
         }
@@ -453,6 +527,7 @@ void SchedulerCommon::InstrumentMemiRootEvent(TRACE trace, UINT32 idx) {
         if (INS_IsBranchOrCall(ins)) {
           INS_InsertCall(ins, IPOINT_TAKEN_BRANCH,
                          (AFUNPTR)__AfteriRootMem,
+                         IARG_PTR, slot,
                          IARG_UINT32, idx,
                          IARG_END);
         }
@@ -468,190 +543,115 @@ void SchedulerCommon::ReplacePthreadMutexWrappers(IMG img) {
 }
 
 void SchedulerCommon::CheckiRootBeforeMutexLock(Inst *inst, address_t addr) {
-  bool is_candidate = false;
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    int idx = size - 1 - i;
-    iRootEvent *e = curr_iroot_->GetEvent(idx);
-    if (e->type() == IROOT_EVENT_MUTEX_LOCK && e->inst() == inst) {
-      HandleBeforeiRootMutexLock(idx, addr);
-      is_candidate = true;
+  // an instruction is a candidate of at most one slot, for the other
+  // slots, it is watched
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    SetCurrSlot(slot);
+    bool is_candidate = false;
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      int idx = size - 1 - i;
+      iRootEvent *e = slot->iroot()->GetEvent(idx);
+      if (e->type() == IROOT_EVENT_MUTEX_LOCK && e->inst() == inst) {
+        HandleBeforeiRootMutexLock(idx, addr);
+        is_candidate = true;
+      }
     }
+    if (!is_candidate)
+      HandleWatchMutexLock(addr);
   }
-  if (!is_candidate)
-    HandleWatchMutexLock(addr);
 }
 
 void SchedulerCommon::CheckiRootAfterMutexLock(Inst *inst, address_t addr) {
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    int idx = size - 1 - i;
-    iRootEvent *e = curr_iroot_->GetEvent(idx);
-    if (e->type() == IROOT_EVENT_MUTEX_LOCK && e->inst() == inst) {
-      HandleAfteriRootMutexLock(idx, addr);
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    SetCurrSlot(slot);
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      int idx = size - 1 - i;
+      iRootEvent *e = slot->iroot()->GetEvent(idx);
+      if (e->type() == IROOT_EVENT_MUTEX_LOCK && e->inst() == inst) {
+        HandleAfteriRootMutexLock(idx, addr);
+      }
     }
   }
 }
 
 void SchedulerCommon::CheckiRootBeforeMutexUnlock(Inst *inst, address_t addr) {
-  bool is_candidate = false;
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    int idx = size - 1 - i;
-    iRootEvent *e = curr_iroot_->GetEvent(idx);
-    if (e->type() == IROOT_EVENT_MUTEX_UNLOCK && e->inst() == inst) {
-      HandleBeforeiRootMutexUnlock(idx, addr);
-      is_candidate = true;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    SetCurrSlot(slot);
+    bool is_candidate = false;
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      int idx = size - 1 - i;
+      iRootEvent *e = slot->iroot()->GetEvent(idx);
+      if (e->type() == IROOT_EVENT_MUTEX_UNLOCK && e->inst() == inst) {
+        HandleBeforeiRootMutexUnlock(idx, addr);
+        is_candidate = true;
+      }
     }
+    if (!is_candidate)
+      HandleWatchMutexUnlock(addr);
   }
-  if (!is_candidate)
-    HandleWatchMutexUnlock(addr);
 }
 
 void SchedulerCommon::CheckiRootAfterMutexUnlock(Inst *inst, address_t addr) {
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    int idx = size - 1 - i;
-    iRootEvent *e = curr_iroot_->GetEvent(idx);
-    if (e->type() == IROOT_EVENT_MUTEX_UNLOCK && e->inst() == inst) {
-      HandleAfteriRootMutexUnlock(idx, addr);
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    SetCurrSlot(slot);
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      int idx = size - 1 - i;
+      iRootEvent *e = slot->iroot()->GetEvent(idx);
+      if (e->type() == IROOT_EVENT_MUTEX_UNLOCK && e->inst() == inst) {
+        HandleAfteriRootMutexUnlock(idx, addr);
+      }
     }
   }
 }
 
 void SchedulerCommon::InstrumentWatchMem(TRACE trace) {
-  switch (curr_iroot_->idiom()) {
-      case IDIOM_1:
-        Idiom1InstrumentWatchMem(trace);
-        break;
-      case IDIOM_2:
-        Idiom2InstrumentWatchMem(trace);
-        break;
-      case IDIOM_3:
-        Idiom3InstrumentWatchMem(trace);
-        break;
-      case IDIOM_4:
-        Idiom4InstrumentWatchMem(trace);
-        break;
-      case IDIOM_5:
-        Idiom5InstrumentWatchMem(trace);
-        break;
-      default:
-        break;
-  }
+  // The watch callbacks are always instrumented, but are only called when
+  // the trace contains candidates or when the scheduler is in a watch state
+  // (see __Watching). Therefore, there is no need to re-instrument when the
+  // watch state changes.
+  __InstrumentWatchMem(trace, ContainCandidates(trace));
 }
 
 void SchedulerCommon::InstrumentWatchInstCount(TRACE trace) {
-  switch (curr_iroot_->idiom()) {
-      case IDIOM_1:
-        // no need to instrumet
-        break;
-      case IDIOM_2:
-        Idiom2InstrumentWatchInstCount(trace);
-        break;
-      case IDIOM_3:
-        Idiom3InstrumentWatchInstCount(trace);
-        break;
-      case IDIOM_4:
-        Idiom4InstrumentWatchInstCount(trace);
-        break;
-      case IDIOM_5:
-        Idiom5InstrumentWatchInstCount(trace);
-        break;
-      default:
-        break;
-  }
-}
-
-void SchedulerCommon::Idiom1InstrumentWatchMem(TRACE trace) {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
-
-  if (ContainCandidates(trace)) {
-    __InstrumentWatchMem(trace, true);
-    return;
-  }
-
-  switch (s->state_) {
-    case IDIOM1_STATE_E0_WATCH:
-      __InstrumentWatchMem(trace, false);
-      break;
-    default:
+  // no need to instrumet if all the iroots are idiom-1
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    if ((*it)->iroot()->idiom() != IDIOM_1) {
+      __InstrumentWatchInstCount(trace);
       break;
+    }
   }
 }
 
-void SchedulerCommon::Idiom1InstrumentWatchInstCount(TRACE trace) {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
-
-  switch (s->state_) {
+bool SchedulerCommon::Idiom1Watching(unsigned long state) {
+  switch (state) {
     case IDIOM1_STATE_E0_WATCH:
-      __InstrumentWatchInstCount(trace);
-      break;
+      return true;
     default:
-      break;
+      return false;
   }
 }
 
-void SchedulerCommon::Idiom2InstrumentWatchMem(TRACE trace) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
-
-  if (ContainCandidates(trace)) {
-    __InstrumentWatchMem(trace, true);
-    return;
-  }
-
-  switch (s->state_) {
+bool SchedulerCommon::Idiom2Watching(unsigned long state) {
+  switch (state) {
     case IDIOM2_STATE_E0_WATCH:
     case IDIOM2_STATE_E0_E1_WATCH:
     case IDIOM2_STATE_E1_WATCH:
-      __InstrumentWatchMem(trace, false);
-      break;
-    default:
-      break;
-  }
-}
-
-void SchedulerCommon::Idiom2InstrumentWatchInstCount(TRACE trace) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
-
-  switch (s->state_) {
-    case IDIOM2_STATE_E0_WATCH:
-    case IDIOM2_STATE_E0_E1_WATCH:
-    case IDIOM2_STATE_E1_WATCH:
-      __InstrumentWatchInstCount(trace);
-      break;
-    default:
-      break;
-  }
-}
-
-void SchedulerCommon::Idiom3InstrumentWatchMem(TRACE trace) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
-
-  if (ContainCandidates(trace)) {
-    __InstrumentWatchMem(trace, true);
-    return;
-  }
-
-  switch (s->state_) {
-    case IDIOM3_STATE_E0_WATCH:
-    case IDIOM3_STATE_E0_E1_WATCH:
-    case IDIOM3_STATE_E1_WATCH:
-    case IDIOM3_STATE_E0_WATCH_E3:
-    case IDIOM3_STATE_E1_WATCH_E3:
-    case IDIOM3_STATE_E1_WATCH_E2:
-    case IDIOM3_STATE_E1_WATCH_E2_WATCH:
-      __InstrumentWatchMem(trace, false);
-      break;
+      return true;
     default:
-      break;
+      return false;
   }
 }
 
-void SchedulerCommon::Idiom3InstrumentWatchInstCount(TRACE trace) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
-
-  switch (s->state_) {
+bool SchedulerCommon::Idiom3Watching(unsigned long state) {
+  switch (state) {
     case IDIOM3_STATE_E0_WATCH:
     case IDIOM3_STATE_E0_E1_WATCH:
     case IDIOM3_STATE_E1_WATCH:
@@ -659,40 +659,14 @@ void SchedulerCommon::Idiom3InstrumentWatchInstCount(TRACE trace) {
     case IDIOM3_STATE_E1_WATCH_E3:
     case IDIOM3_STATE_E1_WATCH_E2:
     case IDIOM3_STATE_E1_WATCH_E2_WATCH:
-      __InstrumentWatchInstCount(trace);
-      break;
-    default:
-      break;
-  }
-}
-
-void SchedulerCommon::Idiom4InstrumentWatchMem(TRACE trace) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
-
-  if (ContainCandidates(trace)) {
-    __InstrumentWatchMem(trace, true);
-    return;
-  }
-
-  switch (s->state_) {
-    case IDIOM4_STATE_E0_WATCH:
-    case IDIOM4_STATE_E0_E1_WATCH:
-    case IDIOM4_STATE_E1_WATCH:
-    case IDIOM4_STATE_E0_WATCH_E3:
-    case IDIOM4_STATE_E1_WATCH_E3:
-    case IDIOM4_STATE_E1_WATCH_E2:
-    case IDIOM4_STATE_E1_WATCH_E2_WATCH:
-      __InstrumentWatchMem(trace, false);
-      break;
+      return true;
     default:
-      break;
+      return false;
   }
 }
 
-void SchedulerCommon::Idiom4InstrumentWatchInstCount(TRACE trace) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
-
-  switch (s->state_) {
+bool SchedulerCommon::Idiom4Watching(unsigned long state) {
+  switch (state) {
     case IDIOM4_STATE_E0_WATCH:
     case IDIOM4_STATE_E0_E1_WATCH:
     case IDIOM4_STATE_E1_WATCH:
@@ -700,42 +674,14 @@ void SchedulerCommon::Idiom4InstrumentWatchInstCount(TRACE trace) {
     case IDIOM4_STATE_E1_WATCH_E3:
     case IDIOM4_STATE_E1_WATCH_E2:
     case IDIOM4_STATE_E1_WATCH_E2_WATCH:
-      __InstrumentWatchInstCount(trace);
-      break;
-    default:
-      break;
-  }
-}
-
-void SchedulerCommon::Idiom5InstrumentWatchMem(TRACE trace) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
-
-  if (ContainCandidates(trace)) {
-    __InstrumentWatchMem(trace, true);
-    return;
-  }
-
-  switch (s->state_) {
-    case IDIOM5_STATE_E0_WATCH:
-    case IDIOM5_STATE_E2_WATCH:
-    case IDIOM5_STATE_E0_E2_WATCH:
-    case IDIOM5_STATE_E0_WATCH_E3:
-    case IDIOM5_STATE_E2_WATCH_E1:
-    case IDIOM5_STATE_E0_E2_WATCH_E3:
-    case IDIOM5_STATE_E0_E2_WATCH_E1:
-    case IDIOM5_STATE_E0_E2_WATCH_E3_WATCH:
-    case IDIOM5_STATE_E0_E2_WATCH_E1_WATCH:
-      __InstrumentWatchMem(trace, false);
-      break;
+      return true;
     default:
-      break;
+      return false;
   }
 }
 
-void SchedulerCommon::Idiom5InstrumentWatchInstCount(TRACE trace) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
-
-  switch (s->state_) {
+bool SchedulerCommon::Idiom5Watching(unsigned long state) {
+  switch (state) {
     case IDIOM5_STATE_E0_WATCH:
     case IDIOM5_STATE_E2_WATCH:
     case IDIOM5_STATE_E0_E2_WATCH:
@@ -745,19 +691,22 @@ void SchedulerCommon::Idiom5InstrumentWatchInstCount(TRACE trace) {
     case IDIOM5_STATE_E0_E2_WATCH_E1:
     case IDIOM5_STATE_E0_E2_WATCH_E3_WATCH:
     case IDIOM5_STATE_E0_E2_WATCH_E1_WATCH:
-      __InstrumentWatchInstCount(trace);
-      break;
+      return true;
     default:
-      break;
+      return false;
   }
 }
 
 void SchedulerCommon::__InstrumentWatchInstCount(TRACE trace) {
   for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
-    BBL_InsertCall(bbl, IPOINT_BEFORE,
-                   (AFUNPTR)__WatchInstCount,
-                   IARG_UINT32, BBL_NumIns(bbl),
-                   IARG_END);
+    BBL_InsertIfCall(bbl, IPOINT_BEFORE,
+                     (AFUNPTR)__Watching,
+                     IARG_BOOL, false,
+                     IARG_END);
+    BBL_InsertThenCall(bbl, IPOINT_BEFORE,
+                       (AFUNPTR)__WatchInstCount,
+                       IARG_UINT32, BBL_NumIns(bbl),
+                       IARG_END);
   }
 }
 
@@ -773,122 +722,138 @@ void SchedulerCommon::__InstrumentWatchMem(TRACE trace, bool cand) {
       if (INS_IsStackRead(ins) || INS_IsStackWrite(ins))
         continue;
 
-      if (IsCandidate(trace, ins))
+      // a candidate is only watched by the other slots
+      SchedSlot *owner = FindCandidateOwner(trace, ins);
+      if (owner && slots_.size() == 1)
         continue;
 
       if (INS_IsMemoryRead(ins)) {
         Inst *inst = FindInst(INS_Address(ins));
-        INS_InsertCall(ins, IPOINT_BEFORE,
-                       (AFUNPTR)__WatchMemRead,
-                       IARG_PTR, inst,
-                       IARG_MEMORYREAD_EA,
-                       IARG_MEMORYREAD_SIZE,
-                       IARG_BOOL, cand,
-                       IARG_END);
+        INS_InsertIfCall(ins, IPOINT_BEFORE,
+                         (AFUNPTR)__Watching,
+                         IARG_BOOL, cand,
+                         IARG_END);
+        INS_InsertThenCall(ins, IPOINT_BEFORE,
+                           (AFUNPTR)__WatchMemRead,
+                           IARG_PTR, owner,
+                           IARG_PTR, inst,
+                           IARG_MEMORYREAD_EA,
+                           IARG_MEMORYREAD_SIZE,
+                           IARG_BOOL, cand,
+                           IARG_END);
       }
 
       if (INS_IsMemoryWrite(ins)) {
         Inst *inst = FindInst(INS_Address(ins));
-        INS_InsertCall(ins, IPOINT_BEFORE,
-                       (AFUNPTR)__WatchMemWrite,
-                       IARG_PTR, inst,
-                       IARG_MEMORYWRITE_EA,
-                       IARG_MEMORYWRITE_SIZE,
-                       IARG_BOOL, cand,
-                       IARG_END);
+        INS_InsertIfCall(ins, IPOINT_BEFORE,
+                         (AFUNPTR)__Watching,
+                         IARG_BOOL, cand,
+                         IARG_END);
+        INS_InsertThenCall(ins, IPOINT_BEFORE,
+                           (AFUNPTR)__WatchMemWrite,
+                           IARG_PTR, owner,
+                           IARG_PTR, inst,
+                           IARG_MEMORYWRITE_EA,
+                           IARG_MEMORYWRITE_SIZE,
+                           IARG_BOOL, cand,
+                           IARG_END);
       }
 
       if (INS_HasMemoryRead2(ins)) {
         Inst *inst = FindInst(INS_Address(ins));
-        INS_InsertCall(ins, IPOINT_BEFORE,
-                       (AFUNPTR)__WatchMemRead,
-                       IARG_PTR, inst,
-                       IARG_MEMORYREAD2_EA,
-                       IARG_MEMORYREAD_SIZE,
-                       IARG_BOOL, cand,
-                       IARG_END);
+        INS_InsertIfCall(ins, IPOINT_BEFORE,
+                         (AFUNPTR)__Watching,
+                         IARG_BOOL, cand,
+                         IARG_END);
+        INS_InsertThenCall(ins, IPOINT_BEFORE,
+                           (AFUNPTR)__WatchMemRead,
+                           IARG_PTR, owner,
+                           IARG_PTR, inst,
+                           IARG_MEMORYREAD2_EA,
+                           IARG_MEMORYREAD_SIZE,
+                           IARG_BOOL, cand,
+                           IARG_END);
       }
     } // end of for ins
   } // end of for bbl
 }
 
 bool SchedulerCommon::ContainCandidates(TRACE trace) {
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    iRootEvent *e = curr_iroot_->GetEvent(i);
-    if (e->IsMem()) {
-      Inst *inst = e->inst();
-      DEBUG_ASSERT(inst);
-      Image *image = inst->image();
-      DEBUG_ASSERT(image);
-      IMG img = GetImgByTrace(trace);
+  CandidateIndex *index = GetCandidateIndex(GetImgByTrace(trace));
+  if (index->mem_offset_set.empty())
+    return false;
 
-      // no need to proceed if image does not match
-      if (IMG_Valid(img)) {
-        if (image->name().compare(IMG_Name(img)) != 0)
-          continue;
-      } else {
-        if (image->name().compare(PSEUDO_IMAGE_NAME) != 0)
-          continue;
-      }
+  // no need to check each instruction if the ranges do not overlap
+  ADDRINT trace_start = TRACE_Address(trace);
+  ADDRINT trace_end = trace_start + TRACE_Size(trace);
+  if (trace_end <= index->mem_start || trace_start >= index->mem_end)
+    return false;
 
-      ADDRINT img_low_addr = IMG_Valid(img) ? IMG_LowAddress(img) : 0;
-      for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
-        for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
-          ADDRINT offset = INS_Address(ins) - img_low_addr;
-          if (offset == inst->offset()) {
-            return true;
-          }
-        }
-      }
+  for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
+    for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
+      ADDRINT offset = INS_Address(ins) - index->low_addr;
+      if (index->mem_offset_set.find(offset) != index->mem_offset_set.end())
+        return true;
     }
   }
-
   return false;
 }
 
-bool SchedulerCommon::IsCandidate(TRACE trace, INS ins) {
-  int size = iRoot::GetNumEvents(curr_iroot_->idiom());
-  for (int i = 0; i < size; i++) {
-    iRootEvent *e = curr_iroot_->GetEvent(i);
-    Inst *inst = e->inst();
-    DEBUG_ASSERT(inst);
-    Image *image = inst->image();
-    DEBUG_ASSERT(image);
-    IMG img = GetImgByTrace(trace);
-
-    // no need to proceed if image does not match
-    if (IMG_Valid(img)) {
-      if (image->name().compare(IMG_Name(img)) != 0)
-        continue;
-    } else {
-      if (image->name().compare(PSEUDO_IMAGE_NAME) != 0)
+SchedSlot *SchedulerCommon::FindCandidateOwner(TRACE trace, INS ins) {
+  CandidateIndex *index = GetCandidateIndex(GetImgByTrace(trace));
+  ADDRINT offset = INS_Address(ins) - index->low_addr;
+  OffsetMap::iterator it = index->offset_map.find(offset);
+  if (it == index->offset_map.end())
+    return NULL;
+  return it->second;
+}
+
+SchedulerCommon::CandidateIndex *SchedulerCommon::GetCandidateIndex(IMG img) {
+  UINT32 img_id = IMG_Valid(img) ? IMG_Id(img) : 0;
+  CandidateIndexMap::iterator it = cand_index_map_.find(img_id);
+  if (it != cand_index_map_.end())
+    return it->second;
+
+  // build the index for this image
+  CandidateIndex *index = new CandidateIndex;
+  index->low_addr = IMG_Valid(img) ? IMG_LowAddress(img) : 0;
+  index->mem_start = 0;
+  index->mem_end = 0;
+  std::string img_name = IMG_Valid(img) ? IMG_Name(img) : PSEUDO_IMAGE_NAME;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    int size = iRoot::GetNumEvents(slot->iroot()->idiom());
+    for (int i = 0; i < size; i++) {
+      iRootEvent *e = slot->iroot()->GetEvent(i);
+      Inst *inst = e->inst();
+      DEBUG_ASSERT(inst);
+      Image *image = inst->image();
+      DEBUG_ASSERT(image);
+      if (image->name().compare(img_name) != 0)
         continue;
-    }
 
-    ADDRINT img_low_addr = IMG_Valid(img) ? IMG_LowAddress(img) : 0;
-    ADDRINT offset = INS_Address(ins) - img_low_addr;
-    if (offset == inst->offset())
-      return true;
-  }
-  return false;
-}
-
-void SchedulerCommon::FlushWatch() {
-  DEBUG_ASSERT(curr_iroot_);
-  if (curr_iroot_->HasMem()) {
-    DEBUG_FMT_PRINT_SAFE("flush code cache\n");
-    CODECACHE_FlushCache();
-    //PIN_RemoveInstrumentation();
+      index->offset_map[inst->offset()] = slot;
+      if (e->IsMem()) {
+        ADDRINT addr = index->low_addr + inst->offset();
+        if (index->mem_offset_set.empty() || addr < index->mem_start)
+          index->mem_start = addr;
+        if (index->mem_offset_set.empty() || addr + 1 > index->mem_end)
+          index->mem_end = addr + 1;
+        index->mem_offset_set.insert(inst->offset());
+      }
+    }
   }
+  cand_index_map_[img_id] = index;
+  return index;
 }
 
 void SchedulerCommon::ActivelyExposed() {
-  DEBUG_ASSERT(curr_iroot_);
-  if (!test_success_) {
-    TestSuccess();
-    history_->UpdateResult(true);
-    test_success_ = true;
+  SchedSlot *slot = CurrSlot();
+  DEBUG_ASSERT(slot);
+  if (!slot->test_success_) {
+    TestSuccess(slot->iroot());
+    history_->UpdateResult(slot->iroot(), true);
+    slot->test_success_ = true;
   }
 }
 
@@ -910,7 +875,7 @@ Inst *SchedulerCommon::FindInst(ADDRINT pc) {
 }
 
 void SchedulerCommon::CalculatePriorities() {
-  if (knob_->ValueBool("strict")) {
+  if (strict_.Value()) {
     int lowest = knob_->ValueInt("lowest_realtime_priority");
     int highest = knob_->ValueInt("highest_realtime_priority");
     min_priority_ = lowest;
@@ -947,7 +912,7 @@ int SchedulerCommon::MainThreadPriority() {
 
 int SchedulerCommon::NextNewThreadPriority() {
   int priority;
-  if (knob_->ValueBool("ordered_new_thread_prio")) {
+  if (ordered_new_thread_prio_.Value()) {
     if (UseDecreasingPriorities()) {
       // decreasing priorities
       int cursor = ATOMIC_FETCH_AND_SUB(&new_thread_priorities_cursor_, 1);
@@ -966,7 +931,7 @@ int SchedulerCommon::NextNewThreadPriority() {
 
 void SchedulerCommon::InitNewThreadPriority() {
   // set new thread priorities cursor
-  if (knob_->ValueBool("ordered_new_thread_prio")) {
+  if (ordered_new_thread_prio_.Value()) {
     if (UseDecreasingPriorities()) {
       // decreasing priorities
       DEBUG_FMT_PRINT_SAFE("decreasing priorities\n");
@@ -1007,7 +972,7 @@ void SchedulerCommon::SetPriority(int priority) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] Set self priority=%d\n",
                        PIN_ThreadUid(), priority);
 
-  if (knob_->ValueBool("strict")) {
+  if (strict_.Value()) {
     SetStrictPriority(priority);
   } else {
     SetRelaxPriority(priority);
@@ -1021,7 +986,7 @@ void SchedulerCommon::SetPriority(thread_id_t target, int priority) {
   priority_map_[target] = priority;
   UnlockMisc();
 
-  if (knob_->ValueBool("strict")) {
+  if (strict_.Value()) {
     SetStrictPriority(target, priority);
   } else {
     SetRelaxPriority(target, priority);
@@ -1104,7 +1069,7 @@ void SchedulerCommon::SetRelaxPriority(thread_id_t target, int priority) {
 }
 
 void SchedulerCommon::SetAffinity() {
-  int cpu = knob_->ValueInt("cpu");
+  int cpu = cpu_.Value();
   if (cpu < 0 || cpu >= sysconf(_SC_NPROCESSORS_ONLN))
     cpu = 0;
 
@@ -1124,7 +1089,7 @@ void SchedulerCommon::HandleBeforeiRootMemRead(UINT32 idx, address_t addr,
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1BeforeiRootMemRead(idx, addr, size);
       break;
@@ -1151,7 +1116,7 @@ void SchedulerCommon::HandleBeforeiRootMemWrite(UINT32 idx, address_t addr,
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1BeforeiRootMemWrite(idx, addr, size);
       break;
@@ -1177,7 +1142,7 @@ void SchedulerCommon::HandleAfteriRootMem(UINT32 idx) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1AfteriRootMem(idx);
       break;
@@ -1203,7 +1168,7 @@ void SchedulerCommon::HandleBeforeiRootMutexLock(UINT32 idx, address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1BeforeiRootMutexLock(idx, addr);
       break;
@@ -1229,7 +1194,7 @@ void SchedulerCommon::HandleAfteriRootMutexLock(UINT32 idx, address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1AfteriRootMutexLock(idx, addr);
       break;
@@ -1255,7 +1220,7 @@ void SchedulerCommon::HandleBeforeiRootMutexUnlock(UINT32 idx, address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1BeforeiRootMutexUnlock(idx, addr);
       break;
@@ -1281,7 +1246,7 @@ void SchedulerCommon::HandleAfteriRootMutexUnlock(UINT32 idx, address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1AfteriRootMutexUnlock(idx, addr);
       break;
@@ -1307,7 +1272,7 @@ void SchedulerCommon::HandleWatchMutexLock(address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1WatchMutexLock(addr);
       break;
@@ -1333,7 +1298,7 @@ void SchedulerCommon::HandleWatchMutexUnlock(address_t addr) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
+  switch (CurriRoot()->idiom()) {
     case IDIOM_1:
       Idiom1WatchMutexUnlock(addr);
       break;
@@ -1355,57 +1320,73 @@ void SchedulerCommon::HandleWatchMutexUnlock(address_t addr) {
   }
 }
 
-void SchedulerCommon::HandleWatchMemRead(Inst *inst, address_t addr, size_t size,
-                                   bool cand) {
+void SchedulerCommon::HandleWatchMemRead(SchedSlot *owner, Inst *inst,
+                                         address_t addr, size_t size,
+                                         bool cand) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
-    case IDIOM_1:
-      Idiom1WatchMemRead(inst, addr, size, cand);
-      break;
-    case IDIOM_2:
-      Idiom2WatchMemRead(inst, addr, size, cand);
-      break;
-    case IDIOM_3:
-      Idiom3WatchMemRead(inst, addr, size, cand);
-      break;
-    case IDIOM_4:
-      Idiom4WatchMemRead(inst, addr, size, cand);
-      break;
-    case IDIOM_5:
-      Idiom5WatchMemRead(inst, addr, size, cand);
-      break;
-    default:
-      Abort("invalid idiom\n");
-      break;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    if (slot == owner || !(cand || slot->watching_))
+      continue;
+
+    SetCurrSlot(slot);
+    switch (slot->iroot()->idiom()) {
+      case IDIOM_1:
+        Idiom1WatchMemRead(inst, addr, size, cand);
+        break;
+      case IDIOM_2:
+        Idiom2WatchMemRead(inst, addr, size, cand);
+        break;
+      case IDIOM_3:
+        Idiom3WatchMemRead(inst, addr, size, cand);
+        break;
+      case IDIOM_4:
+        Idiom4WatchMemRead(inst, addr, size, cand);
+        break;
+      case IDIOM_5:
+        Idiom5WatchMemRead(inst, addr, size, cand);
+        break;
+      default:
+        Abort("invalid idiom\n");
+        break;
+    }
   }
 }
 
-void SchedulerCommon::HandleWatchMemWrite(Inst *inst, address_t addr, size_t size,
-                                    bool cand) {
+void SchedulerCommon::HandleWatchMemWrite(SchedSlot *owner, Inst *inst,
+                                          address_t addr, size_t size,
+                                          bool cand) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
-    case IDIOM_1:
-      Idiom1WatchMemWrite(inst, addr, size, cand);
-      break;
-    case IDIOM_2:
-      Idiom2WatchMemWrite(inst, addr, size, cand);
-      break;
-    case IDIOM_3:
-      Idiom3WatchMemWrite(inst, addr, size, cand);
-      break;
-    case IDIOM_4:
-      Idiom4WatchMemWrite(inst, addr, size, cand);
-      break;
-    case IDIOM_5:
-      Idiom5WatchMemWrite(inst, addr, size, cand);
-      break;
-    default:
-      Abort("invalid idiom\n");
-      break;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    if (slot == owner || !(cand || slot->watching_))
+      continue;
+
+    SetCurrSlot(slot);
+    switch (slot->iroot()->idiom()) {
+      case IDIOM_1:
+        Idiom1WatchMemWrite(inst, addr, size, cand);
+        break;
+      case IDIOM_2:
+        Idiom2WatchMemWrite(inst, addr, size, cand);
+        break;
+      case IDIOM_3:
+        Idiom3WatchMemWrite(inst, addr, size, cand);
+        break;
+      case IDIOM_4:
+        Idiom4WatchMemWrite(inst, addr, size, cand);
+        break;
+      case IDIOM_5:
+        Idiom5WatchMemWrite(inst, addr, size, cand);
+        break;
+      default:
+        Abort("invalid idiom\n");
+        break;
+    }
   }
 }
 
@@ -1413,54 +1394,65 @@ void SchedulerCommon::HandleWatchInstCount(timestamp_t c) {
   if (!start_schedule_)
     return;
 
-  switch (curr_iroot_->idiom()) {
-    case IDIOM_1:
-      Abort("invalid watch inst count\n");
-      break;
-    case IDIOM_2:
-      Idiom2WatchInstCount(c);
-      break;
-    case IDIOM_3:
-      Idiom3WatchInstCount(c);
-      break;
-    case IDIOM_4:
-      Idiom4WatchInstCount(c);
-      break;
-    case IDIOM_5:
-      Idiom5WatchInstCount(c);
-      break;
-    default:
-      Abort("invalid idiom\n");
-      break;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    if (!slot->watching_)
+      continue;
+
+    SetCurrSlot(slot);
+    switch (slot->iroot()->idiom()) {
+      case IDIOM_1:
+        // idiom-1 does not watch inst count
+        break;
+      case IDIOM_2:
+        Idiom2WatchInstCount(c);
+        break;
+      case IDIOM_3:
+        Idiom3WatchInstCount(c);
+        break;
+      case IDIOM_4:
+        Idiom4WatchInstCount(c);
+        break;
+      case IDIOM_5:
+        Idiom5WatchInstCount(c);
+        break;
+      default:
+        Abort("invalid idiom\n");
+        break;
+    }
   }
 }
 
 void SchedulerCommon::HandleSchedYield() {
-  switch (curr_iroot_->idiom()) {
-    case IDIOM_1:
-      Idiom1SchedYield();
-      break;
-    case IDIOM_2:
-      // TODO:
-      break;
-    case IDIOM_3:
-      // TODO:
-      break;
-    case IDIOM_4:
-      // TODO:
-      break;
-    case IDIOM_5:
-      // TODO:
-      break;
-    default:
-      Abort("invalid idiom\n");
-      break;
+  for (SchedSlotVec::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+    SchedSlot *slot = *it;
+    SetCurrSlot(slot);
+    switch (slot->iroot()->idiom()) {
+      case IDIOM_1:
+        Idiom1SchedYield();
+        break;
+      case IDIOM_2:
+        // TODO:
+        break;
+      case IDIOM_3:
+        // TODO:
+        break;
+      case IDIOM_4:
+        // TODO:
+        break;
+      case IDIOM_5:
+        // TODO:
+        break;
+      default:
+        Abort("invalid idiom\n");
+        break;
+    }
   }
 }
 
 void SchedulerCommon::Idiom1BeforeiRootMemRead(UINT32 idx, address_t addr,
                                          size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
     return;
 
   switch (idx) {
@@ -1477,7 +1469,7 @@ void SchedulerCommon::Idiom1BeforeiRootMemRead(UINT32 idx, address_t addr,
 
 void SchedulerCommon::Idiom1BeforeiRootMemWrite(UINT32 idx, address_t addr,
                                           size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
     return;
 
   switch (idx) {
@@ -1546,7 +1538,7 @@ void SchedulerCommon::Idiom1AfteriRootMutexUnlock(UINT32 idx, address_t addr) {
 }
 
 void SchedulerCommon::Idiom1BeforeEvent0(address_t addr, size_t size) {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
+  Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event0", 1);
@@ -1722,7 +1714,7 @@ void SchedulerCommon::Idiom1BeforeEvent0(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom1BeforeEvent1(address_t addr, size_t size) {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
+  Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event1", 1);
@@ -1886,7 +1878,7 @@ void SchedulerCommon::Idiom1BeforeEvent1(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom1AfterEvent0() {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
+  Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] post event 0\n", curr_thd_id);
@@ -1897,7 +1889,6 @@ void SchedulerCommon::Idiom1AfterEvent0() {
       if (curr_thd_id == s->thd_id_[0]) {
         Idiom1SetState(IDIOM1_STATE_E0_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -1921,7 +1912,7 @@ void SchedulerCommon::Idiom1AfterEvent0() {
 }
 
 void SchedulerCommon::Idiom1AfterEvent1() {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
+  Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] post event 1\n", curr_thd_id);
@@ -1932,7 +1923,7 @@ void SchedulerCommon::Idiom1AfterEvent1() {
       if (curr_thd_id == s->thd_id_[1]) {
         ActivelyExposed();
         DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                             curr_thd_id, curr_iroot_->id());
+                             curr_thd_id, CurriRoot()->id());
         Idiom1SetState(IDIOM1_STATE_DONE);
         UnlockSchedStatus();
         //SetPriorityNormal(curr_thd_id);
@@ -1947,7 +1938,7 @@ void SchedulerCommon::Idiom1AfterEvent1() {
 }
 
 void SchedulerCommon::Idiom1WatchAccess(address_t addr, size_t size) {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
+  Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("watch_access", 1);
@@ -2031,15 +2022,11 @@ void SchedulerCommon::Idiom1WatchMutexUnlock(address_t addr) {
 void SchedulerCommon::Idiom1WatchMemRead(Inst *inst, address_t addr, size_t size,
                                    bool cand) {
   Idiom1WatchAccess(addr, size);
-  if (!cand)
-    Idiom1CheckFlush();
 }
 
 void SchedulerCommon::Idiom1WatchMemWrite(Inst *inst, address_t addr, size_t size,
                                     bool cand) {
   Idiom1WatchAccess(addr, size);
-  if (!cand)
-    Idiom1CheckFlush();
 }
 
 void SchedulerCommon::Idiom1SchedYield() {
@@ -2048,47 +2035,26 @@ void SchedulerCommon::Idiom1SchedYield() {
   SetPriorityMin(curr_thd_id);
 }
 
-void SchedulerCommon::Idiom1CheckFlush() {
-  Idiom1SchedStatus *s = idiom1_sched_status_;
-
-  // define a static local variable
-  static int token = 0;
-
-  switch (s->state_) {
-    case IDIOM1_STATE_INIT:
-    case IDIOM1_STATE_E0:
-    case IDIOM1_STATE_E1:
-    case IDIOM1_STATE_DONE:
-      if (token-- <= 0) {
-        FlushWatch();
-        token = 10;
-      }
-      break;
-    default:
-      break;
-  }
-}
-
 bool SchedulerCommon::Idiom1CheckGiveup(int idx) {
   // return true means actual give up
   // return false means one more chance
   if (YieldWithDelay()) {
-    Idiom1SchedStatus *s = idiom1_sched_status_;
+    Idiom1SchedStatus *s = CurrSlot()->idiom1_sched_status_;
     thread_id_t curr_thd_id = PIN_ThreadUid();
     DEBUG_FMT_PRINT_SAFE("[T%lx] Check giveup\n", curr_thd_id);
-    static unsigned long last_state[] = {IDIOM1_STATE_INVALID,
-                                         IDIOM1_STATE_INVALID,
-                                         IDIOM1_STATE_INVALID};
-    static thread_id_t last_thd[] = {INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID};
-    static int time_delayed_each[] = {0, 0, 0};
-    static int time_delayed_total = 0;
-    if (time_delayed_each[idx] <= knob_->ValueInt("yield_delay_min_each") ||
-        time_delayed_total <= knob_->ValueInt("yield_delay_max_total")) {
+    // the delays are accounted per slot, so that the iroots tested in
+    // the same batch do not use up the budget of each other
+    SchedSlot *slot = CurrSlot();
+    DEBUG_ASSERT(idx < SCHED_SLOT_MAX_GIVEUPS);
+    unsigned long *last_state = slot->giveup_last_state_;
+    thread_id_t *last_thd = slot->giveup_last_thd_;
+    int *time_delayed_each = slot->giveup_time_delayed_each_;
+    int &time_delayed_total = slot->giveup_time_delayed_total_;
+    if (time_delayed_each[idx] <= yield_delay_min_each_.Value() ||
+        time_delayed_total <= yield_delay_max_total_.Value()) {
       if (s->state_ != last_state[idx] || curr_thd_id != last_thd[idx]) {
         DEBUG_FMT_PRINT_SAFE("[T%lx] time delay\n", curr_thd_id);
-        int time_unit = knob_->ValueInt("yield_delay_unit");
+        int time_unit = yield_delay_unit_.Value();
         last_state[idx] = s->state_;
         last_thd[idx] = curr_thd_id;
         time_delayed_each[idx] += time_unit;
@@ -2112,12 +2078,14 @@ bool SchedulerCommon::Idiom1CheckGiveup(int idx) {
 void SchedulerCommon::Idiom1SetState(unsigned long s) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set state: %s\n", PIN_ThreadUid(),
                        Idiom1SchedStatus::StateToString(s).c_str());
-  idiom1_sched_status_->state_ = s;
+  CurrSlot()->idiom1_sched_status_->state_ = s;
+  CurrSlot()->watching_ = Idiom1Watching(s);
+  UpdateWatching();
 }
 
 void SchedulerCommon::Idiom1ClearDelaySet(DelaySet *copy) {
-  *copy = idiom1_sched_status_->delay_set_;
-  idiom1_sched_status_->delay_set_.clear();
+  *copy = CurrSlot()->idiom1_sched_status_->delay_set_;
+  CurrSlot()->idiom1_sched_status_->delay_set_.clear();
 }
 
 void SchedulerCommon::Idiom1WakeDelaySet(DelaySet *copy) {
@@ -2131,7 +2099,7 @@ void SchedulerCommon::Idiom1WakeDelaySet(DelaySet *copy) {
 
 void SchedulerCommon::Idiom2BeforeiRootMemRead(UINT32 idx, address_t addr,
                                          size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
     return;
 
   switch (idx) {
@@ -2151,7 +2119,7 @@ void SchedulerCommon::Idiom2BeforeiRootMemRead(UINT32 idx, address_t addr,
 
 void SchedulerCommon::Idiom2BeforeiRootMemWrite(UINT32 idx, address_t addr,
                                           size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
     return;
 
   switch (idx) {
@@ -2202,7 +2170,7 @@ void SchedulerCommon::Idiom2AfteriRootMutexUnlock(UINT32 idx, address_t addr) {
 }
 
 void SchedulerCommon::Idiom2BeforeEvent0(address_t addr, size_t size) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event0", 1);
@@ -2593,7 +2561,7 @@ void SchedulerCommon::Idiom2BeforeEvent0(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom2BeforeEvent1(address_t addr, size_t size) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event1", 1);
@@ -2989,7 +2957,7 @@ void SchedulerCommon::Idiom2BeforeEvent1(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom2BeforeEvent2(address_t addr, size_t size) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event2", 1);
@@ -3175,7 +3143,7 @@ void SchedulerCommon::Idiom2BeforeEvent2(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom2AfterEvent0() {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 0\n", curr_thd_id);
@@ -3188,7 +3156,6 @@ void SchedulerCommon::Idiom2AfterEvent0() {
         Idiom2SetState(IDIOM2_STATE_E0_E1_WATCH);
         UnlockSchedStatus();
         SetPriorityHigh(curr_thd_id);
-        FlushWatch();
       } else {
         UnlockSchedStatus();
       }
@@ -3198,7 +3165,6 @@ void SchedulerCommon::Idiom2AfterEvent0() {
         s->window_ = 0;
         Idiom2SetState(IDIOM2_STATE_E0_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -3211,7 +3177,7 @@ void SchedulerCommon::Idiom2AfterEvent0() {
 }
 
 void SchedulerCommon::Idiom2AfterEvent1() {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 1\n", curr_thd_id);
@@ -3245,7 +3211,7 @@ void SchedulerCommon::Idiom2AfterEvent1() {
 }
 
 void SchedulerCommon::Idiom2AfterEvent2() {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 2\n", curr_thd_id);
@@ -3256,7 +3222,7 @@ void SchedulerCommon::Idiom2AfterEvent2() {
       if (curr_thd_id == s->thd_id_[2]) {
         ActivelyExposed();
         DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                             curr_thd_id, curr_iroot_->id());
+                             curr_thd_id, CurriRoot()->id());
         Idiom2SetState(IDIOM2_STATE_DONE);
         UnlockSchedStatus();
         SetPriorityNormal(curr_thd_id);
@@ -3271,7 +3237,7 @@ void SchedulerCommon::Idiom2AfterEvent2() {
 }
 
 void SchedulerCommon::Idiom2WatchAccess(address_t addr, size_t size) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("watch_access", 1);
@@ -3446,7 +3412,7 @@ void SchedulerCommon::Idiom2WatchAccess(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom2WatchInstCount(timestamp_t c) {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
+  Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   LockSchedStatus();
@@ -3527,61 +3493,32 @@ void SchedulerCommon::Idiom2WatchMutexUnlock(address_t addr) {
 void SchedulerCommon::Idiom2WatchMemRead(Inst *inst, address_t addr, size_t size,
                                    bool cand) {
   Idiom2WatchAccess(addr, size);
-  if (!cand)
-    Idiom2CheckFlush();
 }
 
 void SchedulerCommon::Idiom2WatchMemWrite(Inst *inst, address_t addr, size_t size,
                                     bool cand) {
   Idiom2WatchAccess(addr, size);
-  if (!cand)
-    Idiom2CheckFlush();
 }
 
 
-void SchedulerCommon::Idiom2CheckFlush() {
-  Idiom2SchedStatus *s = idiom2_sched_status_;
-
-  // define a static local variable
-  static int token = 0;
-
-  switch (s->state_) {
-    case IDIOM2_STATE_INIT:
-    case IDIOM2_STATE_E0:
-    case IDIOM2_STATE_E1:
-    case IDIOM2_STATE_DONE:
-      if (token-- <= 0) {
-        FlushWatch();
-        token = 10;
-      }
-      break;
-    default:
-      break;
-  }
-}
-
 bool SchedulerCommon::Idiom2CheckGiveup(int idx) {
   // return true means actual give up
   // return false means one more chance
   if (YieldWithDelay()) {
-    Idiom2SchedStatus *s = idiom2_sched_status_;
+    Idiom2SchedStatus *s = CurrSlot()->idiom2_sched_status_;
     thread_id_t curr_thd_id = PIN_ThreadUid();
     DEBUG_FMT_PRINT_SAFE("[T%lx] Check giveup\n", curr_thd_id);
-    static unsigned long last_state[] = {IDIOM2_STATE_INVALID,
-                                         IDIOM2_STATE_INVALID,
-                                         IDIOM2_STATE_INVALID,
-                                         IDIOM2_STATE_INVALID};
-    static thread_id_t last_thd[] = {INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID};
-    static int time_delayed_each[] = {0, 0, 0, 0};
-    static int time_delayed_total = 0;
-    if (time_delayed_each[idx] <= knob_->ValueInt("yield_delay_min_each") ||
-        time_delayed_total <= knob_->ValueInt("yield_delay_max_total")) {
+    SchedSlot *slot = CurrSlot();
+    DEBUG_ASSERT(idx < SCHED_SLOT_MAX_GIVEUPS);
+    unsigned long *last_state = slot->giveup_last_state_;
+    thread_id_t *last_thd = slot->giveup_last_thd_;
+    int *time_delayed_each = slot->giveup_time_delayed_each_;
+    int &time_delayed_total = slot->giveup_time_delayed_total_;
+    if (time_delayed_each[idx] <= yield_delay_min_each_.Value() ||
+        time_delayed_total <= yield_delay_max_total_.Value()) {
       if (s->state_ != last_state[idx] || curr_thd_id != last_thd[idx]) {
         DEBUG_FMT_PRINT_SAFE("[T%lx] time delay\n", curr_thd_id);
-        int time_unit = knob_->ValueInt("yield_delay_unit");
+        int time_unit = yield_delay_unit_.Value();
         last_state[idx] = s->state_;
         last_thd[idx] = curr_thd_id;
         time_delayed_each[idx] += time_unit;
@@ -3604,12 +3541,14 @@ bool SchedulerCommon::Idiom2CheckGiveup(int idx) {
 void SchedulerCommon::Idiom2SetState(unsigned long s) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set state: %s\n", PIN_ThreadUid(),
                        Idiom2SchedStatus::StateToString(s).c_str());
-  idiom2_sched_status_->state_ = s;
+  CurrSlot()->idiom2_sched_status_->state_ = s;
+  CurrSlot()->watching_ = Idiom2Watching(s);
+  UpdateWatching();
 }
 
 void SchedulerCommon::Idiom2ClearDelaySet(DelaySet *copy) {
-  *copy = idiom2_sched_status_->delay_set_;
-  idiom2_sched_status_->delay_set_.clear();
+  *copy = CurrSlot()->idiom2_sched_status_->delay_set_;
+  CurrSlot()->idiom2_sched_status_->delay_set_.clear();
 }
 
 void SchedulerCommon::Idiom2WakeDelaySet(DelaySet *copy) {
@@ -3623,7 +3562,7 @@ void SchedulerCommon::Idiom2WakeDelaySet(DelaySet *copy) {
 
 void SchedulerCommon::Idiom3BeforeiRootMemRead(UINT32 idx, address_t addr,
                                          size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
     return;
 
   switch (idx) {
@@ -3646,7 +3585,7 @@ void SchedulerCommon::Idiom3BeforeiRootMemRead(UINT32 idx, address_t addr,
 
 void SchedulerCommon::Idiom3BeforeiRootMemWrite(UINT32 idx, address_t addr,
                                           size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
     return;
 
   switch (idx) {
@@ -3739,7 +3678,7 @@ void SchedulerCommon::Idiom3AfteriRootMutexUnlock(UINT32 idx, address_t addr) {
 }
 
 void SchedulerCommon::Idiom3BeforeEvent0(address_t addr, size_t size) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event0", 1);
@@ -4277,7 +4216,7 @@ void SchedulerCommon::Idiom3BeforeEvent0(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom3BeforeEvent1(address_t addr, size_t size) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event1", 1);
@@ -4800,7 +4739,7 @@ void SchedulerCommon::Idiom3BeforeEvent1(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom3BeforeEvent2(address_t addr, size_t size) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event2", 1);
@@ -5087,7 +5026,7 @@ void SchedulerCommon::Idiom3BeforeEvent2(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom3BeforeEvent3(address_t addr, size_t size) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event3", 1);
@@ -5367,7 +5306,7 @@ void SchedulerCommon::Idiom3BeforeEvent3(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom3AfterEvent0() {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 0\n", curr_thd_id);
@@ -5380,7 +5319,6 @@ void SchedulerCommon::Idiom3AfterEvent0() {
         s->window_ = 0;
         Idiom3SetState(IDIOM3_STATE_E0_E1_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityMax(curr_thd_id);
         SetPriorityHigh(target);
         SetPriorityNormal(curr_thd_id);
@@ -5393,7 +5331,6 @@ void SchedulerCommon::Idiom3AfterEvent0() {
         s->window_ = 0;
         Idiom3SetState(IDIOM3_STATE_E0_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -5406,7 +5343,7 @@ void SchedulerCommon::Idiom3AfterEvent0() {
 }
 
 void SchedulerCommon::Idiom3AfterEvent1() {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 1\n", curr_thd_id);
@@ -5440,7 +5377,7 @@ void SchedulerCommon::Idiom3AfterEvent1() {
 }
 
 void SchedulerCommon::Idiom3AfterEvent2() {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 2\n", curr_thd_id);
@@ -5477,7 +5414,7 @@ void SchedulerCommon::Idiom3AfterEvent2() {
 }
 
 void SchedulerCommon::Idiom3AfterEvent3() {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 3\n", curr_thd_id);
@@ -5488,7 +5425,7 @@ void SchedulerCommon::Idiom3AfterEvent3() {
       if (curr_thd_id == s->thd_id_[3]) {
         ActivelyExposed();
         DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                             curr_thd_id, curr_iroot_->id());
+                             curr_thd_id, CurriRoot()->id());
         Idiom3SetState(IDIOM3_STATE_DONE);
         UnlockSchedStatus();
         SetPriorityNormal(curr_thd_id);
@@ -5503,7 +5440,7 @@ void SchedulerCommon::Idiom3AfterEvent3() {
 }
 
 void SchedulerCommon::Idiom3WatchAccess(address_t addr, size_t size) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("watch_access", 1);
@@ -5745,7 +5682,7 @@ void SchedulerCommon::Idiom3WatchAccess(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom3WatchInstCount(timestamp_t c) {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
+  Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   LockSchedStatus();
@@ -5855,62 +5792,31 @@ void SchedulerCommon::Idiom3WatchMutexUnlock(address_t addr) {
 void SchedulerCommon::Idiom3WatchMemRead(Inst *inst, address_t addr, size_t size,
                                    bool cand) {
   Idiom3WatchAccess(addr, size);
-  if (!cand)
-    Idiom3CheckFlush();
 }
 
 void SchedulerCommon::Idiom3WatchMemWrite(Inst *inst, address_t addr, size_t size,
                                     bool cand) {
   Idiom3WatchAccess(addr, size);
-  if (!cand)
-    Idiom3CheckFlush();
-}
-
-void SchedulerCommon::Idiom3CheckFlush() {
-  Idiom3SchedStatus *s = idiom3_sched_status_;
-
-  // define a static local variable
-  static int token = 0;
-
-  switch (s->state_) {
-    case IDIOM3_STATE_INIT:
-    case IDIOM3_STATE_E0:
-    case IDIOM3_STATE_E1:
-    case IDIOM3_STATE_DONE:
-      if (token-- <= 0) {
-        FlushWatch();
-        token = 10;
-      }
-      break;
-    default:
-      break;
-  }
 }
 
 bool SchedulerCommon::Idiom3CheckGiveup(int idx) {
   // return true means actual give up
   // return false means one more chance
   if (YieldWithDelay()) {
-    Idiom3SchedStatus *s = idiom3_sched_status_;
+    Idiom3SchedStatus *s = CurrSlot()->idiom3_sched_status_;
     thread_id_t curr_thd_id = PIN_ThreadUid();
     DEBUG_FMT_PRINT_SAFE("[T%lx] Check giveup\n", curr_thd_id);
-    static unsigned long last_state[] = {IDIOM3_STATE_INVALID,
-                                         IDIOM3_STATE_INVALID,
-                                         IDIOM3_STATE_INVALID,
-                                         IDIOM3_STATE_INVALID,
-                                         IDIOM3_STATE_INVALID};
-    static thread_id_t last_thd[] = {INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID};
-    static int time_delayed_each[] = {0, 0, 0, 0, 0};
-    static int time_delayed_total = 0;
-    if (time_delayed_each[idx] <= knob_->ValueInt("yield_delay_min_each") ||
-        time_delayed_total <= knob_->ValueInt("yield_delay_max_total")) {
+    SchedSlot *slot = CurrSlot();
+    DEBUG_ASSERT(idx < SCHED_SLOT_MAX_GIVEUPS);
+    unsigned long *last_state = slot->giveup_last_state_;
+    thread_id_t *last_thd = slot->giveup_last_thd_;
+    int *time_delayed_each = slot->giveup_time_delayed_each_;
+    int &time_delayed_total = slot->giveup_time_delayed_total_;
+    if (time_delayed_each[idx] <= yield_delay_min_each_.Value() ||
+        time_delayed_total <= yield_delay_max_total_.Value()) {
       if (s->state_ != last_state[idx] || curr_thd_id != last_thd[idx]) {
         DEBUG_FMT_PRINT_SAFE("[T%lx] time delay\n", curr_thd_id);
-        int time_unit = knob_->ValueInt("yield_delay_unit");
+        int time_unit = yield_delay_unit_.Value();
         last_state[idx] = s->state_;
         last_thd[idx] = curr_thd_id;
         time_delayed_each[idx] += time_unit;
@@ -5933,12 +5839,14 @@ bool SchedulerCommon::Idiom3CheckGiveup(int idx) {
 void SchedulerCommon::Idiom3SetState(unsigned long s) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set state: %s\n", PIN_ThreadUid(),
                        Idiom3SchedStatus::StateToString(s).c_str());
-  idiom3_sched_status_->state_ = s;
+  CurrSlot()->idiom3_sched_status_->state_ = s;
+  CurrSlot()->watching_ = Idiom3Watching(s);
+  UpdateWatching();
 }
 
 void SchedulerCommon::Idiom3ClearDelaySet(DelaySet *copy) {
-  *copy = idiom3_sched_status_->delay_set_;
-  idiom3_sched_status_->delay_set_.clear();
+  *copy = CurrSlot()->idiom3_sched_status_->delay_set_;
+  CurrSlot()->idiom3_sched_status_->delay_set_.clear();
 }
 
 void SchedulerCommon::Idiom3WakeDelaySet(DelaySet *copy) {
@@ -5952,7 +5860,7 @@ void SchedulerCommon::Idiom3WakeDelaySet(DelaySet *copy) {
 
 void SchedulerCommon::Idiom4BeforeiRootMemRead(UINT32 idx, address_t addr,
                                          size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
     return;
 
   switch (idx) {
@@ -5975,7 +5883,7 @@ void SchedulerCommon::Idiom4BeforeiRootMemRead(UINT32 idx, address_t addr,
 
 void SchedulerCommon::Idiom4BeforeiRootMemWrite(UINT32 idx, address_t addr,
                                           size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
     return;
 
   switch (idx) {
@@ -6068,7 +5976,7 @@ void SchedulerCommon::Idiom4AfteriRootMutexUnlock(UINT32 idx, address_t addr) {
 }
 
 void SchedulerCommon::Idiom4BeforeEvent0(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event0", 1);
@@ -6625,7 +6533,7 @@ void SchedulerCommon::Idiom4BeforeEvent0(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom4BeforeEvent1(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event1", 1);
@@ -7168,7 +7076,7 @@ void SchedulerCommon::Idiom4BeforeEvent1(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom4BeforeEvent2(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event2", 1);
@@ -7506,7 +7414,7 @@ void SchedulerCommon::Idiom4BeforeEvent2(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom4BeforeEvent3(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event3", 1);
@@ -7872,7 +7780,7 @@ void SchedulerCommon::Idiom4BeforeEvent3(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom4AfterEvent0() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 0\n", curr_thd_id);
@@ -7886,7 +7794,6 @@ void SchedulerCommon::Idiom4AfterEvent0() {
         Idiom4ClearRecordedAccess();
         Idiom4SetState(IDIOM4_STATE_E0_E1_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityMax(curr_thd_id);
         SetPriorityHigh(target);
         SetPriorityNormal(curr_thd_id);
@@ -7900,7 +7807,6 @@ void SchedulerCommon::Idiom4AfterEvent0() {
         Idiom4ClearRecordedAccess();
         Idiom4SetState(IDIOM4_STATE_E0_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -7913,7 +7819,7 @@ void SchedulerCommon::Idiom4AfterEvent0() {
 }
 
 void SchedulerCommon::Idiom4AfterEvent1() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 1\n", curr_thd_id);
@@ -7947,7 +7853,7 @@ void SchedulerCommon::Idiom4AfterEvent1() {
 }
 
 void SchedulerCommon::Idiom4AfterEvent2() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 2\n", curr_thd_id);
@@ -7984,7 +7890,7 @@ void SchedulerCommon::Idiom4AfterEvent2() {
 }
 
 void SchedulerCommon::Idiom4AfterEvent3() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 3\n", curr_thd_id);
@@ -7995,7 +7901,7 @@ void SchedulerCommon::Idiom4AfterEvent3() {
       if (curr_thd_id == s->thd_id_[3]) {
         ActivelyExposed();
         DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                             curr_thd_id, curr_iroot_->id());
+                             curr_thd_id, CurriRoot()->id());
         Idiom4SetState(IDIOM4_STATE_DONE);
         UnlockSchedStatus();
         SetPriorityNormal(curr_thd_id);
@@ -8010,7 +7916,7 @@ void SchedulerCommon::Idiom4AfterEvent3() {
 }
 
 void SchedulerCommon::Idiom4WatchAccess(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("watch_access", 1);
@@ -8268,7 +8174,7 @@ void SchedulerCommon::Idiom4WatchAccess(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom4WatchInstCount(timestamp_t c) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   while (true) {
@@ -8386,62 +8292,31 @@ void SchedulerCommon::Idiom4WatchMutexUnlock(address_t addr) {
 void SchedulerCommon::Idiom4WatchMemRead(Inst *inst, address_t addr, size_t size,
                                    bool cand) {
   Idiom4WatchAccess(addr, size);
-  if (!cand)
-    Idiom4CheckFlush();
 }
 
 void SchedulerCommon::Idiom4WatchMemWrite(Inst *inst, address_t addr, size_t size,
                                     bool cand) {
   Idiom4WatchAccess(addr, size);
-  if (!cand)
-    Idiom4CheckFlush();
-}
-
-void SchedulerCommon::Idiom4CheckFlush() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
-
-  // define a static local variable
-  static int token = 0;
-
-  switch (s->state_) {
-    case IDIOM4_STATE_INIT:
-    case IDIOM4_STATE_E0:
-    case IDIOM4_STATE_E1:
-    case IDIOM4_STATE_DONE:
-      if (token-- <= 0) {
-        FlushWatch();
-        token = 10;
-      }
-      break;
-    default:
-      break;
-  }
 }
 
 bool SchedulerCommon::Idiom4CheckGiveup(int idx) {
   // return true means actual give up
   // return false means one more chance
   if (YieldWithDelay()) {
-    Idiom4SchedStatus *s = idiom4_sched_status_;
+    Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
     thread_id_t curr_thd_id = PIN_ThreadUid();
     DEBUG_FMT_PRINT_SAFE("[T%lx] Check giveup\n", curr_thd_id);
-    static unsigned long last_state[] = {IDIOM4_STATE_INVALID,
-                                         IDIOM4_STATE_INVALID,
-                                         IDIOM4_STATE_INVALID,
-                                         IDIOM4_STATE_INVALID,
-                                         IDIOM4_STATE_INVALID};
-    static thread_id_t last_thd[] = {INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID};
-    static int time_delayed_each[] = {0, 0, 0, 0, 0};
-    static int time_delayed_total = 0;
-    if (time_delayed_each[idx] <= knob_->ValueInt("yield_delay_min_each") ||
-        time_delayed_total <= knob_->ValueInt("yield_delay_max_total")) {
+    SchedSlot *slot = CurrSlot();
+    DEBUG_ASSERT(idx < SCHED_SLOT_MAX_GIVEUPS);
+    unsigned long *last_state = slot->giveup_last_state_;
+    thread_id_t *last_thd = slot->giveup_last_thd_;
+    int *time_delayed_each = slot->giveup_time_delayed_each_;
+    int &time_delayed_total = slot->giveup_time_delayed_total_;
+    if (time_delayed_each[idx] <= yield_delay_min_each_.Value() ||
+        time_delayed_total <= yield_delay_max_total_.Value()) {
       if (s->state_ != last_state[idx] || curr_thd_id != last_thd[idx]) {
         DEBUG_FMT_PRINT_SAFE("[T%lx] time delay\n", curr_thd_id);
-        int time_unit = knob_->ValueInt("yield_delay_unit");
+        int time_unit = yield_delay_unit_.Value();
         last_state[idx] = s->state_;
         last_thd[idx] = curr_thd_id;
         time_delayed_each[idx] += time_unit;
@@ -8464,12 +8339,14 @@ bool SchedulerCommon::Idiom4CheckGiveup(int idx) {
 void SchedulerCommon::Idiom4SetState(unsigned long s) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set state: %s\n", PIN_ThreadUid(),
                        Idiom4SchedStatus::StateToString(s).c_str());
-  idiom4_sched_status_->state_ = s;
+  CurrSlot()->idiom4_sched_status_->state_ = s;
+  CurrSlot()->watching_ = Idiom4Watching(s);
+  UpdateWatching();
 }
 
 void SchedulerCommon::Idiom4ClearDelaySet(DelaySet *copy) {
-  *copy = idiom4_sched_status_->delay_set_;
-  idiom4_sched_status_->delay_set_.clear();
+  *copy = CurrSlot()->idiom4_sched_status_->delay_set_;
+  CurrSlot()->idiom4_sched_status_->delay_set_.clear();
 }
 
 void SchedulerCommon::Idiom4WakeDelaySet(DelaySet *copy) {
@@ -8482,17 +8359,17 @@ void SchedulerCommon::Idiom4WakeDelaySet(DelaySet *copy) {
 }
 
 void SchedulerCommon::Idiom4RecordAccess(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   s->recorded_addr_set_.insert(addr);
 }
 
 void SchedulerCommon::Idiom4ClearRecordedAccess() {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   s->recorded_addr_set_.clear();
 }
 
 bool SchedulerCommon::Idiom4Recorded(address_t addr, size_t size) {
-  Idiom4SchedStatus *s = idiom4_sched_status_;
+  Idiom4SchedStatus *s = CurrSlot()->idiom4_sched_status_;
   if (s->recorded_addr_set_.find(addr) != s->recorded_addr_set_.end())
     return true;
   else
@@ -8501,7 +8378,7 @@ bool SchedulerCommon::Idiom4Recorded(address_t addr, size_t size) {
 
 void SchedulerCommon::Idiom5BeforeiRootMemRead(UINT32 idx, address_t addr,
                                          size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_WRITE)
     return;
 
   switch (idx) {
@@ -8524,7 +8401,7 @@ void SchedulerCommon::Idiom5BeforeiRootMemRead(UINT32 idx, address_t addr,
 
 void SchedulerCommon::Idiom5BeforeiRootMemWrite(UINT32 idx, address_t addr,
                                           size_t size) {
-  if (curr_iroot_->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
+  if (CurriRoot()->GetEvent(idx)->type() == IROOT_EVENT_MEM_READ)
     return;
 
   switch (idx) {
@@ -8641,7 +8518,7 @@ void SchedulerCommon::Idiom5AfteriRootMutexUnlock(UINT32 idx, address_t addr) {
 }
 
 void SchedulerCommon::Idiom5BeforeEvent0(address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event0", 1);
@@ -9883,7 +9760,7 @@ void SchedulerCommon::Idiom5BeforeEvent0(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5BeforeEvent1(address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event1", 1);
@@ -10307,7 +10184,7 @@ void SchedulerCommon::Idiom5BeforeEvent1(address_t addr, size_t size) {
             Idiom5SetState(IDIOM5_STATE_E0_E1_E2_E3);
             ActivelyExposed();
             DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                                 curr_thd_id, curr_iroot_->id());
+                                 curr_thd_id, CurriRoot()->id());
             UnlockSchedStatus();
             Idiom5WakeDelaySet(&copy);
             SetPriorityHigh(target);
@@ -10482,7 +10359,7 @@ void SchedulerCommon::Idiom5BeforeEvent1(address_t addr, size_t size) {
             Idiom5SetState(IDIOM5_STATE_E0_E1_E2_E3);
             ActivelyExposed();
             DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                                 curr_thd_id, curr_iroot_->id());
+                                 curr_thd_id, CurriRoot()->id());
             UnlockSchedStatus();
             Idiom5WakeDelaySet(&copy);
             SetPriorityNormal(target);
@@ -10544,7 +10421,7 @@ void SchedulerCommon::Idiom5BeforeEvent1(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5BeforeEvent2(address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event2", 1);
@@ -11805,7 +11682,7 @@ void SchedulerCommon::Idiom5BeforeEvent2(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5BeforeEvent3(address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("event3", 1);
@@ -12166,7 +12043,7 @@ void SchedulerCommon::Idiom5BeforeEvent3(address_t addr, size_t size) {
             Idiom5SetState(IDIOM5_STATE_E0_E1_E2_E3);
             ActivelyExposed();
             DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                                 curr_thd_id, curr_iroot_->id());
+                                 curr_thd_id, CurriRoot()->id());
             UnlockSchedStatus();
             Idiom5WakeDelaySet(&copy);
             SetPriorityHigh(target);
@@ -12295,7 +12172,7 @@ void SchedulerCommon::Idiom5BeforeEvent3(address_t addr, size_t size) {
             Idiom5SetState(IDIOM5_STATE_E0_E1_E2_E3);
             ActivelyExposed();
             DEBUG_FMT_PRINT_SAFE("[T%lx] iRoot %u exposed.\n",
-                                 curr_thd_id, curr_iroot_->id());
+                                 curr_thd_id, CurriRoot()->id());
             UnlockSchedStatus();
             Idiom5WakeDelaySet(&copy);
             SetPriorityNormal(target);
@@ -12464,7 +12341,7 @@ void SchedulerCommon::Idiom5BeforeEvent3(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5AfterEvent0() {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 0\n", curr_thd_id);
@@ -12478,7 +12355,6 @@ void SchedulerCommon::Idiom5AfterEvent0() {
         Idiom5ClearRecordedAccess(0);
         Idiom5RecordAccess(0, s->addr_[0], s->size_[0]);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityHigh(curr_thd_id);
         SetPriorityMax(target);
       } else {
@@ -12492,7 +12368,6 @@ void SchedulerCommon::Idiom5AfterEvent0() {
         Idiom5RecordAccess(0, s->addr_[0], s->size_[0]);
         Idiom5SetState(IDIOM5_STATE_E0_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -12532,7 +12407,7 @@ void SchedulerCommon::Idiom5AfterEvent0() {
 }
 
 void SchedulerCommon::Idiom5AfterEvent1() {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 1\n", curr_thd_id);
@@ -12568,7 +12443,7 @@ void SchedulerCommon::Idiom5AfterEvent1() {
 }
 
 void SchedulerCommon::Idiom5AfterEvent2() {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 2\n", curr_thd_id);
@@ -12594,7 +12469,6 @@ void SchedulerCommon::Idiom5AfterEvent2() {
         Idiom5RecordAccess(2, s->addr_[2], s->size_[2]);
         Idiom5SetState(IDIOM5_STATE_E2_WATCH);
         UnlockSchedStatus();
-        FlushWatch();
         SetPriorityLow(curr_thd_id);
       } else {
         UnlockSchedStatus();
@@ -12634,7 +12508,7 @@ void SchedulerCommon::Idiom5AfterEvent2() {
 }
 
 void SchedulerCommon::Idiom5AfterEvent3() {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_FMT_PRINT_SAFE("[T%lx] after event 3\n", curr_thd_id);
@@ -12670,7 +12544,7 @@ void SchedulerCommon::Idiom5AfterEvent3() {
 }
 
 void SchedulerCommon::Idiom5WatchAccess(address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   DEBUG_STAT_INC("watch_access", 1);
@@ -13295,7 +13169,7 @@ void SchedulerCommon::Idiom5WatchAccess(address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5WatchInstCount(timestamp_t c) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   thread_id_t curr_thd_id = PIN_ThreadUid();
 
   LockSchedStatus();
@@ -13482,63 +13356,31 @@ void SchedulerCommon::Idiom5WatchMutexUnlock(address_t addr) {
 void SchedulerCommon::Idiom5WatchMemRead(Inst *inst, address_t addr, size_t size,
                                    bool cand) {
   Idiom5WatchAccess(addr, size);
-  if (!cand)
-    Idiom5CheckFlush();
 }
 
 void SchedulerCommon::Idiom5WatchMemWrite(Inst *inst, address_t addr, size_t size,
                                     bool cand) {
   Idiom5WatchAccess(addr, size);
-  if (!cand)
-    Idiom5CheckFlush();
-}
-
-void SchedulerCommon::Idiom5CheckFlush() {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
-
-  // define a static local variable
-  static int token = 0;
-
-  switch (s->state_) {
-    case IDIOM5_STATE_INIT:
-    case IDIOM5_STATE_E0:
-    case IDIOM5_STATE_E2:
-    case IDIOM5_STATE_E0_E1_E2_E3:
-    case IDIOM5_STATE_DONE:
-      if (token-- <= 0) {
-        FlushWatch();
-        token = 10;
-      }
-      break;
-    default:
-      break;
-  }
 }
 
 bool SchedulerCommon::Idiom5CheckGiveup(int idx) {
   // return true means actual give up
   // return false means one more chance
   if (YieldWithDelay()) {
-    Idiom5SchedStatus *s = idiom5_sched_status_;
+    Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
     thread_id_t curr_thd_id = PIN_ThreadUid();
     DEBUG_FMT_PRINT_SAFE("[T%lx] Check giveup\n", curr_thd_id);
-    static unsigned long last_state[] = {IDIOM5_STATE_INVALID,
-                                         IDIOM5_STATE_INVALID,
-                                         IDIOM5_STATE_INVALID,
-                                         IDIOM5_STATE_INVALID,
-                                         IDIOM5_STATE_INVALID};
-    static thread_id_t last_thd[] = {INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID,
-                                     INVALID_THD_ID};
-    static int time_delayed_each[] = {0, 0, 0, 0, 0};
-    static int time_delayed_total = 0;
-    if (time_delayed_each[idx] <= knob_->ValueInt("yield_delay_min_each") ||
-        time_delayed_total <= knob_->ValueInt("yield_delay_max_total")) {
+    SchedSlot *slot = CurrSlot();
+    DEBUG_ASSERT(idx < SCHED_SLOT_MAX_GIVEUPS);
+    unsigned long *last_state = slot->giveup_last_state_;
+    thread_id_t *last_thd = slot->giveup_last_thd_;
+    int *time_delayed_each = slot->giveup_time_delayed_each_;
+    int &time_delayed_total = slot->giveup_time_delayed_total_;
+    if (time_delayed_each[idx] <= yield_delay_min_each_.Value() ||
+        time_delayed_total <= yield_delay_max_total_.Value()) {
       if (s->state_ != last_state[idx] || curr_thd_id != last_thd[idx]) {
         DEBUG_FMT_PRINT_SAFE("[T%lx] time delay\n", curr_thd_id);
-        int time_unit = knob_->ValueInt("yield_delay_unit");
+        int time_unit = yield_delay_unit_.Value();
         last_state[idx] = s->state_;
         last_thd[idx] = curr_thd_id;
         time_delayed_each[idx] += time_unit;
@@ -13561,12 +13403,14 @@ bool SchedulerCommon::Idiom5CheckGiveup(int idx) {
 void SchedulerCommon::Idiom5SetState(unsigned long s) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set state: %s\n", PIN_ThreadUid(),
                        Idiom5SchedStatus::StateToString(s).c_str());
-  idiom5_sched_status_->state_ = s;
+  CurrSlot()->idiom5_sched_status_->state_ = s;
+  CurrSlot()->watching_ = Idiom5Watching(s);
+  UpdateWatching();
 }
 
 void SchedulerCommon::Idiom5ClearDelaySet(DelaySet *copy) {
-  *copy = idiom5_sched_status_->delay_set_;
-  idiom5_sched_status_->delay_set_.clear();
+  *copy = CurrSlot()->idiom5_sched_status_->delay_set_;
+  CurrSlot()->idiom5_sched_status_->delay_set_.clear();
 }
 
 void SchedulerCommon::Idiom5WakeDelaySet(DelaySet *copy) {
@@ -13579,7 +13423,7 @@ void SchedulerCommon::Idiom5WakeDelaySet(DelaySet *copy) {
 }
 
 void SchedulerCommon::Idiom5RecordAccess(int idx, address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   if (idx == 0) {
     s->recorded_addr_set0_.insert(addr);
   } else if (idx == 2) {
@@ -13590,7 +13434,7 @@ void SchedulerCommon::Idiom5RecordAccess(int idx, address_t addr, size_t size) {
 }
 
 void SchedulerCommon::Idiom5ClearRecordedAccess(int idx) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   if (idx == 0) {
     s->recorded_addr_set0_.clear();
   } else if (idx == 2) {
@@ -13601,7 +13445,7 @@ void SchedulerCommon::Idiom5ClearRecordedAccess(int idx) {
 }
 
 bool SchedulerCommon::Idiom5Recorded(int idx, address_t addr, size_t size) {
-  Idiom5SchedStatus *s = idiom5_sched_status_;
+  Idiom5SchedStatus *s = CurrSlot()->idiom5_sched_status_;
   if (idx == 0) {
     return s->recorded_addr_set0_.find(addr) != s->recorded_addr_set0_.end();
   } else if (idx == 2) {
@@ -13612,26 +13456,37 @@ bool SchedulerCommon::Idiom5Recorded(int idx, address_t addr, size_t size) {
   }
 }
 
-void SchedulerCommon::__BeforeiRootMemRead(UINT32 idx, ADDRINT addr, UINT32 size) {
+void SchedulerCommon::__BeforeiRootMemRead(SchedSlot *slot, UINT32 idx,
+                                           ADDRINT addr, UINT32 size) {
+  ((SchedulerCommon *)ctrl_)->SetCurrSlot(slot);
   ((SchedulerCommon *)ctrl_)->HandleBeforeiRootMemRead(idx, addr, size);
 }
 
-void SchedulerCommon::__BeforeiRootMemWrite(UINT32 idx, ADDRINT addr, UINT32 size) {
+void SchedulerCommon::__BeforeiRootMemWrite(SchedSlot *slot, UINT32 idx,
+                                            ADDRINT addr, UINT32 size) {
+  ((SchedulerCommon *)ctrl_)->SetCurrSlot(slot);
   ((SchedulerCommon *)ctrl_)->HandleBeforeiRootMemWrite(idx, addr, size);
 }
 
-void SchedulerCommon::__AfteriRootMem(UINT32 idx) {
+void SchedulerCommon::__AfteriRootMem(SchedSlot *slot, UINT32 idx) {
+  ((SchedulerCommon *)ctrl_)->SetCurrSlot(slot);
   ((SchedulerCommon *)ctrl_)->HandleAfteriRootMem(idx);
 }
 
-void SchedulerCommon::__WatchMemRead(Inst *inst, ADDRINT addr, UINT32 size,
-                               BOOL cand) {
-  ((SchedulerCommon *)ctrl_)->HandleWatchMemRead(inst, addr, size, cand);
+void SchedulerCommon::__WatchMemRead(SchedSlot *owner, Inst *inst,
+                                     ADDRINT addr, UINT32 size, BOOL cand) {
+  ((SchedulerCommon *)ctrl_)->HandleWatchMemRead(owner, inst, addr, size,
+                                                 cand);
+}
+
+void SchedulerCommon::__WatchMemWrite(SchedSlot *owner, Inst *inst,
+                                      ADDRINT addr, UINT32 size, BOOL cand) {
+  ((SchedulerCommon *)ctrl_)->HandleWatchMemWrite(owner, inst, addr, size,
+                                                  cand);
 }
 
-void SchedulerCommon::__WatchMemWrite(Inst *inst, ADDRINT addr, UINT32 size,
-                                BOOL cand) {
-  ((SchedulerCommon *)ctrl_)->HandleWatchMemWrite(inst, addr, size, cand);
+ADDRINT SchedulerCommon::__Watching(BOOL cand) {
+  return cand || ((SchedulerCommon *)ctrl_)->watching_;
 }
 
 void SchedulerCommon::__WatchInstCount(UINT32 c) {
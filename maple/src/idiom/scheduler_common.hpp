@@ -22,6 +22,8 @@
 
 #include <cstring>
 #include <set>
+#include <vector>
+#include <tr1/unordered_map>
 #include <tr1/unordered_set>
 #include "core/basictypes.h"
 #include "core/execution_control.hpp"
@@ -403,6 +405,41 @@ class Idiom5SchedStatus {
   DISALLOW_COPY_CONSTRUCTORS(Idiom5SchedStatus);
 };
 
+// the max number of events an idiom can give up at
+#define SCHED_SLOT_MAX_GIVEUPS 5
+
+// The test status of an iRoot under test. When a batch of iRoots is
+// tested in one execution, each of them has its own slot, and thus its
+// own state machine.
+class SchedSlot {
+ public:
+  explicit SchedSlot(iRoot *iroot);
+  ~SchedSlot() {}
+
+  iRoot *iroot() { return iroot_; }
+
+ private:
+  iRoot *iroot_;
+  Idiom1SchedStatus *idiom1_sched_status_;
+  Idiom2SchedStatus *idiom2_sched_status_;
+  Idiom3SchedStatus *idiom3_sched_status_;
+  Idiom4SchedStatus *idiom4_sched_status_;
+  Idiom5SchedStatus *idiom5_sched_status_;
+  bool volatile test_success_;
+  bool volatile watching_; // whether in a watch state of iroot_
+  // the time delay state of IdiomXCheckGiveup (indexed by event)
+  unsigned long giveup_last_state_[SCHED_SLOT_MAX_GIVEUPS];
+  thread_id_t giveup_last_thd_[SCHED_SLOT_MAX_GIVEUPS];
+  int giveup_time_delayed_each_[SCHED_SLOT_MAX_GIVEUPS];
+  int giveup_time_delayed_total_;
+
+  friend class SchedulerCommon;
+
+  DISALLOW_COPY_CONSTRUCTORS(SchedSlot);
+};
+
+typedef std::vector<SchedSlot *> SchedSlotVec;
+
 // The controller for the idiom driven active scheduler.
 class SchedulerCommon : public ExecutionControl {
  public:
@@ -426,14 +463,25 @@ class SchedulerCommon : public ExecutionControl {
 
   // virtual functions to be overrided
   virtual void Choose();
-  virtual void TestSuccess() {}
-  virtual void TestFail() {}
+  virtual void TestSuccess(iRoot *iroot) {}
+  virtual void TestFail(iRoot *iroot) {}
   virtual bool UseDecreasingPriorities();
   virtual bool YieldWithDelay();
 
+  // iRoot slots
+  void CreateSlot(iRoot *iroot);
+  SchedSlot *CurrSlot() { return tls_curr_slot_[PIN_ThreadId()]; }
+  void SetCurrSlot(SchedSlot *slot) { tls_curr_slot_[PIN_ThreadId()] = slot; }
+  iRoot *CurriRoot() { return CurrSlot()->iroot_; }
+  // the first chosen iroot decides the priorities of new threads
+  iRoot *PrimaryiRoot() { return slots_.front()->iroot_; }
+  bool HasMem();
+  bool HasSync();
+  void UpdateWatching();
+
   // instrument iRoots
   void InstrumentMemiRootEvent(TRACE trace);
-  void InstrumentMemiRootEvent(TRACE trace, UINT32 idx);
+  void InstrumentMemiRootEvent(TRACE trace, SchedSlot *slot, UINT32 idx);
   void ReplacePthreadMutexWrappers(IMG img);
   void CheckiRootBeforeMutexLock(Inst *inst, address_t addr);
   void CheckiRootAfterMutexLock(Inst *inst, address_t addr);
@@ -443,21 +491,31 @@ class SchedulerCommon : public ExecutionControl {
   // instrument to watch memeory accesses and maintain inst count
   void InstrumentWatchMem(TRACE trace);
   void InstrumentWatchInstCount(TRACE trace);
-  void Idiom1InstrumentWatchMem(TRACE trace);
-  void Idiom1InstrumentWatchInstCount(TRACE trace);
-  void Idiom2InstrumentWatchMem(TRACE trace);
-  void Idiom2InstrumentWatchInstCount(TRACE trace);
-  void Idiom3InstrumentWatchMem(TRACE trace);
-  void Idiom3InstrumentWatchInstCount(TRACE trace);
-  void Idiom4InstrumentWatchMem(TRACE trace);
-  void Idiom4InstrumentWatchInstCount(TRACE trace);
-  void Idiom5InstrumentWatchMem(TRACE trace);
-  void Idiom5InstrumentWatchInstCount(TRACE trace);
+  bool Idiom1Watching(unsigned long state);
+  bool Idiom2Watching(unsigned long state);
+  bool Idiom3Watching(unsigned long state);
+  bool Idiom4Watching(unsigned long state);
+  bool Idiom5Watching(unsigned long state);
   void __InstrumentWatchInstCount(TRACE trace);
   void __InstrumentWatchMem(TRACE trace, bool cand);
   bool ContainCandidates(TRACE trace);
-  bool IsCandidate(TRACE trace, INS ins);
-  void FlushWatch();
+  SchedSlot *FindCandidateOwner(TRACE trace, INS ins);
+
+  // The offsets of the events of the iroots under test in an image. This
+  // is built once for each loaded image so that checking whether an
+  // instruction is a candidate only needs a hash probe.
+  typedef std::tr1::unordered_set<ADDRINT> OffsetSet;
+  typedef std::tr1::unordered_map<ADDRINT, SchedSlot *> OffsetMap;
+  typedef struct {
+    ADDRINT low_addr; // the load address of the image
+    OffsetMap offset_map; // the offsets of all the events (to their slots)
+    OffsetSet mem_offset_set; // the offsets of the memory events
+    ADDRINT mem_start; // the address range of the memory events
+    ADDRINT mem_end;
+  } CandidateIndex;
+  typedef std::tr1::unordered_map<UINT32, CandidateIndex *> CandidateIndexMap;
+
+  CandidateIndex *GetCandidateIndex(IMG img);
 
   // utility functions
   void LockSchedStatus() { sched_status_lock_->Lock(); }
@@ -502,10 +560,10 @@ class SchedulerCommon : public ExecutionControl {
   void HandleAfteriRootMutexUnlock(UINT32 idx, address_t addr);
   void HandleWatchMutexLock(address_t addr);
   void HandleWatchMutexUnlock(address_t addr);
-  void HandleWatchMemRead(Inst *inst, address_t addr, size_t size,
-                          bool cand);
-  void HandleWatchMemWrite(Inst *inst, address_t addr, size_t size,
-                           bool cand);
+  void HandleWatchMemRead(SchedSlot *owner, Inst *inst, address_t addr,
+                          size_t size, bool cand);
+  void HandleWatchMemWrite(SchedSlot *owner, Inst *inst, address_t addr,
+                           size_t size, bool cand);
   void HandleWatchInstCount(timestamp_t c);
   void HandleSchedYield();
 
@@ -527,7 +585,6 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom1WatchMemRead(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom1WatchMemWrite(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom1SchedYield();
-  void Idiom1CheckFlush();
   bool Idiom1CheckGiveup(int idx);
   void Idiom1SetState(unsigned long s);
   void Idiom1ClearDelaySet(DelaySet *copy);
@@ -553,7 +610,6 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom2WatchMutexUnlock(address_t addr);
   void Idiom2WatchMemRead(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom2WatchMemWrite(Inst *inst, address_t addr, size_t size, bool cand);
-  void Idiom2CheckFlush();
   bool Idiom2CheckGiveup(int idx);
   void Idiom2SetState(unsigned long s);
   void Idiom2ClearDelaySet(DelaySet *copy);
@@ -581,7 +637,6 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom3WatchMutexUnlock(address_t addr);
   void Idiom3WatchMemRead(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom3WatchMemWrite(Inst *inst, address_t addr, size_t size, bool cand);
-  void Idiom3CheckFlush();
   bool Idiom3CheckGiveup(int idx);
   void Idiom3SetState(unsigned long s);
   void Idiom3ClearDelaySet(DelaySet *copy);
@@ -609,7 +664,6 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom4WatchMutexUnlock(address_t addr);
   void Idiom4WatchMemRead(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom4WatchMemWrite(Inst *inst, address_t addr, size_t size, bool cand);
-  void Idiom4CheckFlush();
   bool Idiom4CheckGiveup(int idx);
   void Idiom4SetState(unsigned long s);
   void Idiom4ClearDelaySet(DelaySet *copy);
@@ -640,7 +694,6 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom5WatchMutexUnlock(address_t addr);
   void Idiom5WatchMemRead(Inst *inst, address_t addr, size_t size, bool cand);
   void Idiom5WatchMemWrite(Inst *inst, address_t addr, size_t size, bool cand);
-  void Idiom5CheckFlush();
   bool Idiom5CheckGiveup(int idx);
   void Idiom5SetState(unsigned long s);
   void Idiom5ClearDelaySet(DelaySet *copy);
@@ -649,13 +702,16 @@ class SchedulerCommon : public ExecutionControl {
   void Idiom5ClearRecordedAccess(int idx);
   bool Idiom5Recorded(int idx, address_t addr, size_t size);
 
-  static void __BeforeiRootMemRead(UINT32 idx, ADDRINT addr, UINT32 size);
-  static void __BeforeiRootMemWrite(UINT32 idx, ADDRINT addr, UINT32 size);
-  static void __AfteriRootMem(UINT32 idx);
-  static void __WatchMemRead(Inst *inst, ADDRINT addr, UINT32 size,
-                             BOOL cand);
-  static void __WatchMemWrite(Inst *inst, ADDRINT addr, UINT32 size,
-                              BOOL cand);
+  static void __BeforeiRootMemRead(SchedSlot *slot, UINT32 idx, ADDRINT addr,
+                                   UINT32 size);
+  static void __BeforeiRootMemWrite(SchedSlot *slot, UINT32 idx, ADDRINT addr,
+                                    UINT32 size);
+  static void __AfteriRootMem(SchedSlot *slot, UINT32 idx);
+  static void __WatchMemRead(SchedSlot *owner, Inst *inst, ADDRINT addr,
+                             UINT32 size, BOOL cand);
+  static void __WatchMemWrite(SchedSlot *owner, Inst *inst, ADDRINT addr,
+                              UINT32 size, BOOL cand);
+  static ADDRINT __Watching(BOOL cand);
   static void __WatchInstCount(UINT32 c);
 
   iRootDB *iroot_db_;
@@ -670,19 +726,27 @@ class SchedulerCommon : public ExecutionControl {
   int new_thread_priorities_cursor_;
   address_t unit_size_;
   timestamp_t vw_;
-  iRoot *curr_iroot_;
-  Idiom1SchedStatus *idiom1_sched_status_;
-  Idiom2SchedStatus *idiom2_sched_status_;
-  Idiom3SchedStatus *idiom3_sched_status_;
-  Idiom4SchedStatus *idiom4_sched_status_;
-  Idiom5SchedStatus *idiom5_sched_status_;
+  // knobs used after setup
+  BoolKnobHandle strict_;
+  BoolKnobHandle ordered_new_thread_prio_;
+  BoolKnobHandle yield_with_delay_;
+  IntKnobHandle yield_delay_unit_;
+  IntKnobHandle yield_delay_min_each_;
+  IntKnobHandle yield_delay_max_total_;
+  IntKnobHandle target_iroot_;
+  IntKnobHandle cpu_;
+  StrKnobHandle test_history_;
+  StrKnobHandle iroot_out_;
+  SchedSlotVec slots_; // the iroots under test in this execution
+  SchedSlot *tls_curr_slot_[PIN_MAX_THREADS]; // the slot being handled
   Mutex *sched_status_lock_;
   Mutex *misc_lock_;
   std::map<thread_id_t, int> priority_map_;
   std::map<thread_id_t, int> ori_priority_map_;
   std::map<thread_id_t, OS_THREAD_ID> thd_id_os_tid_map_;
   bool volatile start_schedule_; // start scheduling when 2 threads are started
-  bool volatile test_success_;
+  bool volatile watching_; // whether any slot is in a watch state
+  CandidateIndexMap cand_index_map_; // indexed by IMG_Id (0 if invalid)
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(SchedulerCommon);
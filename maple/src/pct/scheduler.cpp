@@ -20,11 +20,13 @@
 #include "pct/scheduler.hpp"
 
 #include <errno.h>
+#include <linux/futex.h>
 #include <sched.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
 
 #include <algorithm>
+#include <climits>
 
 namespace pct {
 
@@ -37,8 +39,20 @@ Scheduler::Scheduler()
       total_inst_count_(0),
       total_num_threads_(0),
       curr_num_threads_(0),
-      start_inst_count_(false) {
-  // empty
+      start_inst_count_(false),
+      random_seed_(0),
+      user_sched_(false),
+      user_wake_spins_(0),
+      user_holder_(INVALID_THREADID),
+      user_top_priority_(INT_MIN),
+      user_outside_count_(0) {
+  for (UINT32 i = 0; i < PIN_MAX_THREADS; i++) {
+    tls_user_priority_[i] = 0;
+    tls_user_sem_[i] = NULL;
+    tls_user_wait_[i] = false;
+    tls_user_outside_[i] = false;
+    tls_user_outside_count_[i] = 0;
+  }
 }
 
 Scheduler::~Scheduler() {
@@ -57,19 +71,31 @@ void Scheduler::HandlePreSetup() {
   knob_->RegisterInt("depth", "the target bug depth", "3");
   knob_->RegisterBool("count_mem", "whether use the number of memory accesses as thread counter", "1");
   knob_->RegisterStr("pct_history", "the pct history file path", "pct.histo");
+  knob_->RegisterBool("user_sched", "whether schedule threads in user space using per thread semaphores (no realtime priorities needed). threads in blocking syscalls (read, poll, ...) release the token and rejoin in the order the kernel returns them, so such schedules are not fully determined by the random seed", "0");
+  knob_->RegisterInt("user_wake_spins", "the max number of sched_yield calls to wait for the threads woken by a futex to rejoin (user_sched only)", "10000");
+  knob_->RegisterInt("random_seed", "the random seed (0 means using current time)", "0");
 }
 
 void Scheduler::HandlePostSetup() {
   ExecutionControl::HandlePostSetup();
 
+  user_sched_ = knob_->ValueBool("user_sched");
+  user_wake_spins_ = knob_->ValueInt("user_wake_spins");
+  knob_->Bind("strict", &strict_);
+  knob_->Bind("count_mem", &count_mem_);
+  knob_->Bind("lowest_realtime_priority", &lowest_realtime_priority_);
+  knob_->Bind("highest_realtime_priority", &highest_realtime_priority_);
+  knob_->Bind("cpu", &cpu_);
+  knob_->Bind("pct_history", &pct_history_);
+
   // set analysis desc
-  if (knob_->ValueBool("strict")) {
+  if (strict_.Value() || user_sched_) {
     desc_.SetHookSyscall();
   }
 
   // load pct history
   history_ = new History;
-  history_->Load(knob_->ValueStr("pct_history"));
+  history_->Load(pct_history_.Value());
 
   // setup depth
   if (history_->Empty())
@@ -83,7 +109,7 @@ void Scheduler::HandlePostSetup() {
 void Scheduler::HandlePostInstrumentTrace(TRACE trace) {
   ExecutionControl::HandlePostInstrumentTrace(trace);
 
-  if (knob_->ValueBool("count_mem")) {
+  if (count_mem_.Value()) {
     for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
       for (INS ins = BBL_InsHead(bbl); INS_Valid(ins); ins = INS_Next(ins)) {
         if (INS_IsMemoryRead(ins) || INS_IsMemoryWrite(ins)) {
@@ -91,6 +117,7 @@ void Scheduler::HandlePostInstrumentTrace(TRACE trace) {
             continue; // skip stack accesses
 
           INS_InsertCall(ins, IPOINT_BEFORE, AFUNPTR(__PriorityChange),
+                         IARG_THREAD_ID,
                          IARG_UINT32, 1,
                          IARG_END);
         }
@@ -99,6 +126,7 @@ void Scheduler::HandlePostInstrumentTrace(TRACE trace) {
   } else {
     for (BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
       BBL_InsertCall(bbl, IPOINT_BEFORE, AFUNPTR(__PriorityChange),
+                     IARG_THREAD_ID,
                      IARG_UINT32, BBL_NumIns(bbl),
                      IARG_END);
     }
@@ -112,17 +140,53 @@ void Scheduler::HandleSyscallEntry(THREADID tid, CONTEXT *ctxt,
   int syscall_num = tls_syscall_num_[tid];
   switch (syscall_num) {
     case SYS_sched_yield:
-      if (knob_->ValueBool("strict"))
-        SetStrictPriority(knob_->ValueInt("lowest_realtime_priority"));
+      if (user_sched_)
+        SetUserPriority(lowest_realtime_priority_.Value());
+      else if (strict_.Value())
+        SetStrictPriority(lowest_realtime_priority_.Value());
       break;
     default:
       break;
   }
+
+  if (user_sched_) {
+    if (IsBlockingSyscall(syscall_num, ctxt, std)) {
+      UserRelease(tid);
+    } else if (syscall_num == SYS_futex) {
+      // remember how many threads are blocked before a possible wake
+      tls_user_outside_count_[tid] = user_outside_count_;
+    }
+  }
+}
+
+void Scheduler::HandleSyscallExit(THREADID tid, CONTEXT *ctxt,
+                                  SYSCALL_STANDARD std) {
+  ExecutionControl::HandleSyscallExit(tid, ctxt, std);
+
+  if (!user_sched_)
+    return;
+
+  if (tls_user_outside_[tid]) {
+    // back from a blocking syscall, wait for the token again
+    LockKernel();
+    tls_user_outside_[tid] = false;
+    user_outside_count_--;
+    user_waiting_.insert(tid);
+    tls_user_wait_[tid] = true;
+    UserUpdateTop();
+    UserDispatch();
+    UnlockKernel();
+    UserWaitToken(tid);
+  } else if (tls_syscall_num_[tid] == SYS_futex) {
+    int num_woken = (int)PIN_GetSyscallReturn(ctxt, std);
+    if (num_woken > 0)
+      UserWaitWoken(tid, num_woken);
+  }
 }
 
 void Scheduler::HandleProgramExit() {
-  history_->Update(total_inst_count_, total_num_threads_);
-  history_->Save(knob_->ValueStr("pct_history"));
+  history_->Update(total_inst_count_, total_num_threads_, random_seed_);
+  history_->Save(pct_history_.Value());
 
   ExecutionControl::HandleProgramExit();
 }
@@ -138,11 +202,25 @@ void Scheduler::HandleThreadStart() {
     SetPriority(priority);
   } else {
     // main thread
-    SetAffinity(); // force all the threads to be executed on one processor
+    if (!user_sched_)
+      SetAffinity(); // force all the threads to be executed on one processor
     int priority = NextNewThreadPriority();
     SetPriority(priority);
   }
 
+  if (user_sched_) {
+    // join the waiting set before the parent returns from pthread_create,
+    // the new thread blocks for the token at its first counting point
+    THREADID tid = PIN_ThreadId();
+    tls_user_sem_[tid] = CreateSemaphore(0);
+    tls_user_wait_[tid] = true;
+    LockKernel();
+    user_waiting_.insert(tid);
+    UserUpdateTop();
+    UserDispatch();
+    UnlockKernel();
+  }
+
   ExecutionControl::HandleThreadStart();
 }
 
@@ -150,10 +228,31 @@ void Scheduler::HandleThreadExit() {
   if (ATOMIC_SUB_AND_FETCH(&curr_num_threads_, 1) <= 1)
     start_inst_count_ = false;
 
+  if (user_sched_) {
+    THREADID tid = PIN_ThreadId();
+    if (!tls_user_outside_[tid])
+      UserWaitToken(tid);
+    LockKernel();
+    if (tls_user_outside_[tid]) {
+      tls_user_outside_[tid] = false;
+      user_outside_count_--;
+    } else {
+      DEBUG_ASSERT(user_holder_ == tid);
+      user_holder_ = INVALID_THREADID;
+    }
+    UserDispatch();
+    UnlockKernel();
+    delete tls_user_sem_[tid];
+    tls_user_sem_[tid] = NULL;
+  }
+
   ExecutionControl::HandleThreadExit();
 }
 
-void Scheduler::HandlePriorityChange(UINT32 c) {
+void Scheduler::HandlePriorityChange(THREADID tid, UINT32 c) {
+  if (user_sched_)
+    UserWaitToken(tid);
+
   if (start_inst_count_) {
     unsigned long k = ATOMIC_ADD_AND_FETCH(&total_inst_count_, c);
     if (NeedPriorityChange(k)) {
@@ -162,6 +261,9 @@ void Scheduler::HandlePriorityChange(UINT32 c) {
       SetPriority(priority);
     }
   }
+
+  if (user_sched_)
+    UserReschedule(tid);
 }
 
 bool Scheduler::NeedPriorityChange(unsigned long k) {
@@ -186,12 +288,16 @@ int Scheduler::NextChangePriority() {
 }
 
 void Scheduler::Randomize() {
-  srand(unsigned(time(NULL)));
+  random_seed_ = (unsigned int)knob_->ValueInt("random_seed");
+  if (random_seed_ == 0)
+    random_seed_ = (unsigned int)time(NULL);
+  srand(random_seed_);
 
-  if (knob_->ValueBool("strict")) {
+  // user space priorities use the realtime priority range
+  if (strict_.Value() || user_sched_) {
     // fill change priorities
-    int low = knob_->ValueInt("lowest_realtime_priority");
-    int high = knob_->ValueInt("highest_realtime_priority");
+    int low = lowest_realtime_priority_.Value();
+    int high = highest_realtime_priority_.Value();
     for (int i = depth_ - 2; i >= 0; i--) {
       change_priorities_.push_back(low + i);
     }
@@ -228,7 +334,9 @@ void Scheduler::Randomize() {
 
 void Scheduler::SetPriority(int priority) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set priority = %d\n", PIN_ThreadUid(), priority);
-  if (knob_->ValueBool("strict")) {
+  if (user_sched_) {
+    SetUserPriority(priority);
+  } else if (strict_.Value()) {
     SetStrictPriority(priority);
   } else {
     SetRelaxPriority(priority);
@@ -252,7 +360,7 @@ void Scheduler::SetRelaxPriority(int priority) {
 }
 
 void Scheduler::SetAffinity() {
-  int cpu = knob_->ValueInt("cpu");
+  int cpu = cpu_.Value();
   if (cpu < 0 || cpu >= sysconf(_SC_NPROCESSORS_ONLN))
     cpu = 0;
 
@@ -265,8 +373,139 @@ void Scheduler::SetAffinity() {
   }
 }
 
-void Scheduler::__PriorityChange(UINT32 c) {
-  ((Scheduler *)ctrl_)->HandlePriorityChange(c);
+bool Scheduler::IsBlockingSyscall(int syscall_num, CONTEXT *ctxt,
+                                  SYSCALL_STANDARD std) {
+  switch (syscall_num) {
+    case SYS_futex:
+      {
+        int op = (int)PIN_GetSyscallArgument(ctxt, std, 1) & FUTEX_CMD_MASK;
+        return op == FUTEX_WAIT ||
+               op == FUTEX_WAIT_BITSET ||
+               op == FUTEX_LOCK_PI;
+      }
+    case SYS_sched_yield:
+    case SYS_nanosleep:
+    case SYS_clock_nanosleep:
+    case SYS_pause:
+    case SYS_rt_sigsuspend:
+    case SYS_wait4:
+    case SYS_read:
+    case SYS_readv:
+    case SYS_poll:
+    case SYS_select:
+    case SYS_epoll_wait:
+#ifdef SYS_accept
+    case SYS_accept:
+    case SYS_connect:
+    case SYS_recvfrom:
+    case SYS_recvmsg:
+#endif
+#ifdef SYS_socketcall
+    case SYS_socketcall:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+void Scheduler::SetUserPriority(int priority) {
+  // only read by other threads when this thread is waiting
+  tls_user_priority_[PIN_ThreadId()] = priority;
+}
+
+void Scheduler::UserWaitToken(THREADID tid) {
+  if (!tls_user_wait_[tid])
+    return;
+
+  while (true) {
+    int res = tls_user_sem_[tid]->Wait();
+    if (res == 0) break;
+    if (errno == EINTR) continue;
+    Abort("UserWaitToken: semaphore wait returns error\n");
+  }
+  tls_user_wait_[tid] = false;
+  DEBUG_ASSERT(user_holder_ == tid);
+}
+
+void Scheduler::UserReschedule(THREADID tid) {
+  // fast path: no waiting thread has a higher priority
+  if (user_top_priority_ <= tls_user_priority_[tid])
+    return;
+
+  LockKernel();
+  if (user_top_priority_ > tls_user_priority_[tid]) {
+    DEBUG_ASSERT(user_holder_ == tid);
+    user_holder_ = INVALID_THREADID;
+    user_waiting_.insert(tid);
+    tls_user_wait_[tid] = true;
+    UserUpdateTop();
+    UserDispatch();
+  }
+  UnlockKernel();
+  UserWaitToken(tid);
+}
+
+void Scheduler::UserRelease(THREADID tid) {
+  UserWaitToken(tid);
+
+  LockKernel();
+  DEBUG_ASSERT(user_holder_ == tid);
+  user_holder_ = INVALID_THREADID;
+  tls_user_outside_[tid] = true;
+  user_outside_count_++;
+  UserDispatch();
+  UnlockKernel();
+}
+
+void Scheduler::UserDispatch() {
+  // assume the kernel lock is held
+  if (user_holder_ != INVALID_THREADID || user_waiting_.empty())
+    return;
+
+  // ties are broken by thread id so that the choice is deterministic
+  std::set<THREADID>::iterator next = user_waiting_.begin();
+  for (std::set<THREADID>::iterator it = user_waiting_.begin();
+       it != user_waiting_.end(); ++it) {
+    if (tls_user_priority_[*it] > tls_user_priority_[*next])
+      next = it;
+  }
+  user_holder_ = *next;
+  user_waiting_.erase(next);
+  UserUpdateTop();
+
+  while (true) {
+    int res = tls_user_sem_[user_holder_]->Post();
+    if (res == 0) break;
+    if (errno == EINTR) continue;
+    Abort("UserDispatch: semaphore post returns error\n");
+  }
+}
+
+void Scheduler::UserUpdateTop() {
+  // assume the kernel lock is held
+  int top = INT_MIN;
+  for (std::set<THREADID>::iterator it = user_waiting_.begin();
+       it != user_waiting_.end(); ++it) {
+    top = std::max(top, tls_user_priority_[*it]);
+  }
+  user_top_priority_ = top;
+}
+
+void Scheduler::UserWaitWoken(THREADID tid, int num_woken) {
+  // the woken threads have to rejoin the waiting set before the token
+  // holder makes its next decision, otherwise the schedule depends on
+  // how fast the kernel wakes them up. since no thread can enter a
+  // blocking syscall without the token, the outside count only drops.
+  // the bound (user_wake_spins) avoids hanging on wakes that are not seen
+  // (e.g. requeue).
+  int target = tls_user_outside_count_[tid] - num_woken;
+  for (int i = 0; i < user_wake_spins_ && user_outside_count_ > target; i++)
+    sched_yield();
+}
+
+void Scheduler::__PriorityChange(THREADID tid, UINT32 c) {
+  ((Scheduler *)ctrl_)->HandlePriorityChange(tid, c);
 }
 
 } // namespace pct
@@ -19,6 +19,7 @@
 #ifndef PCT_SCHEDULER_HPP_
 #define PCT_SCHEDULER_HPP_
 
+#include <set>
 #include <vector>
 
 #include "core/basictypes.h"
@@ -41,10 +42,12 @@ class Scheduler : public ExecutionControl {
   virtual void HandlePostInstrumentTrace(TRACE trace);
   virtual void HandleSyscallEntry(THREADID tid, CONTEXT *ctxt,
                                   SYSCALL_STANDARD std);
+  virtual void HandleSyscallExit(THREADID tid, CONTEXT *ctxt,
+                                 SYSCALL_STANDARD std);
   virtual void HandleProgramExit();
   virtual void HandleThreadStart();
   virtual void HandleThreadExit();
-  void HandlePriorityChange(UINT32 c);
+  void HandlePriorityChange(THREADID tid, UINT32 c);
 
   bool NeedPriorityChange(unsigned long k);
   int NextNewThreadPriority();
@@ -55,9 +58,26 @@ class Scheduler : public ExecutionControl {
   void SetRelaxPriority(int priority);
   void SetAffinity();
 
+  // user-space scheduling (only the thread holding the token runs)
+  bool IsBlockingSyscall(int syscall_num, CONTEXT *ctxt,
+                         SYSCALL_STANDARD std);
+  void SetUserPriority(int priority);
+  void UserWaitToken(THREADID tid);
+  void UserReschedule(THREADID tid);
+  void UserRelease(THREADID tid);
+  void UserDispatch();
+  void UserUpdateTop();
+  void UserWaitWoken(THREADID tid, int num_woken);
+
   History *history_;
   int depth_;
-  bool count_mem_;
+  // knobs used after setup
+  BoolKnobHandle strict_;
+  BoolKnobHandle count_mem_;
+  IntKnobHandle lowest_realtime_priority_;
+  IntKnobHandle highest_realtime_priority_;
+  IntKnobHandle cpu_;
+  StrKnobHandle pct_history_;
   std::vector<unsigned long> priority_change_points_;
   std::vector<int> new_thread_priorities_;
   std::vector<int> change_priorities_;
@@ -69,9 +89,21 @@ class Scheduler : public ExecutionControl {
   int curr_num_threads_;
   volatile bool start_inst_count_; // start counting inst when at least
                                    // 2 threads are started
+  unsigned int random_seed_;
+  bool user_sched_;
+  int user_wake_spins_; // max yields to wait for woken threads to rejoin
+  THREADID user_holder_; // the thread holding the token
+  std::set<THREADID> user_waiting_; // threads waiting for the token
+  volatile int user_top_priority_; // highest priority in user_waiting_
+  volatile int user_outside_count_; // number of threads in blocking syscalls
+  int tls_user_priority_[PIN_MAX_THREADS];
+  Semaphore *tls_user_sem_[PIN_MAX_THREADS];
+  bool tls_user_wait_[PIN_MAX_THREADS]; // need to wait for the token
+  bool tls_user_outside_[PIN_MAX_THREADS]; // released in a blocking syscall
+  int tls_user_outside_count_[PIN_MAX_THREADS]; // saved at futex wake entry
 
  private:
-  static void __PriorityChange(UINT32 c);
+  static void __PriorityChange(THREADID tid, UINT32 c);
   static void __Main();
   static void __ThreadMain();
 
@@ -412,28 +412,18 @@ void Detector::ReportRace(Meta *meta, thread_id_t t0, Inst *i0,
   {
     return;
   }
-  race_db_->CreateRace(meta->addr, t0, i0, p0, t1, i1, p1, false);
+  Race *race = race_db_->CreateRace(meta->addr, t0, i0, p0, t1, i1, p1, false);
   assert(p0 && p1);
-  std::stringstream ss;
-  ss << std::hex;
-  ss << "Race detected:\n";
-  ss << "\n";
-  ss << "Thread " << (unsigned)t0 << "\n";
-  ss << i0->DebugInfoStr() << "\n";
-  ss << "Image base: " << i0->image()->name() << ", offset: " << i0->offset() << "\n";
-  ss << (p0 == RACE_EVENT_READ ? "read" : "write") << "\n";
-  ss << "\n";
-  ss << "Thread " << (unsigned)t1 << "(current thread) \n";
-  ss << i1->DebugInfoStr() << "\n";
-  ss << "Image base: " << i1->image()->name() << ", offset: " << i1->offset() << "\n";
-  ss << (p1 == RACE_EVENT_READ ? "read" : "write") << "\n";
-  ss << "\n";
+  // Only record the instructions and the call stack here. The report is
+  // symbolized offline by the race symbolizer, after the run.
   if(callstack_info_)
   {
-    CallStack *cs = callstack_info_->GetCallStack(t1);
-    ss << cs->ToString();
+    CallStack *cs = exe_ ? exe_->GetCallStack(t1)
+                         : callstack_info_->GetCallStack(t1);
+    race->set_callstack(cs->signature(), cs->frames());
   }
-  std::cout << ss.str() << std::endl;
+  std::cout << "Race detected: static race " << race->static_race()->id()
+            << " at 0x" << std::hex << meta->addr << std::dec << std::endl;
 //  if(exe_) {
 //    exe_->ProgramExit(1, 0);
 //    exit(1);
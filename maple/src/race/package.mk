@@ -12,12 +12,17 @@ srcs += \
   race/profiler.cpp \
   race/profiler_main.cpp \
   race/race.cc \
-  race/race.pb.cc
+  race/race.pb.cc \
+  race/symbolizer.cc \
+  race/symbolizer_main.cc
 
 pintools += \
   race_pct_profiler.so \
   race_profiler.so
 
+cmdtools += \
+  race_symbolizer
+
 race_profiler_objs := \
   race/detector.o \
   race/djit.o \
@@ -46,3 +51,10 @@ race_objs := \
   race/race.o \
   race/race.pb.o
 
+
+race_symbolizer_objs := \
+  race/race.o \
+  race/race.pb.o \
+  race/symbolizer.o \
+  race/symbolizer_main.o \
+  $(core_cmd_objs)
@@ -35,6 +35,9 @@ void PctProfiler::HandlePreSetup() {
 void PctProfiler::HandlePostSetup() {
   pct::Scheduler::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("ignore_lib", &ignore_lib_);
+
   // load race db
   race_db_ = new RaceDB(CreateMutex());
   race_db_->Load(knob_->ValueStr("race_in"), sinfo_);
@@ -57,7 +60,7 @@ bool PctProfiler::HandleIgnoreMemAccess(IMG img) {
   DEBUG_ASSERT(image);
   if (image->IsPthread())
     return true;
-  if (knob_->ValueBool("ignore_lib")) {
+  if (ignore_lib_.Value()) {
     if (image->IsCommonLib())
       return true;
   }
@@ -40,6 +40,8 @@ class PctProfiler : public pct::Scheduler {
 
   RaceDB *race_db_;
   Djit *djit_analyzer_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(PctProfiler);
@@ -39,6 +39,8 @@ class Profiler : public ExecutionControl {
 
   RaceDB *race_db_;
   Djit *djit_analyzer_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(Profiler);
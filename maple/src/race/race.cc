@@ -151,6 +151,12 @@ void RaceDB::Load(const std::string &db_name, StaticInfo *sinfo) {
     }
     r->static_race_ = FindStaticRace(r_proto->static_id(), false);
     DEBUG_ASSERT(r->static_race_);
+    r->callstack_signature_ = r_proto->callstack_signature();
+    for (int j = 0; j < r_proto->callstack_inst_id_size(); j++) {
+      Inst *inst = sinfo->FindInst(r_proto->callstack_inst_id(j));
+      DEBUG_ASSERT(inst);
+      r->callstack_.push_back(inst);
+    }
     race_vec_.push_back(r);
     if (curr_exec_id_ < r->exec_id_)
       curr_exec_id_ = r->exec_id_;
@@ -207,6 +213,13 @@ void RaceDB::Save(const std::string &db_name, StaticInfo *sinfo) {
       e_proto->set_static_id(e->static_event_->id_);
     }
     r_proto->set_static_id(r->static_race_->id_);
+    if (!r->callstack_.empty()) {
+      r_proto->set_callstack_signature(r->callstack_signature_);
+      for (std::vector<Inst *>::iterator cit = r->callstack_.begin();
+           cit != r->callstack_.end(); ++cit) {
+        r_proto->add_callstack_inst_id((*cit)->id());
+      }
+    }
   }
   // save racy insts
   for (RacyInstSet::iterator it = racy_inst_set_.begin();
@@ -116,15 +116,29 @@ class Race {
 
   int exec_id() { return exec_id_; }
   address_t addr() { return addr_; }
+  RaceEvent::Vec &event_vec() { return event_vec_; }
+  StaticRace *static_race() { return static_race_; }
+  uint64 callstack_signature() { return callstack_signature_; }
+  std::vector<Inst *> &callstack() { return callstack_; }
+  void set_callstack(uint64 signature, const std::vector<Inst *> &callstack) {
+    callstack_signature_ = signature;
+    callstack_ = callstack;
+  }
 
  protected:
-  Race() : exec_id_(-1), addr_(INVALID_ADDRESS), static_race_(NULL) {}
+  Race()
+      : exec_id_(-1),
+        addr_(INVALID_ADDRESS),
+        static_race_(NULL),
+        callstack_signature_(0) {}
   ~Race() {}
 
   int exec_id_;
   address_t addr_;
   RaceEvent::Vec event_vec_;
   StaticRace *static_race_;
+  uint64 callstack_signature_; // call stack of the current thread
+  std::vector<Inst *> callstack_; // from the outermost to the innermost
 
  private:
   friend class RaceDB;
@@ -145,6 +159,8 @@ class RaceDB {
   void Load(const std::string &db_name, StaticInfo *sinfo);
   void Save(const std::string &db_name, StaticInfo *sinfo);
 
+  Race::Vec &race_vec() { return race_vec_; }
+
  protected:
   typedef std::tr1::unordered_set<Inst *> RacyInstSet;
 
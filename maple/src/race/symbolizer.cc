@@ -0,0 +1,218 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: race/symbolizer.cc - Implement the command line tool that
+// symbolizes race reports offline.
+
+#include "race/symbolizer.h"
+
+#include <elf.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace race {
+
+// the maximum number of addresses passed to one addr2line command
+#define MAX_ADDR2LINE_BATCH 256
+
+Symbolizer::Symbolizer()
+    : race_db_(NULL) {
+  // empty
+}
+
+void Symbolizer::HandlePreSetup() {
+  OfflineTool::HandlePreSetup();
+
+  knob_->RegisterStr("race_in", "the input race database path", "race.db");
+  knob_->RegisterInt("exec_id", "only report races found in this execution (-1 for all executions)", "-1");
+}
+
+void Symbolizer::HandlePostSetup() {
+  OfflineTool::HandlePostSetup();
+
+  // load the race database
+  race_db_ = new RaceDB(CreateMutex());
+  race_db_->Load(knob_->ValueStr("race_in"), sinfo_);
+}
+
+void Symbolizer::HandleStart() {
+  OfflineTool::HandleStart();
+
+  int exec_id = knob_->ValueInt("exec_id");
+  Race::Vec &race_vec = race_db_->race_vec();
+
+  // collect all the instructions that need debug info, grouped by image
+  ImageInstMap inst_map;
+  for (Race::Vec::iterator it = race_vec.begin(); it != race_vec.end(); ++it) {
+    Race *race = *it;
+    if (exec_id >= 0 && race->exec_id() != exec_id)
+      continue;
+    RaceEvent::Vec &event_vec = race->event_vec();
+    for (RaceEvent::Vec::iterator eit = event_vec.begin();
+         eit != event_vec.end(); ++eit) {
+      CollectInst((*eit)->inst(), &inst_map);
+    }
+    std::vector<Inst *> &callstack = race->callstack();
+    for (std::vector<Inst *>::iterator cit = callstack.begin();
+         cit != callstack.end(); ++cit) {
+      CollectInst(*cit, &inst_map);
+    }
+  }
+
+  for (ImageInstMap::iterator it = inst_map.begin(); it != inst_map.end();
+       ++it) {
+    Symbolize(it->first, it->second);
+  }
+
+  for (Race::Vec::iterator it = race_vec.begin(); it != race_vec.end(); ++it) {
+    if (exec_id >= 0 && (*it)->exec_id() != exec_id)
+      continue;
+    Report(*it);
+  }
+}
+
+void Symbolizer::HandleExit() {
+  OfflineTool::HandleExit();
+  // the resolved debug info is cached in the static info database, which is
+  // saved by the base class
+}
+
+void Symbolizer::CollectInst(Inst *inst, ImageInstMap *inst_map) {
+  if (inst->HasDebugInfo())
+    return;
+  std::vector<Inst *> &inst_vec = (*inst_map)[inst->image()];
+  for (size_t i = 0; i < inst_vec.size(); i++) {
+    if (inst_vec[i] == inst)
+      return;
+  }
+  inst_vec.push_back(inst);
+}
+
+void Symbolizer::Symbolize(Image *image, std::vector<Inst *> &inst_vec) {
+  // instructions of images that cannot be found are left unresolved, and
+  // will be resolved in a later run if the image becomes available
+  address_t base = 0;
+  if (!LoadAddress(image->name(), &base))
+    return;
+
+  for (size_t start = 0; start < inst_vec.size();
+       start += MAX_ADDR2LINE_BATCH) {
+    size_t end = start + MAX_ADDR2LINE_BATCH;
+    if (end > inst_vec.size())
+      end = inst_vec.size();
+
+    std::stringstream cmd;
+    cmd << "addr2line -e '" << image->name() << "'" << std::hex;
+    for (size_t i = start; i < end; i++)
+      cmd << " 0x" << base + inst_vec[i]->offset();
+
+    FILE *output = popen(cmd.str().c_str(), "r");
+    if (!output)
+      return;
+    // addr2line prints exactly one line for each address
+    char line[2000];
+    for (size_t i = start; i < end; i++) {
+      if (!fgets(line, sizeof(line), output))
+        break;
+      std::string source_info(line);
+      std::string file_name("??");
+      int line_number = 0;
+      size_t colon_pos = source_info.rfind(':');
+      if (colon_pos != std::string::npos) {
+        file_name = source_info.substr(0, colon_pos);
+        line_number = atoi(source_info.c_str() + colon_pos + 1);
+      }
+      inst_vec[i]->SetDebugInfo(file_name, line_number, 0);
+    }
+    pclose(output);
+  }
+}
+
+// Compute the address at which the image is linked. Instruction offsets are
+// relative to the lowest loaded segment, which is 0 for shared objects and
+// PIE binaries, but not for executables linked at a fixed address.
+bool Symbolizer::LoadAddress(const std::string &file_name, address_t *base) {
+  std::ifstream in(file_name.c_str(), std::ios::in | std::ios::binary);
+  if (!in.good())
+    return false;
+
+  Elf64_Ehdr ehdr;
+  in.read((char *)&ehdr, sizeof(ehdr));
+  if (!in.good() || memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0)
+    return false;
+  *base = 0;
+  if (ehdr.e_ident[EI_CLASS] != ELFCLASS64 || ehdr.e_type != ET_EXEC)
+    return true;
+
+  bool found = false;
+  for (int i = 0; i < ehdr.e_phnum; i++) {
+    Elf64_Phdr phdr;
+    in.seekg(ehdr.e_phoff + i * ehdr.e_phentsize);
+    in.read((char *)&phdr, sizeof(phdr));
+    if (!in.good())
+      break;
+    if (phdr.p_type != PT_LOAD)
+      continue;
+    address_t vaddr = phdr.p_vaddr - phdr.p_offset;
+    if (!found || vaddr < *base) {
+      *base = vaddr;
+      found = true;
+    }
+  }
+  return true;
+}
+
+void Symbolizer::Report(Race *race) {
+  std::stringstream ss;
+  ss << "Race detected (exec " << std::dec << race->exec_id()
+     << ", static race " << race->static_race()->id() << ", addr 0x"
+     << std::hex << race->addr() << "):\n";
+  ss << "\n";
+  RaceEvent::Vec &event_vec = race->event_vec();
+  for (size_t i = 0; i < event_vec.size(); i++) {
+    RaceEvent *e = event_vec[i];
+    Inst *inst = e->inst();
+    ss << "Thread " << std::hex << e->thd_id();
+    if (i == event_vec.size() - 1)
+      ss << "(current thread)";
+    ss << "\n";
+    ss << (inst->HasDebugInfo() ? inst->DebugInfoStr() : "??:0") << "\n";
+    ss << "Image base: " << inst->image()->name() << ", offset: " << std::hex
+       << inst->offset() << "\n";
+    ss << (e->type() == RACE_EVENT_READ ? "read" : "write") << "\n";
+    ss << "\n";
+  }
+  std::vector<Inst *> &callstack = race->callstack();
+  if (!callstack.empty()) {
+    ss << "Call stack:\n";
+    for (std::vector<Inst *>::reverse_iterator it = callstack.rbegin();
+         it != callstack.rend(); ++it) {
+      Inst *inst = *it;
+      ss << "  " << inst->image()->ShortName() << " 0x" << std::hex
+         << inst->offset();
+      if (inst->HasDebugInfo())
+        ss << " (" << inst->DebugInfoStr() << ")";
+      ss << "\n";
+    }
+  }
+  std::cout << ss.str() << std::endl;
+}
+
+} // namespace race
@@ -0,0 +1,63 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: race/symbolizer.h - Define the command line tool that symbolizes
+// race reports offline.
+
+#ifndef RACE_SYMBOLIZER_H_
+#define RACE_SYMBOLIZER_H_
+
+#include <map>
+#include <vector>
+
+#include "core/basictypes.h"
+#include "core/knob.h"
+#include "core/offline_tool.h"
+#include "race/race.h"
+
+namespace race {
+
+// The race detectors only record instruction ids and call stacks at
+// runtime. This tool resolves the debug information of the recorded
+// instructions after the run (one addr2line invocation per image), caches
+// the results in the static info database and prints the full reports.
+class Symbolizer : public OfflineTool {
+ public:
+  Symbolizer();
+  virtual ~Symbolizer() {}
+
+ protected:
+  typedef std::map<Image *, std::vector<Inst *> > ImageInstMap;
+
+  virtual void HandlePreSetup();
+  virtual void HandlePostSetup();
+  virtual void HandleStart();
+  virtual void HandleExit();
+
+  void CollectInst(Inst *inst, ImageInstMap *inst_map);
+  void Symbolize(Image *image, std::vector<Inst *> &inst_vec);
+  bool LoadAddress(const std::string &file_name, address_t *base);
+  void Report(Race *race);
+
+  RaceDB *race_db_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(Symbolizer);
+};
+
+} // namespace race
+
+#endif
@@ -76,9 +76,14 @@ void Scheduler::HandlePreSetup() {
 void Scheduler::HandlePostSetup() {
   ExecutionControl::HandlePostSetup();
 
+  // bind knobs used after setup
+  knob_->Bind("strict", &strict_);
+  knob_->Bind("cpu", &cpu_);
+  knob_->Bind("rand_history", &rand_history_);
+
   // load rand history
   history_ = new History;
-  history_->Load(knob_->ValueStr("rand_history"));
+  history_->Load(rand_history_.Value());
 
   // set flags
   delay_ = knob_->ValueBool("delay");
@@ -106,7 +111,7 @@ void Scheduler::HandlePostInstrumentTrace(TRACE trace) {
 
 void Scheduler::HandleProgramExit() {
   history_->Update(total_inst_count_, total_num_threads_);
-  history_->Save(knob_->ValueStr("rand_history"));
+  history_->Save(rand_history_.Value());
 
   ExecutionControl::HandleProgramExit();
 }
@@ -187,7 +192,7 @@ void Scheduler::Randomize() {
   seed_random_number(unsigned(time(NULL)));
 
   if (!delay_) {
-    if (knob_->ValueBool("strict")) {
+    if (strict_.Value()) {
       int low = knob_->ValueInt("lowest_realtime_priority");
       int high = knob_->ValueInt("highest_realtime_priority");
       for (int prio = low; prio <= high; prio++) {
@@ -231,7 +236,7 @@ void Scheduler::Randomize() {
 void Scheduler::SetPriority(int priority) {
   DEBUG_FMT_PRINT_SAFE("[T%lx] set priority = %d\n",
                        PIN_ThreadUid(), priority);
-  if (knob_->ValueBool("strict")) {
+  if (strict_.Value()) {
     SetStrictPriority(priority);
   } else {
     SetRelaxPriority(priority);
@@ -253,7 +258,7 @@ void Scheduler::SetRelaxPriority(int priority) {
 }
 
 void Scheduler::SetAffinity() {
-  int cpu = knob_->ValueInt("cpu");
+  int cpu = cpu_.Value();
   if (cpu < 0 || cpu >= sysconf(_SC_NPROCESSORS_ONLN))
     cpu = 0;
 
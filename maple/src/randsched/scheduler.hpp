@@ -54,6 +54,10 @@ class Scheduler : public ExecutionControl {
   void SetAffinity();
 
   History *history_;
+  // knobs used after setup
+  BoolKnobHandle strict_;
+  IntKnobHandle cpu_;
+  StrKnobHandle rand_history_;
   bool delay_; // delay mode or not
   bool float_; // whether # of change points depends on execution length
   std::vector<int> prio_vec_;
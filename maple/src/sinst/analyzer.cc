@@ -19,21 +19,46 @@
 
 #include "sinst/analyzer.h"
 
+#include <cstring>
+#include <algorithm>
+
 #include "core/logging.h"
 
 namespace sinst {
 
+// each shadow page covers 2^SHADOW_PAGE_BITS bytes of the address space
+#define SHADOW_PAGE_BITS 16
+#define SHADOW_PAGE_SIZE ((address_t)1 << SHADOW_PAGE_BITS)
+#define SHADOW_PAGE_MASK (~(SHADOW_PAGE_SIZE - 1))
+
+// granule state flags
+#define STATE_TOUCHED    0x1
+#define STATE_HAS_WRITE  0x2
+#define STATE_MULTI_READ 0x4
+#define STATE_SHARED     0x8
+#define STATE_OVERFLOW   0x10 // has an entry in the overflow table
+#define STATE_OWNER(s)   ((uint32)((s) >> 32))
+#define STATE_MAKE(f,o)  ((State)(f) | ((State)(o) << 32))
+
 SharedInstAnalyzer::SharedInstAnalyzer()
     : internal_lock_(NULL),
       sinst_db_(NULL),
       unit_size_(4),
-      filter_(NULL) {
+      filter_(NULL),
+      last_page_(0),
+      last_page_granules_(NULL),
+      last_thd_id_(INVALID_THD_ID),
+      last_thd_idx_(0) {
   // do nothing
 }
 
 SharedInstAnalyzer::~SharedInstAnalyzer() {
   delete internal_lock_;
   delete filter_;
+  for (ShadowTable::iterator it = shadow_table_.begin();
+       it != shadow_table_.end(); ++it) {
+    delete [] it->second;
+  }
 }
 
 void SharedInstAnalyzer::Register() {
@@ -87,41 +112,35 @@ void SharedInstAnalyzer::BeforeMemRead(thread_id_t curr_thd_id,
   ScopedLock locker(internal_lock_);
   if (FilterAccess(addr))
     return;
+  uint32 thd_idx = GetThdIdx(curr_thd_id);
+  InstInfo *info = GetInstInfo(inst);
   // normalize accesses
   address_t start_addr = UNIT_DOWN_ALIGN(addr, unit_size_);
   address_t end_addr = UNIT_UP_ALIGN(addr + size, unit_size_);
   for (address_t iaddr = start_addr; iaddr < end_addr; iaddr += unit_size_) {
     // check shared for iaddr
-    Meta::Table::iterator mit = meta_table_.find(iaddr);
-    if (mit == meta_table_.end()) {
-      Meta &meta = meta_table_[iaddr];
-      meta.last_thd_id = curr_thd_id;
-      meta.inst_set.insert(inst);
+    Granule *granule = GetGranule(iaddr);
+    State s = granule->state;
+    if (!s) {
+      granule->state = STATE_MAKE(STATE_TOUCHED, thd_idx);
+      AccessPrivate(granule, iaddr, info);
+    } else if (s & STATE_SHARED) {
+      // granule is shared
+      AccessShared(info);
     } else {
-      // shared info exists
-      Meta &meta = mit->second;
-      if (meta.shared) {
-        // meta is shared
-        sinst_db_->SetShared(inst);
-      } else {
-        // meta is not currently shared
-        meta.inst_set.insert(inst);
-        if (curr_thd_id != meta.last_thd_id) {
-          if (meta.has_write) {
-            // mark as shared
-            meta.shared = true;
-            for (Meta::InstSet::iterator it = meta.inst_set.begin();
-                 it != meta.inst_set.end(); ++it) {
-              sinst_db_->SetShared(*it);
-            }
-            meta.inst_set.clear();
-          } else {
-            meta.multi_read = true;
-            meta.last_thd_id = curr_thd_id;
-          }
+      // granule is not currently shared
+      AccessPrivate(granule, iaddr, info);
+      if (thd_idx != STATE_OWNER(s)) {
+        if (s & STATE_HAS_WRITE) {
+          // mark as shared
+          SetGranuleShared(granule, iaddr, info);
+        } else {
+          // AccessPrivate may have changed the flags
+          granule->state = STATE_MAKE((granule->state & 0xffffffff) |
+                                      STATE_MULTI_READ, thd_idx);
         }
-      } // end of else meta.shared
-    } // end of else meta not exist
+      }
+    }
   } // end of for each iaddr
 }
 
@@ -131,36 +150,29 @@ void SharedInstAnalyzer::BeforeMemWrite(thread_id_t curr_thd_id,
   ScopedLock locker(internal_lock_);
   if (FilterAccess(addr))
     return;
+  uint32 thd_idx = GetThdIdx(curr_thd_id);
+  InstInfo *info = GetInstInfo(inst);
   // normalize accesses
   address_t start_addr = UNIT_DOWN_ALIGN(addr, unit_size_);
   address_t end_addr = UNIT_UP_ALIGN(addr + size, unit_size_);
   for (address_t iaddr = start_addr; iaddr < end_addr; iaddr += unit_size_) {
     // check shared for iaddr
-    Meta::Table::iterator mit = meta_table_.find(iaddr);
-    if (mit == meta_table_.end()) {
-      Meta &meta = meta_table_[iaddr];
-      meta.has_write = true;
-      meta.last_thd_id = curr_thd_id;
-      meta.inst_set.insert(inst);
+    Granule *granule = GetGranule(iaddr);
+    State s = granule->state;
+    if (!s) {
+      granule->state = STATE_MAKE(STATE_TOUCHED | STATE_HAS_WRITE, thd_idx);
+      AccessPrivate(granule, iaddr, info);
+    } else if (s & STATE_SHARED) {
+      // granule is shared
+      AccessShared(info);
     } else {
-      // shared info exists
-      Meta &meta = mit->second;
-      if (meta.shared) {
-        // meta is shared
-        sinst_db_->SetShared(inst);
+      // granule is not currently shared
+      AccessPrivate(granule, iaddr, info);
+      if (thd_idx != STATE_OWNER(s) || (s & STATE_MULTI_READ)) {
+        // mark as shared
+        SetGranuleShared(granule, iaddr, info);
       } else {
-        // meta is not currently shared
-        meta.has_write = true;
-        meta.inst_set.insert(inst);
-        if (curr_thd_id != meta.last_thd_id || meta.multi_read) {
-          // mark as shared
-          meta.shared = true;
-          for (Meta::InstSet::iterator it = meta.inst_set.begin();
-               it != meta.inst_set.end(); ++it) {
-            sinst_db_->SetShared(*it);
-          }
-          meta.inst_set.clear();
-        }
+        granule->state |= STATE_HAS_WRITE;
       }
     }
   }
@@ -217,12 +229,102 @@ void SharedInstAnalyzer::FreeAddrRegion(address_t addr) {
   address_t start_addr = UNIT_DOWN_ALIGN(addr, unit_size_);
   address_t end_addr = UNIT_UP_ALIGN(addr + size, unit_size_);
   for (address_t iaddr = start_addr; iaddr < end_addr; iaddr += unit_size_) {
-    Meta::Table::iterator it = meta_table_.find(iaddr);
-    if (it != meta_table_.end()) {
-      meta_table_.erase(it);
+    // do not create shadow pages for untouched regions
+    ShadowTable::iterator it = shadow_table_.find(iaddr & SHADOW_PAGE_MASK);
+    if (it != shadow_table_.end()) {
+      Granule *granule = &it->second[(iaddr & ~SHADOW_PAGE_MASK) / unit_size_];
+      if (granule->state & STATE_OVERFLOW)
+        overflow_table_.erase(iaddr);
+      granule->state = 0;
+      granule->inst = NULL;
     }
   }
 }
 
-} // namespace sinst
+SharedInstAnalyzer::Granule *SharedInstAnalyzer::GetGranule(address_t iaddr) {
+  address_t page = iaddr & SHADOW_PAGE_MASK;
+  if (!last_page_granules_ || page != last_page_) {
+    Granule *&page_granules = shadow_table_[page];
+    if (!page_granules) {
+      size_t num_granules = SHADOW_PAGE_SIZE / unit_size_;
+      page_granules = new Granule[num_granules];
+      memset(page_granules, 0, num_granules * sizeof(Granule));
+    }
+    last_page_ = page;
+    last_page_granules_ = page_granules;
+  }
+  return &last_page_granules_[(iaddr & ~SHADOW_PAGE_MASK) / unit_size_];
+}
+
+uint32 SharedInstAnalyzer::GetThdIdx(thread_id_t thd_id) {
+  if (thd_id != last_thd_id_) {
+    std::tr1::unordered_map<thread_id_t, uint32>::iterator it
+        = thd_idx_map_.find(thd_id);
+    if (it == thd_idx_map_.end()) {
+      uint32 thd_idx = (uint32)thd_idx_map_.size();
+      it = thd_idx_map_.insert(std::make_pair(thd_id, thd_idx)).first;
+    }
+    last_thd_id_ = thd_id;
+    last_thd_idx_ = it->second;
+  }
+  return last_thd_idx_;
+}
+
+SharedInstAnalyzer::InstInfo *SharedInstAnalyzer::GetInstInfo(Inst *inst) {
+  inst_id_type id = inst->id();
+  if (id >= inst_info_vec_.size()) {
+    InstInfo empty_info = { NULL, false };
+    inst_info_vec_.resize(id + 1 + id / 2, empty_info);
+  }
+  InstInfo *info = &inst_info_vec_[id];
+  if (!info->inst) {
+    info->inst = inst;
+    info->shared = sinst_db_->Shared(inst);
+  }
+  return info;
+}
+
+void SharedInstAnalyzer::AccessPrivate(Granule *granule, address_t iaddr,
+                                       InstInfo *info) {
+  // shared instructions do not need to be remembered
+  if (info->shared || granule->inst == info->inst)
+    return;
+  if (granule->inst) {
+    // more than one instruction, keep the previous one in the overflow table
+    std::vector<Inst *> &inst_vec = overflow_table_[iaddr];
+    if (std::find(inst_vec.begin(), inst_vec.end(), granule->inst)
+        == inst_vec.end())
+      inst_vec.push_back(granule->inst);
+    granule->state |= STATE_OVERFLOW;
+  }
+  granule->inst = info->inst;
+}
 
+void SharedInstAnalyzer::AccessShared(InstInfo *info) {
+  if (!info->shared) {
+    info->shared = true;
+    sinst_db_->SetShared(info->inst);
+  }
+}
+
+void SharedInstAnalyzer::SetGranuleShared(Granule *granule, address_t iaddr,
+                                          InstInfo *info) {
+  AccessShared(info);
+  // all the instructions that accessed the granule while it was private
+  // become shared
+  if (granule->inst)
+    AccessShared(GetInstInfo(granule->inst));
+  if (granule->state & STATE_OVERFLOW) {
+    OverflowTable::iterator it = overflow_table_.find(iaddr);
+    DEBUG_ASSERT(it != overflow_table_.end());
+    for (std::vector<Inst *>::iterator vit = it->second.begin();
+         vit != it->second.end(); ++vit) {
+      AccessShared(GetInstInfo(*vit));
+    }
+    overflow_table_.erase(it);
+  }
+  granule->state = STATE_SHARED;
+  granule->inst = NULL;
+}
+
+} // namespace sinst
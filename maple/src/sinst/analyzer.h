@@ -20,7 +20,7 @@
 #ifndef SINST_ANALYZER_H_
 #define SINST_ANALYZER_H_
 
-#include <set>
+#include <vector>
 #include <tr1/unordered_map>
 
 #include "core/basictypes.h"
@@ -65,35 +65,49 @@ class SharedInstAnalyzer : public Analyzer {
                    Inst *inst, size_t size, address_t addr);
 
  protected:
-  class Meta {
-   public:
-    typedef std::set<Inst *> InstSet;
-    typedef std::tr1::unordered_map<address_t, Meta> Table;
-
-    Meta()
-        : shared(false),
-          has_write(false),
-          multi_read(false),
-          last_thd_id(INVALID_THD_ID) {}
-
-    ~Meta() {}
-
+  // The sharing state of each granule (unit_size_ bytes) is kept in one word
+  // in the shadow memory. The low bits are the flags below, and the high 32
+  // bits hold the (dense) index of the thread that last accessed it.
+  typedef uint64 State;
+  // Per granule shadow. While the granule is private, inst is the last
+  // instruction that accessed it. If more than one instruction accessed it,
+  // the others are kept in the overflow table.
+  typedef struct {
+    State state;
+    Inst *inst;
+  } Granule;
+  // Per instruction info (caches whether the instruction is shared).
+  typedef struct {
+    Inst *inst;
     bool shared;
-    bool has_write;
-    bool multi_read;
-    thread_id_t last_thd_id;
-    InstSet inst_set;
-  };
+  } InstInfo;
+  typedef std::vector<InstInfo> InstInfoVec;
+  typedef std::tr1::unordered_map<address_t, Granule *> ShadowTable;
+  typedef std::tr1::unordered_map<address_t, std::vector<Inst *> >
+      OverflowTable;
 
   void AllocAddrRegion(address_t addr, size_t size);
   void FreeAddrRegion(address_t addr);
   bool FilterAccess(address_t addr) { return filter_->Filter(addr, false); }
+  Granule *GetGranule(address_t iaddr);
+  uint32 GetThdIdx(thread_id_t thd_id);
+  InstInfo *GetInstInfo(Inst *inst);
+  void AccessPrivate(Granule *granule, address_t iaddr, InstInfo *info);
+  void AccessShared(InstInfo *info);
+  void SetGranuleShared(Granule *granule, address_t iaddr, InstInfo *info);
 
   Mutex *internal_lock_;
   SharedInstDB *sinst_db_;
   address_t unit_size_;
   RegionFilter *filter_;
-  Meta::Table meta_table_;
+  ShadowTable shadow_table_;
+  address_t last_page_; // cache of the last shadow page looked up
+  Granule *last_page_granules_;
+  std::tr1::unordered_map<thread_id_t, uint32> thd_idx_map_;
+  thread_id_t last_thd_id_; // cache of the last thread index looked up
+  uint32 last_thd_idx_;
+  InstInfoVec inst_info_vec_; // indexed by inst id
+  OverflowTable overflow_table_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(SharedInstAnalyzer);
@@ -34,6 +34,7 @@ ChessScheduler::ChessScheduler(ControllerInterface *controller)
       pb_enable_(false),
       pb_useDelayBound_(false),
       por_enable_(false),
+      abort_diverge_(true),
       pb_limit_(0),
       useless_(false),
       divergence_(false),
@@ -42,6 +43,9 @@ ChessScheduler::ChessScheduler(ControllerInterface *controller)
       curr_node_(NULL),
       prefix_size_(0),
       curr_preemptions_(0),
+      order_size_(0),
+      prev_idx_(0),
+      prev_enabled_(false),
       seal_after_one_(false),
       curr_hash_val_(0),
       curr_exec_id_(0) {
@@ -63,6 +67,7 @@ void ChessScheduler::Register() {
   knob()->RegisterBool("seal_after_one", "seal a racey memory op after it has been preempted once", "0");
   knob()->RegisterStr("search_in", "the input file that contains the search information", "search.db");
   knob()->RegisterStr("search_out", "the output file that contains the search information", "search.db");
+  knob()->RegisterInt("search_compact", "the number of incremental search info updates before the whole stack is rewritten (0 to always rewrite)", "32");
   knob()->RegisterStr("por_info_path", "the dir path that stores the partial order reduction information", "por-info");
 }
 
@@ -80,12 +85,14 @@ void ChessScheduler::Setup() {
         pb_enable_ && "Must enable preemption bound search to use delay bound");
   }
   por_enable_ = knob()->ValueBool("por");
+  abort_diverge_ = knob()->ValueBool("abort_diverge");
   pb_limit_ = knob()->ValueInt("pb_limit");
   por_info_path_ = knob()->ValueStr("por_info_path");
   
   seal_after_one_ = knob()->ValueBool("seal_after_one");
   
   // load search info
+  search_info_.set_compact_interval(knob()->ValueInt("search_compact"));
   search_info_.Load(knob()->ValueStr("search_in"), sinfo(), program());
   if (search_info_.Done()) {
     printf("[CHESS] search done\n");
@@ -213,6 +220,7 @@ void ChessScheduler::Explore(State *init_state) {
         if (curr_node_ && curr_node_->sel() == action->thd()
           && (action->op() == OP_SCHED_YIELD || action->op() == OP_SLEEP
               || action->op() == OP_USLEEP
+              || action->op() == OP_NANOSLEEP
               || action->op() == OP_COND_TIMEDWAIT)) {
             curr_state_->enabled()->erase(it);
             break;
@@ -227,6 +235,8 @@ void ChessScheduler::Explore(State *init_state) {
       DivergenceRun();
       return;
     }
+    // update the round robin order for the current state
+    UpdateOrder();
     // update backtrack: add all enabled thread to backtrack
     // this is necessary because we want to explore all possible
     // interleavings. we only need to do nextOpSameThread once.
@@ -293,7 +303,7 @@ void ChessScheduler::DivergenceRun() {
   divergence_ = true;
 
   // abort if needed
-  if (knob()->ValueBool("abort_diverge")) {
+  if (abort_diverge_) {
     std::cout << "PROBLEM: divergence" << std::endl;
     assert(0);
   }
@@ -408,7 +418,6 @@ Action *ChessScheduler::PickNext() {
   
   // second pass, find an undone enabled action
   
-  Thread::Vec& thr_crea_order = controller_->GetThreadCreationOrder();
   // DEBUGGING
 //  std::cout << "Picking next undone action" << std::endl;
 //  std::cout << "Cost of execution: " << curr_preemptions_ << std::endl;
@@ -431,38 +440,33 @@ Action *ChessScheduler::PickNext() {
 
   if (curr_state_->enabled()->size() > 0) {
     assert(curr_node_->Prev() || curr_node_->idx() == 0);
-    size_t tindex = 0;
-    if (curr_node_->Prev()) {
-      // Previous node exists
-      Thread * prev_thread = curr_node_->Prev()->sel();
-      // find previous thread
-      while (thr_crea_order[tindex]->uid() != prev_thread->uid()) {
-        tindex++;
-        if (tindex >= thr_crea_order.size()) {
-          tindex = 0;
-        }
-      }
-    }
-    size_t prevTindex = tindex;
-
-//    std::cout << "current thread: " << tindex+1 << std::endl;
+    Thread::Vec& thr_crea_order = controller_->GetThreadCreationOrder();
 
-    // find next enabled action that is not done
-    for (size_t i = 0, end = thr_crea_order.size(); i < end; i++) {
-      if (curr_state_->IsEnabled(thr_crea_order[tindex])
-          && !curr_node_->IsDone(thr_crea_order[tindex])) {
-        next_action = curr_state_->enabled()->at(thr_crea_order[tindex]);
+//    std::cout << "current thread: " << prev_idx_+1 << std::endl;
+
+    // find next enabled action that is not done (visit the enabled
+    // threads only, starting from the previous thread)
+    size_t num_words = enabled_mask_.size();
+    for (size_t i = 0; i <= num_words && !next_action; i++) {
+      size_t w = (prev_idx_ / 64 + i) % num_words;
+      uint64 bits = enabled_mask_[w];
+      if (i == 0)
+        bits &= ~(uint64)0 << (prev_idx_ % 64);
+      else if (i == num_words)
+        bits &= ((uint64)1 << (prev_idx_ % 64)) - 1;
+      while (bits) {
+        size_t tindex = w * 64 + __builtin_ctzll(bits);
+        bits &= bits - 1;
+        if (!curr_node_->IsDone(thr_crea_order[tindex])) {
+          next_action = curr_state_->FindEnabled(thr_crea_order[tindex]);
 //          std::cout << "chosen tindex=" << tindex+1 << std::endl;
-        break;
-      }
-      tindex++;
-      if (tindex >= thr_crea_order.size()) {
-        tindex = 0;
+          break;
+        }
       }
     }
     
     // potentially disable any non-deterministic thread switches
-    if(next_action && !thr_crea_order[prevTindex]->enable_nondet_switches_) {
+    if(next_action && !thr_crea_order[prev_idx_]->enable_nondet_switches_) {
       for (auto& thr_action : (*curr_state_->enabled())) {
         if(thr_action.second != next_action) {
           curr_node_->AddDone(thr_action.first);
@@ -499,22 +503,10 @@ Action *ChessScheduler::PickNextRandom() {
 }
 
 bool ChessScheduler::IsPreemptiveChoice(Action *action) {
-  Thread* prevThread = NULL;
   assert(curr_node_);
-  
-  if(curr_node_->Prev()) {
-    prevThread = curr_node_->Prev()->sel();
-  } else {
-    Thread::Vec& thr_crea_order = controller_->GetThreadCreationOrder();
-    prevThread = thr_crea_order[0];
-  }
-  
-  if (curr_state_->enabled()->find(prevThread)
-          != curr_state_->enabled()->end()
-      && prevThread != action->thd())
-    return true;
-  else
-    return false;
+  // the previous thread (or the main thread) is still enabled
+  // but another thread is chosen
+  return prev_enabled_ && OrderIdx(action->thd()) != prev_idx_;
 }
 
 bool ChessScheduler::IsFrontier() {
@@ -588,53 +580,18 @@ int ChessScheduler::DbGetDelayCost(Action *next_action) {
   //std::cout << "Calculating delay cost" << std::endl;
   
   if(curr_state_->enabled()->size() > 1) {
-    Thread::Vec& thr_crea_order = controller_->GetThreadCreationOrder();
-    
-    // DEBUGGING
-//    std::cout << "Threads: ";
-//    for (size_t i = 0, end = thr_crea_order.size(); i != end; ++i) {
-//      if(!curr_state_->IsEnabled(thr_crea_order[i])) {
-//        std::cout << "(" << i << ")";
-//      } else {
-//        std::cout << " " << i << " ";
-//      }
-//    }
-//    std::cout << std::endl;
-    
-    // find current thread
-    size_t tindex = 0;
+    // the cost is the number of enabled threads that are skipped
+    // when going round robin from the current thread to the thread
+    // of next_action
     assert(curr_node_);
-    if(curr_node_->Prev()) {
-      while (thr_crea_order[tindex]->uid() != curr_node_->Prev()->sel()->uid()) {
-        tindex++;
-        if(tindex >= thr_crea_order.size())
-        {
-          tindex=0;
-        }
-      }
-    }
-    //std::cout << "curren thread tindex=" << tindex << std::endl;
-    // find next enabled thread
-    while(!curr_state_->IsEnabled(thr_crea_order[tindex])) {
-      tindex++;
-      if(tindex >= thr_crea_order.size())
-      {
-        tindex=0;
-      }
-      assert((size_t)cost < curr_state_->enabled()->size());
-    }
-    // find next_action's thread and calculate cost
-    while(thr_crea_order[tindex]->uid() != next_action->thd()->uid()) {
-      if(curr_state_->IsEnabled(thr_crea_order[tindex])) {
-        cost++;
-      }
-      tindex++;
-      if(tindex >= thr_crea_order.size())
-      {
-        tindex=0;
-      }
+    size_t next_idx = OrderIdx(next_action->thd());
+    if (prev_idx_ <= next_idx) {
+      cost = CountEnabled(prev_idx_, next_idx);
+    } else {
+      cost = CountEnabled(prev_idx_, order_size_)
+             + CountEnabled(0, next_idx);
     }
-//  std::cout << "next thread tindex=" << tindex << std::endl;
+    assert((size_t)cost < curr_state_->enabled()->size());
   }
 //  std::cout << "cost=" << cost << std::endl;
   return cost;
@@ -662,6 +619,58 @@ bool ChessScheduler::PbEnabled(Action *next_action) {
   return (curr_preemptions_ + GetActionCost(next_action) <= pb_limit_);
 }
 
+// round robin order related
+void ChessScheduler::UpdateOrder() {
+  // index threads that are created since the last update
+  Thread::Vec& thr_crea_order = controller_->GetThreadCreationOrder();
+  for (; order_size_ < thr_crea_order.size(); order_size_++) {
+    Thread::uid_t uid = thr_crea_order[order_size_]->uid();
+    if (order_idx_.size() <= uid)
+      order_idx_.resize(uid + 1, 0);
+    order_idx_[uid] = order_size_;
+  }
+  // rebuild the enabled mask from the enabled set
+  enabled_mask_.assign((order_size_ + 63) / 64, 0);
+  for (Action::Map::iterator it = curr_state_->enabled()->begin();
+       it != curr_state_->enabled()->end(); ++it) {
+    size_t idx = OrderIdx(it->first);
+    enabled_mask_[idx / 64] |= (uint64)1 << (idx % 64);
+  }
+  // the previous thread is the main thread at the beginning
+  if (curr_node_->Prev())
+    prev_idx_ = OrderIdx(curr_node_->Prev()->sel());
+  else
+    prev_idx_ = 0;
+  prev_enabled_ = OrderEnabled(prev_idx_);
+}
+
+size_t ChessScheduler::OrderIdx(Thread *thd) {
+  DEBUG_ASSERT(thd->uid() < order_idx_.size());
+  DEBUG_ASSERT(controller_->GetThreadCreationOrder()[order_idx_[thd->uid()]]
+               == thd);
+  return order_idx_[thd->uid()];
+}
+
+bool ChessScheduler::OrderEnabled(size_t idx) {
+  return (enabled_mask_[idx / 64] >> (idx % 64)) & 1;
+}
+
+size_t ChessScheduler::CountEnabled(size_t begin, size_t end) {
+  size_t count = 0;
+  while (begin < end) {
+    size_t w = begin / 64;
+    uint64 bits = enabled_mask_[w] & (~(uint64)0 << (begin % 64));
+    size_t next = (w + 1) * 64;
+    if (end < next) {
+      bits &= ((uint64)1 << (end % 64)) - 1;
+      next = end;
+    }
+    count += __builtin_popcountll(bits);
+    begin = next;
+  }
+  return count;
+}
+
 // partial order reduction related functions
 void ChessScheduler::PorInit() {
   DEBUG_ASSERT(por_enable_);
@@ -42,6 +42,7 @@ class ChessScheduler : public Scheduler {
   void ProgramStart();
   void ProgramExit();
   void Explore(State *init_state);
+  int NumPreemptions() { return pb_enable_ ? curr_preemptions_ : -1; }
   
   bool IsInvisibleOp(Operation op);
   State *getPreviousState();
@@ -108,6 +109,12 @@ class ChessScheduler : public Scheduler {
   int GetActionCost(Action *next_action);
   int DbGetDelayCost(Action *next_action);
 
+  // round robin order related (threads are ordered by creation)
+  void UpdateOrder();
+  size_t OrderIdx(Thread *thd);
+  bool OrderEnabled(size_t idx);
+  size_t CountEnabled(size_t begin, size_t end);
+
   // partial order reduction related
   void PorInit();
   void PorFini();
@@ -124,6 +131,7 @@ class ChessScheduler : public Scheduler {
   bool pb_enable_; // whether bound the number of preemptions
   bool pb_useDelayBound_;
   bool por_enable_; // whether perform sleep-set based por
+  bool abort_diverge_; // whether abort when divergence happens
   int pb_limit_; // the bound of the number of preemptions
   std::string por_info_path_; // the dir storing por information
 
@@ -142,6 +150,13 @@ class ChessScheduler : public Scheduler {
   // preemption bound related
   int curr_preemptions_;
 
+  // round robin order related
+  std::vector<size_t> order_idx_; // thread uid to creation order idx
+  size_t order_size_; // the number of threads in order_idx_
+  std::vector<uint64> enabled_mask_; // enabled bit per creation order idx
+  size_t prev_idx_; // the creation order idx of the previous thread
+  bool prev_enabled_; // whether the previous thread is still enabled
+
   bool seal_after_one_;
 
   // partial order reduction related
@@ -21,8 +21,13 @@
 
 #include <sys/resource.h>
 #include <sys/syscall.h>
+#include <sys/time.h>
 #include <cassert>
 #include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
 
 namespace systematic {
 
@@ -40,16 +45,31 @@ bool Controller::CreationInfo::Match(CreationInfo *info) {
 
 Controller::Controller()
     : scheduler_(NULL),
+      schedule_(NULL),
       program_(NULL),
       execution_(NULL),
       race_db_(NULL),
       djit_analyzer_(NULL),
       unit_size_(4),
       check_mem_(false),
+      setup_start_time_(0),
+      program_start_time_(0),
+      bug_kind_("none"),
+      num_steps_(0),
+      result_written_(false),
+      max_steps_(0),
+      livelock_windows_(0),
+      failed_trylock_(false),
+      virtual_time_(false),
+      vtime_(0),
+      vtime_tick_(0),
+      vtime_base_(0),
       scheduler_thd_uid_(INVALID_PIN_THREAD_UID),
       program_exiting_(false),
       next_state_ready_(false),
-      next_state_sem_(NULL) {
+      next_state_sem_(NULL),
+      num_enabled_(0),
+      num_active_(0) {
   // empty
 }
 
@@ -60,17 +80,27 @@ Controller::~Controller() {
 void Controller::HandlePreSetup() {
   ExecutionControl::HandlePreSetup();
 
+  setup_start_time_ = TimeUs();
+
   knob_->RegisterBool("sched_app", "whether only schedule operations from the application", "1");
   knob_->RegisterBool("sched_race", "whether schedule racy memory operations (for racy programs)", "0");
   knob_->RegisterInt("cpu", "specify which cpu to run on", "0");
   knob_->RegisterInt("unit_size", "the monitoring granularity in bytes", "4");
   knob_->RegisterBool("check_mem", "check memory out of bounds", "0");
   knob_->RegisterBool("control_cs", "allow the program under test to enable/disable context switches", "0");
+  knob_->RegisterBool("shadow_callstack", "track every call and return to maintain shadow call stacks (for binaries without frame pointers)", "0");
   knob_->RegisterInt("realtime_priority", "the realtime priority on which all the user thread should be run", "1");
   knob_->RegisterStr("program_in", "the input database for the modeled program", "program.db");
   knob_->RegisterStr("program_out", "the output database for the modeled program", "program.db");
   knob_->RegisterStr("race_in", "the input race database path", "race.db");
+  knob_->RegisterBool("stream_states", "recycle consumed states for schedulers that never look back (random and pct)", "1");
   knob_->RegisterStr("race_out", "the output race database path", "race.db");
+  knob_->RegisterStr("result_out", "the output file for the result record of this execution (empty to disable)", "");
+  knob_->RegisterInt("max_steps", "the maximum number of scheduling steps in an execution (0 for no limit)", "0");
+  knob_->RegisterBool("virtual_time", "model sleeps, poll/select/epoll timeouts and clock reads with a virtual clock instead of waiting in real time", "0");
+  knob_->RegisterInt("vtime_tick_us", "the virtual time that passes at each clock read when virtual_time is enabled (in microseconds)", "1000");
+  knob_->RegisterStr("schedule_out", "the output file for the schedule of this execution (empty to disable)", "");
+  knob_->RegisterInt("livelock_windows", "the number of idle windows in a row after which an execution is considered livelocked, where an idle window ends when every enabled thread has yielded without any progress (a memory write or a state changing synchronization) in between (0 to disable)", "0");
   
   random_scheduler_ = new RandomScheduler(this);
   random_scheduler_->Register();
@@ -78,12 +108,11 @@ void Controller::HandlePreSetup() {
   chess_scheduler_->Register();
   pct_scheduler_ = new PCTRandomScheduler(this);
   pct_scheduler_->Register();
+  replay_scheduler_ = new ReplayScheduler(this);
+  replay_scheduler_->Register();
   
   djit_analyzer_ = new race::Djit;
   djit_analyzer_->Register();
-  
-  desc_.SetTrackCallStack();
-  
 }
 
 void Controller::HandlePostSetup() {
@@ -95,15 +124,30 @@ void Controller::HandlePostSetup() {
   unit_size_ = knob_->ValueInt("unit_size");
   check_mem_ = knob_->ValueBool("check_mem");
   control_cs_ = knob_->ValueBool("control_cs");
+  max_steps_ = knob_->ValueInt("max_steps");
+  livelock_windows_ = knob_->ValueInt("livelock_windows");
+  virtual_time_ = knob_->ValueBool("virtual_time");
+  vtime_tick_ = (uint64)knob_->ValueInt("vtime_tick_us") * 1000;
+  vtime_base_ = TimeUs() * 1000;
+
+  // call stacks are captured lazily at reporting points by default
+  if (knob_->ValueBool("shadow_callstack"))
+    desc_.SetTrackCallStack();
+  else
+    desc_.SetLazyCallStack();
 
   // init global states
+  uint64 start_time = TimeUs();
   program_ = new Program;
   program_->Load(knob_->ValueStr("program_in"), sinfo_);
+  STAT_INC("us_program_load", TimeUs() - start_time);
   execution_ = new Execution;
+  start_time = TimeUs();
   race_db_ = new race::RaceDB(CreateMutex());
   //if (sched_race_) {
   race_db_->Load(knob_->ValueStr("race_in"), sinfo_);
   //}
+  STAT_INC("us_race_load", TimeUs() - start_time);
   
   // add data race detector
   if (djit_analyzer_->Enabled()) {
@@ -121,10 +165,15 @@ void Controller::HandlePostSetup() {
     SetScheduler(chess_scheduler_);
   if(pct_scheduler_->Enabled())
     SetScheduler(pct_scheduler_);
+  if (replay_scheduler_->Enabled())
+    SetScheduler(replay_scheduler_);
 
   // make sure that we use one scheduler
   if (!scheduler_)
     Abort("please choose a scheduler\n");
+  execution_->set_streaming(knob_->ValueBool("stream_states") &&
+                            scheduler_->Streamable());
+  RecordSchedule();
 
   if(check_mem_) {
     desc_.SetHookBeforeMem();
@@ -134,7 +183,15 @@ void Controller::HandlePostSetup() {
   desc_.SetHookPthreadFunc();
   desc_.SetHookMallocFunc();
   desc_.SetHookSignal();
-  desc_.SetHookSyscall();
+  desc_.SetHookSyscall(SYS_exit_group);
+  if (control_cs_) {
+    desc_.SetHookSyscall(SYS_sched_get_priority_max);
+    desc_.SetHookSyscall(SYS_sched_get_priority_min);
+  }
+  if (virtual_time_) {
+    desc_.SetHookYieldFunc();
+    desc_.SetHookTimeFunc();
+  }
   
   std::cout << "hook signal " << desc_.HookSignal() << std::endl;
   std::cout << "hook syscall " << desc_.HookSyscall() << std::endl;
@@ -266,6 +323,10 @@ void Controller::HandlePreInstrumentTrace(TRACE trace) {
 void Controller::HandleProgramStart() {
   ExecutionControl::HandleProgramStart();
 
+  // the time spent before the program starts (sinfo and db loads)
+  program_start_time_ = TimeUs();
+  STAT_INC("us_startup", program_start_time_ - setup_start_time_);
+
   // create the scheduler thread (internal pintool thread)
   THREADID tid = PIN_SpawnInternalThread(__SchedulerThread,
                                          NULL, // no argument passed
@@ -289,12 +350,31 @@ void Controller::HandleProgramStart() {
 void Controller::HandleProgramExit() {
   ExecutionControl::HandleProgramExit();
 
-  // invoke the callback in the scheduler
+  uint64 exit_time = TimeUs();
+  STAT_INC("us_program", exit_time - program_start_time_);
+
+  // write the result record before the scheduler may exit (search done)
+  WriteResult();
+  if (schedule_) {
+    schedule_->Save(knob_->ValueStr("schedule_out"));
+    delete schedule_;
+    schedule_ = NULL;
+  }
+
+  // invoke the callback in the scheduler (saves the search info)
   scheduler_->ProgramExit();
+  uint64 start_time = TimeUs();
+  STAT_INC("us_sched_save", start_time - exit_time);
 
   // save status
   program_->Save(knob_->ValueStr("program_out"), sinfo_);
+  uint64 end_time = TimeUs();
+  STAT_INC("us_program_save", end_time - start_time);
   race_db_->Save(knob_->ValueStr("race_out"), sinfo_);
+  start_time = end_time;
+  end_time = TimeUs();
+  STAT_INC("us_race_save", end_time - start_time);
+  STAT_INC("us_tool", end_time - setup_start_time_);
 }
 
 void Controller::HandleImageLoad(IMG img, Image *image) {
@@ -380,22 +460,32 @@ void Controller::HandleThreadStart() {
   } else {
     // this is the child thread, get the creator
     DEBUG_ASSERT(parent != INVALID_THD_ID);
-    Thread *parent_thd = FindThread(parent);
-    DEBUG_ASSERT(parent_thd);
-    Thread::idx_t creator_idx = ++thread_creation_info_[parent];
-    curr_thd = program_->GetThread(parent_thd, creator_idx);
+    ThreadSlot *parent_slot = GetSlot(parent);
+    Thread::idx_t creator_idx = ++parent_slot->num_children;
+    curr_thd = program_->GetThread(parent_slot->thd, creator_idx);
   }
   // initialize per-thread data structures
-  perm_sem_table_[self] = CreateSemaphore(0);
-  thread_table_[self] = curr_thd;
+  // slots are never freed, get them cache line aligned
+  void *slot_mem = NULL;
+  if (posix_memalign(&slot_mem, 64, sizeof(ThreadSlot)))
+    Abort("fail to allocate thread slot\n");
+  ThreadSlot *slot = new (slot_mem) ThreadSlot;
+  slot->idx = slots_.size();
+  slot->thd_id = self;
+  slot->thd = curr_thd;
+  slot->perm_sem = CreateSemaphore(0);
+  slots_.push_back(slot);
+  slot_table_[self] = slot;
+  if (uid_slots_.size() <= curr_thd->uid())
+    uid_slots_.resize(curr_thd->uid() + 1, NULL);
+  uid_slots_[curr_thd->uid()] = slot;
+  if (enabled_mask_.size() * 64 <= slot->idx) {
+    enabled_mask_.push_back(0);
+    pending_mask_.push_back(0);
+  }
   thread_creation_order_.push_back(curr_thd);
-  thread_reverse_table_[curr_thd] = self;
-  action_table_[self] = NULL;
-  enable_table_[self] = true;
-  thread_creation_info_[self] = 0;
-  active_table_[self] = true;
-  if (sched_race_)
-    race_active_table_[self] = false;
+  SetEnabled(slot, true);
+  SetActive(slot, true);
   UnlockKernel();
 
   ExecutionControl::HandleThreadStart();
@@ -411,16 +501,15 @@ void Controller::HandleThreadExit() {
   join_info->exit = true;
   for (JoinInfo::WaitQueue::iterator it = join_info->wait_queue.begin();
        it != join_info->wait_queue.end(); ++it) {
-    DEBUG_ASSERT(!enable_table_[*it]);
-    enable_table_[*it] = true;
+    DEBUG_ASSERT(!IsEnabled(*it));
+    SetEnabled(*it, true);
   }
   join_info->wait_queue.clear();
 
   // clean up self
-  enable_table_[self] = false;
-  active_table_[self] = false;
-  if (sched_race_)
-    race_active_table_[self] = false;
+  ThreadSlot *slot = GetSlot(self);
+  SetEnabled(slot, false);
+  SetActive(slot, false);
   // schedule on exit
   ScheduleOnExit(self);
   UnlockKernel();
@@ -438,12 +527,13 @@ void Controller::HandleSchedulerThread() {
   // explore returns when program is about to exit
   // if the program is not exiting, wa are in a deadlock
   if (!program_exiting_) {
-    for(auto& tid_bool : enable_table_) {
-      std::cout << "Stack for thread " << thread_table_[tid_bool.first]->uid() 
+    for(auto slot : slots_) {
+      std::cout << "Stack for thread " << slot->thd->uid() 
           << ":" << std::endl;
-      std::cout << callstack_info_->GetCallStack(tid_bool.first)->ToString();
+      std::cout << GetCallStack(slot->thd_id)->ToString();
     }
     printf("ERROR: [CHESS] program deadlock\n");
+    bug_kind_ = "deadlock";
   }
   fflush(stdout);
   ProgramExit(1,0);
@@ -490,9 +580,9 @@ void Controller::HandleBeforeMemOp(THREADID tid, Inst *inst, address_t addr,
           std::cout << std::endl << "ERROR: mem access not in bounds"
               << std::endl;
           thread_id_t self = Self();
-          std::cout << "Stack for thread " << thread_table_[self]->uid() 
+          std::cout << "Stack for thread " << FindThread(self)->uid() 
               << ":" << std::endl;
-          std::cout << callstack_info_->GetCallStack(self)->ToString();
+          std::cout << GetCallStack(self)->ToString();
           
           std::cout << "Bounds are: " << dregion->addr << "--"
               << dregion->addr + dregion->size << std::endl;
@@ -515,11 +605,13 @@ void Controller::HandleBeforeMemOp(THREADID tid, Inst *inst, address_t addr,
             << dregion->addr + dregion->size << std::endl;
         ss << "Access was at: " << addr << std::endl;
         ss << "Size: " << size<< std::endl;
-        ss << inst->DebugInfoStr() << std::endl;
+        if (inst->HasDebugInfo())
+          ss << inst->DebugInfoStr() << std::endl;
         ss 
             << "Image name: " << inst->image()->name()
             << ", offset: " << inst->offset() << std::endl;
         std::cout << ss.str() << std::endl;
+        bug_kind_ = "use_after_free";
         ProgramExit(1,0);
         exit(1);
       }
@@ -607,10 +699,10 @@ void Controller::HandleAfterRaceWrite(THREADID tid, Inst *inst,
 int Controller::MutexTryLock(thread_id_t self,
                              address_t mutex_addr,
                              Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
 
   // schedule point
-  Schedule(self, mutex_addr, OP_MUTEX_TRYLOCK, inst);
+  Action *action = Schedule(self, mutex_addr, OP_MUTEX_TRYLOCK, inst);
 
   // determine mutex status
   MutexInfo *mutex_info = GetMutexInfo(mutex_addr, inst);
@@ -620,18 +712,20 @@ int Controller::MutexTryLock(thread_id_t self,
   }
   else if (mutex_info->holder == self && mutex_info->recursive < 0) {
     // mutex us still held by us, and mutex is not recursive
+    failed_trylock_ = true;
     return EBUSY;
   }
   else if (mutex_info->holder != INVALID_THD_ID) {
     // mutex is still held by other thread
+    failed_trylock_ = true;
     return EBUSY;
   } else {
     // mutex is open, grab the mutex
     mutex_info->holder = self;
     for (MutexInfo::ReadyMap::iterator it = mutex_info->ready_map.begin();
          it != mutex_info->ready_map.end(); ++it) {
-      DEBUG_ASSERT(enable_table_[it->first]);
-      enable_table_[it->first] = false;
+      DEBUG_ASSERT(IsEnabled(it->first));
+      SetEnabled(it->first, false);
       mutex_info->wait_queue.push_back(it->first);
     }
     return 0;
@@ -644,7 +738,7 @@ int Controller::MutexTryLock(thread_id_t self,
 void Controller::MutexLock(thread_id_t self,
                            address_t mutex_addr,
                            Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
   {
     // check mutex status
     MutexInfo *mutex_info = GetMutexInfo(mutex_addr, inst);
@@ -654,12 +748,13 @@ void Controller::MutexLock(thread_id_t self,
     }
     if (mutex_info->holder == self && mutex_info->recursive < 0) {
       std::cout << "ERROR: Thread re-locked a non-recursive mutex." << std::endl;
+      bug_kind_ = "mutex_relock";
       ProgramExit(1, NULL);
       exit(1);
     }
     if (mutex_info->holder != INVALID_THD_ID) {
       DEBUG_ASSERT(mutex_info->holder != self);
-      enable_table_[self] = false;
+      SetEnabled(self, false);
       mutex_info->wait_queue.push_back(self);
     }
     mutex_info->ready_map[self] = false;
@@ -676,8 +771,8 @@ void Controller::MutexLock(thread_id_t self,
   mutex_info->ready_map.erase(self);
   for (MutexInfo::ReadyMap::iterator it = mutex_info->ready_map.begin();
        it != mutex_info->ready_map.end(); ++it) {
-    DEBUG_ASSERT(enable_table_[it->first]);
-    enable_table_[it->first] = false;
+    DEBUG_ASSERT(IsEnabled(it->first));
+    SetEnabled(it->first, false);
     mutex_info->wait_queue.push_back(it->first);
   }
 }
@@ -685,7 +780,7 @@ void Controller::MutexLock(thread_id_t self,
 void Controller::MutexUnlock(thread_id_t self,
                              address_t mutex_addr,
                              Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
   {
     MutexInfo *mutex_info = GetMutexInfo(mutex_addr, inst);
     if(mutex_info->holder == self && mutex_info->recursive > 0) {
@@ -694,6 +789,7 @@ void Controller::MutexUnlock(thread_id_t self,
     }
     if(mutex_info->holder != self) {
       std::cout << "ERROR: Thread unlocked a mutex that it did not own." << std::endl;
+      bug_kind_ = "mutex_not_owner";
       ProgramExit(1, NULL);
       exit(1);
     }
@@ -706,8 +802,8 @@ void Controller::MutexUnlock(thread_id_t self,
   mutex_info->holder = INVALID_THD_ID;
   for (MutexInfo::WaitQueue::iterator it = mutex_info->wait_queue.begin();
        it != mutex_info->wait_queue.end(); ++it) {
-    DEBUG_ASSERT(!enable_table_[*it]);
-    enable_table_[*it] = true;
+    DEBUG_ASSERT(!IsEnabled(*it));
+    SetEnabled(*it, true);
   }
   mutex_info->wait_queue.clear();
 }
@@ -715,7 +811,7 @@ void Controller::MutexUnlock(thread_id_t self,
 void Controller::CondSignal(thread_id_t self,
                             address_t cond_addr,
                             Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
 
   // schedule point
   Schedule(self, cond_addr, OP_COND_SIGNAL, inst);
@@ -730,8 +826,8 @@ void Controller::CondSignal(thread_id_t self,
     if (!wait_info.broadcasted) {
       // set enabled if needed
       if (!wait_info.timed && wait_info.signal_set.empty()) {
-        DEBUG_ASSERT(!enable_table_[thd_id]);
-        enable_table_[thd_id] = true;
+        DEBUG_ASSERT(!IsEnabled(thd_id));
+        SetEnabled(thd_id, true);
       }
       // update signal set
       wait_info.signal_set.insert(next_signal_id);
@@ -742,7 +838,7 @@ void Controller::CondSignal(thread_id_t self,
 void Controller::CondBroadcast(thread_id_t self,
                                address_t cond_addr,
                                Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
 
   // schedule point
   Schedule(self, cond_addr, OP_COND_BROADCAST, inst);
@@ -756,8 +852,8 @@ void Controller::CondBroadcast(thread_id_t self,
     if (!wait_info.broadcasted) {
       // set enabled if needed
       if (!wait_info.timed && wait_info.signal_set.empty()) {
-        DEBUG_ASSERT(!enable_table_[thd_id]);
-        enable_table_[thd_id] = true;
+        DEBUG_ASSERT(!IsEnabled(thd_id));
+        SetEnabled(thd_id, true);
       }
       // clear signal set and set broadcasted to true
       wait_info.broadcasted = true;
@@ -769,7 +865,7 @@ void Controller::CondBroadcast(thread_id_t self,
 void Controller::CondWait(thread_id_t self,
                           address_t cond_addr,
                           Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
 
   // wait on the cond variable
   CondInfo *cond_info = GetCondInfo(cond_addr, inst);
@@ -778,7 +874,7 @@ void Controller::CondWait(thread_id_t self,
   self_wait_info.timed = false;
   self_wait_info.broadcasted = false;
   // disable self
-  enable_table_[self] = false;
+  SetEnabled(self, false);
 
   // schedule point
   Schedule(self, cond_addr, OP_COND_WAIT, inst);
@@ -806,8 +902,8 @@ void Controller::CondWait(thread_id_t self,
         if (it != wait_info.signal_set.end()) {
           wait_info.signal_set.erase(it);
           if (!wait_info.timed && wait_info.signal_set.empty()) {
-            DEBUG_ASSERT(enable_table_[thd_id]);
-            enable_table_[thd_id] = false;
+            DEBUG_ASSERT(IsEnabled(thd_id));
+            SetEnabled(thd_id, false);
           }
         }
       }
@@ -819,7 +915,7 @@ void Controller::CondWait(thread_id_t self,
 int Controller::CondTimedwait(thread_id_t self,
                               address_t cond_addr,
                               Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
   int ret_val = 0;
 
   // wait on the cond variable
@@ -857,8 +953,8 @@ int Controller::CondTimedwait(thread_id_t self,
           if (it != wait_info.signal_set.end()) {
             wait_info.signal_set.erase(it);
             if (!wait_info.timed && wait_info.signal_set.empty()) {
-              DEBUG_ASSERT(enable_table_[thd_id]);
-              enable_table_[thd_id] = false;
+              DEBUG_ASSERT(IsEnabled(thd_id));
+              SetEnabled(thd_id, false);
             }
           }
         }
@@ -873,20 +969,20 @@ int Controller::CondTimedwait(thread_id_t self,
 void Controller::BarrierWait(thread_id_t self,
                              address_t barrier_addr,
                              Inst *inst) {
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
 
   BarrierInfo *barrier_info = GetBarrierInfo(barrier_addr, inst);
   DEBUG_ASSERT(barrier_info->count > 0);
   if (barrier_info->wait_queue.size() + 1 < barrier_info->count) {
     // wait for other threads to reach the barrier
-    enable_table_[self] = false;
+    SetEnabled(self, false);
     barrier_info->wait_queue.push_back(self);
   } else {
     // all threads reach the barrier, wakeup
     for (BarrierInfo::WaitQueue::iterator it = barrier_info->wait_queue.begin();
          it != barrier_info->wait_queue.end(); ++it) {
-      DEBUG_ASSERT(!enable_table_[*it]);
-      enable_table_[*it] = true;
+      DEBUG_ASSERT(!IsEnabled(*it));
+      SetEnabled(*it, true);
     }
     barrier_info->wait_queue.clear();
   }
@@ -920,35 +1016,32 @@ State *Controller::CreateState() {
 //      if (it->second) {
 //        Action *action = action_table_[it->first];
 //        DEBUG_ASSERT(action);
-//        DEBUG_ASSERT(enable_table_[it->first]);
+//        DEBUG_ASSERT(IsEnabled(it->first));
 //        state->AddEnabled(action);
 //        return state;
 //      }
 //    }
 //  }
 
-  // normal mode
-  for (std::map<thread_id_t, Action *>::iterator it = action_table_.begin();
-       it != action_table_.end(); ++it) {
-    thread_id_t thd_id = it->first;
-    Action *action = it->second;
-    if (action && enable_table_[thd_id]) {
-      state->AddEnabled(action);
+  // the clock may have passed the deadlines of some sleepers
+  WakeSleepers();
+  if (!num_enabled_)
+    return state;
+
+  // normal mode (visit the enabled slots that have a pending action)
+  for (size_t i = 0; i < enabled_mask_.size(); i++) {
+    uint64 bits = enabled_mask_[i] & pending_mask_[i];
+    while (bits) {
+      size_t idx = i * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+      state->AddEnabled(slots_[idx]->action);
     }
   }
   return state;
 }
 
 bool Controller::AllThreadsInactive() {
-  if(active_table_.empty()) {
-    return false;
-  }
-  for(const auto& tid_bool : active_table_) {
-    if(tid_bool.second) {
-      return false;
-    }
-  }
-  return true;
+  return !slots_.empty() && num_active_ == 0;
 }
 
 void Controller::WaitForNextState() {
@@ -996,14 +1089,31 @@ State *Controller::Execute(State *state, Action *action) {
 //  }
   
   
+  // end the execution if it runs for too long
+  CheckWatchdog();
+
+  if (schedule_)
+    schedule_->Record(action->thd());
+
   // grant permission
-  thread_id_t target = thread_reverse_table_[action->thd()];
-  active_table_[target] = true;
-  SemPost(perm_sem_table_[target]);
+  uint64 start_time = TimeUs();
+  ThreadSlot *target = GetSlot(action->thd());
+  SetActive(target, true);
+  SemPost(target->perm_sem);
   // wait for the next state
   WaitForNextState();
+  STAT_INC("us_handoff", TimeUs() - start_time);
+  STAT_INC("num_handoff", 1);
+  num_steps_++;
   // return the new state
   State *new_state = CreateState();
+  // the yield flag of the action is only known after it is executed. a
+  // failed trylock counts as a yield for the livelock detection only
+  if (livelock_windows_) {
+    bool yielded = action->IsYieldOp() || failed_trylock_;
+    progress_ctrl_.UpdateProgress(action, yielded, new_state);
+  }
+  failed_trylock_ = false;
   return new_state;
 }
 
@@ -1011,7 +1121,7 @@ Action *Controller::Schedule(thread_id_t self,
                              address_t iaddr,
                              Operation op,
                              Inst *inst) {
-//  std::cout << "Thread " << thread_table_[self]->uid() << " reached "
+//  std::cout << "Thread " << FindThread(self)->uid() << " reached "
 //      << Operation_Name(op) << std::endl;
 //  if(inst) {
 //    std::cout << " at: " << 
@@ -1020,7 +1130,8 @@ Action *Controller::Schedule(thread_id_t self,
   // create the action
   Action *action = CreateAction(self, iaddr, op, inst);
   // register action
-  action_table_[self] = action;
+  ThreadSlot *slot = GetSlot(self);
+  SetPending(slot, action);
   // check flag next_state_ready
 //  if (!next_state_ready_) {
 //    // by setting this flag, other runnable threads will
@@ -1036,14 +1147,14 @@ Action *Controller::Schedule(thread_id_t self,
 //    SemPost(next_state_sem_);
 //  }
   // wait for permission to proceed
-  active_table_[self] = false;
+  SetActive(slot, false);
   UnlockKernel();
-  SemWait(perm_sem_table_[self]);
+  SemWait(slot->perm_sem);
   LockKernel();
-  DEBUG_ASSERT(enable_table_[self]);
-  assert(active_table_[self]);
+  DEBUG_ASSERT(slot->enabled);
+  assert(slot->active);
   // unregister action
-  action_table_[self] = NULL;
+  SetPending(slot, NULL);
   // return the action
   return action;
 }
@@ -1070,7 +1181,9 @@ Thread::Vec &Controller::GetThreadCreationOrder() {
 void Controller::SetScheduler(Scheduler *scheduler) {
   if (scheduler_)
     Abort("please choose only one scheduler\n");
+  uint64 start_time = TimeUs();
   scheduler->Setup();
+  STAT_INC("us_sched_load", TimeUs() - start_time);
   desc_.Merge(scheduler->desc());
   scheduler_ = scheduler;
 }
@@ -1143,6 +1256,7 @@ Controller::MutexInfo *Controller::GetMutexInfo(address_t iaddr, Inst *inst) {
   Region::Map::iterator regit = FindRegion(iaddr, inst);
   if(regit == region_table_.end()) {
     std::cout << "ERROR: Use of oob mutex." << std::endl;
+    bug_kind_ = "mutex_oob";
     ProgramExit(1, NULL);
     exit(1);
   }
@@ -1156,6 +1270,7 @@ Controller::MutexInfo *Controller::GetMutexInfo(address_t iaddr, Inst *inst) {
     mutex_info = it->second;
     if(mutex_info->free) {
       std::cout << "ERROR: Use of mutex after free" << std::endl;
+      bug_kind_ = "mutex_after_free";
       ProgramExit(1, NULL);
       exit(1);
     }
@@ -1168,6 +1283,7 @@ Controller::CondInfo *Controller::GetCondInfo(address_t iaddr, Inst *inst) {
   Region::Map::iterator regit = FindRegion(iaddr, inst);
   if(regit == region_table_.end()) {
     std::cout << "ERROR: Use of oob cond." << std::endl;
+    bug_kind_ = "cond_oob";
     ProgramExit(1, NULL);
     exit(1);
   }
@@ -1182,6 +1298,7 @@ Controller::CondInfo *Controller::GetCondInfo(address_t iaddr, Inst *inst) {
     cond_info = it->second;
     if(cond_info->free) {
       std::cout << "ERROR: Use of cond after free" << std::endl;
+      bug_kind_ = "cond_after_free";
       ProgramExit(1, NULL);
       exit(1);
     }
@@ -1194,6 +1311,7 @@ Controller::BarrierInfo *Controller::GetBarrierInfo(address_t iaddr, Inst *inst)
   Region::Map::iterator regit = FindRegion(iaddr, inst);
   if(regit == region_table_.end()) {
     std::cout << "ERROR: Use of oob barrier." << std::endl;
+    bug_kind_ = "barrier_oob";
     ProgramExit(1, NULL);
     exit(1);
   }
@@ -1208,6 +1326,7 @@ Controller::BarrierInfo *Controller::GetBarrierInfo(address_t iaddr, Inst *inst)
     barrier_info = it->second;
     if(barrier_info->free) {
       std::cout << "ERROR: Use of barrier after free" << std::endl;
+      bug_kind_ = "barrier_after_free";
       ProgramExit(1, NULL);
       exit(1);
     }
@@ -1240,13 +1359,67 @@ Object *Controller::GetObject(address_t iaddr, Inst *inst) {
 }
 
 Thread *Controller::FindThread(thread_id_t thd_id) {
-  std::map<thread_id_t, Thread *>::iterator it = thread_table_.find(thd_id);
-  if (it == thread_table_.end())
+  ThreadSlot *slot = FindSlot(thd_id);
+  return slot ? slot->thd : NULL;
+}
+
+Controller::ThreadSlot *Controller::FindSlot(thread_id_t thd_id) {
+  ThreadSlot::Map::iterator it = slot_table_.find(thd_id);
+  if (it == slot_table_.end())
     return NULL;
   else
     return it->second;
 }
 
+Controller::ThreadSlot *Controller::GetSlot(thread_id_t thd_id) {
+  ThreadSlot *slot = FindSlot(thd_id);
+  DEBUG_ASSERT(slot);
+  return slot;
+}
+
+Controller::ThreadSlot *Controller::GetSlot(Thread *thd) {
+  DEBUG_ASSERT(thd->uid() < uid_slots_.size() && uid_slots_[thd->uid()]);
+  return uid_slots_[thd->uid()];
+}
+
+void Controller::SetEnabled(thread_id_t thd_id, bool enabled) {
+  SetEnabled(GetSlot(thd_id), enabled);
+}
+
+void Controller::SetEnabled(ThreadSlot *slot, bool enabled) {
+  if (slot->enabled == enabled)
+    return;
+  slot->enabled = enabled;
+  SetBit(&enabled_mask_, slot->idx, enabled);
+  if (enabled)
+    num_enabled_++;
+  else
+    num_enabled_--;
+}
+
+void Controller::SetActive(ThreadSlot *slot, bool active) {
+  if (slot->active == active)
+    return;
+  slot->active = active;
+  if (active)
+    num_active_++;
+  else
+    num_active_--;
+}
+
+void Controller::SetPending(ThreadSlot *slot, Action *action) {
+  slot->action = action;
+  SetBit(&pending_mask_, slot->idx, action != NULL);
+}
+
+void Controller::SetBit(std::vector<uint64> *mask, size_t idx, bool value) {
+  uint64 bit = (uint64)1 << (idx % 64);
+  if (value)
+    (*mask)[idx / 64] |= bit;
+  else
+    (*mask)[idx / 64] &= ~bit;
+}
+
 Controller::Region::Map::iterator Controller::FindRegion(address_t iaddr, Inst *inst) {
   // iaddr is an aligned unit address
   if (region_table_.begin() == region_table_.end())
@@ -1396,6 +1569,154 @@ Object::idx_t Controller::GetCreatorIdx(thread_id_t thd_id, Inst *inst) {
   return ++new_info->curr_creator_idx;
 }
 
+void Controller::CheckWatchdog() {
+  int code = 0;
+  if (max_steps_ && num_steps_ >= max_steps_) {
+    std::cout << "PROBLEM: step limit reached (" << num_steps_
+              << " steps)" << std::endl;
+    bug_kind_ = "step_limit";
+    code = STEP_LIMIT_EXIT_CODE;
+  } else if (livelock_windows_ &&
+             progress_ctrl_.idle_windows() >= livelock_windows_) {
+    std::cout << "PROBLEM: livelock (" << progress_ctrl_.idle_windows()
+              << " idle windows)" << std::endl;
+    bug_kind_ = "livelock";
+    code = LIVELOCK_EXIT_CODE;
+  }
+  if (!code)
+    return;
+
+  // end this execution only. the state so far is saved as usual so
+  // that the search moves on to the next schedule
+  fflush(stdout);
+  ProgramExit(code, 0);
+  exit(code);
+}
+
+void Controller::RecordSchedule() {
+  if (knob_->ValueStr("schedule_out").empty())
+    return;
+  schedule_ = new RecordedSchedule;
+  // the knobs that decide which operations are scheduled
+  std::stringstream ss;
+  ss << knob_->ValueInt("unit_size");
+  schedule_->SetKnob("unit_size", ss.str());
+  schedule_->SetKnob("sched_app", sched_app_ ? "1" : "0");
+  schedule_->SetKnob("sched_race", sched_race_ ? "1" : "0");
+  schedule_->SetKnob("check_mem", check_mem_ ? "1" : "0");
+  if (knob_->ValueBool("use_seed")) {
+    ss.str("");
+    ss << knob_->ValueInt("seed");
+    schedule_->SetKnob("seed", ss.str());
+  }
+}
+
+void Controller::TimedSleep(thread_id_t self, Inst *inst, Operation op,
+                            uint64 time, bool absolute) {
+  LockKernel();
+  DEBUG_ASSERT(IsEnabled(self));
+  // the sleeper is disabled until the virtual clock reaches its deadline
+  // (see WakeSleepers), an absolute time is on the virtual clock seen by
+  // the program and must be read under the kernel lock
+  uint64 deadline = vtime_ + time;
+  if (absolute) {
+    uint64 now = vtime_base_ + vtime_;
+    deadline = vtime_ + (time > now ? time - now : 0);
+  }
+  sleep_deadlines_[self] = deadline;
+  SetEnabled(self, false);
+  // schedule point
+  Action *action = Schedule(self, 0, op, inst);
+  action->set_yield(true);
+  UnlockKernel();
+}
+
+void Controller::WakeSleepers() {
+  if (sleep_deadlines_.empty())
+    return;
+  if (!num_enabled_) {
+    // no other thread can run, jump to the earliest deadline
+    uint64 earliest = sleep_deadlines_.begin()->second;
+    for (std::map<thread_id_t, uint64>::iterator it = sleep_deadlines_.begin();
+         it != sleep_deadlines_.end(); ++it) {
+      if (it->second < earliest)
+        earliest = it->second;
+    }
+    if (vtime_ < earliest)
+      vtime_ = earliest;
+  }
+  // enable the sleepers whose deadlines have passed
+  std::map<thread_id_t, uint64>::iterator it = sleep_deadlines_.begin();
+  while (it != sleep_deadlines_.end()) {
+    if (it->second <= vtime_) {
+      SetEnabled(it->first, true);
+      sleep_deadlines_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool Controller::IsVirtualClock(clockid_t clk) {
+  // the cpu time clocks stay real
+  switch (clk) {
+    case CLOCK_REALTIME:
+    case CLOCK_MONOTONIC:
+#ifdef CLOCK_MONOTONIC_RAW
+    case CLOCK_MONOTONIC_RAW:
+#endif
+#ifdef CLOCK_REALTIME_COARSE
+    case CLOCK_REALTIME_COARSE:
+    case CLOCK_MONOTONIC_COARSE:
+#endif
+#ifdef CLOCK_BOOTTIME
+    case CLOCK_BOOTTIME:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint64 Controller::ReadClock() {
+  // every read moves the clock forward so that polling loops that wait
+  // for a time to pass terminate
+  LockKernel();
+  vtime_ += vtime_tick_;
+  uint64 now = vtime_base_ + vtime_;
+  UnlockKernel();
+  return now;
+}
+
+void Controller::WriteResult() {
+  std::string path = knob_->ValueStr("result_out");
+  if (result_written_ || path.empty())
+    return;
+  result_written_ = true;
+
+  // one json object per execution, the runner adds its own fields
+  std::stringstream ss;
+  ss << "{\"bug\": \"" << bug_kind_ << "\"";
+  ss << ", \"steps\": " << num_steps_;
+  ss << ", \"sched_steps\": " << scheduler_->NumSteps();
+  ss << ", \"preemptions\": " << scheduler_->NumPreemptions();
+  ss << ", \"threads\": " << thread_creation_order_.size();
+  if (knob_->ValueBool("use_seed"))
+    ss << ", \"seed\": " << knob_->ValueInt("seed");
+  ss << ", \"us_program\": " << TimeUs() - program_start_time_;
+  ss << "}" << std::endl;
+
+  std::fstream out(path.c_str(), std::ios::out | std::ios::trunc);
+  out << ss.str();
+  out.close();
+}
+
+uint64 Controller::TimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64)tv.tv_sec * 1000000 + (uint64)tv.tv_usec;
+}
+
 void Controller::__SchedulerThread(VOID *arg) {
   ((Controller *)ctrl_)->HandleSchedulerThread();
 }
@@ -1454,7 +1775,7 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadCreate, Controller) {
                       inst);
 
   LockKernel();
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
   // schedule point
   Schedule(self, 0, OP_THREAD_CREATE, inst);
   UnlockKernel();
@@ -1472,7 +1793,7 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadCreate, Controller) {
                       child_thd_id);
   
   LockKernel();
-  while(active_table_.at(child_thd_id) == true) {
+  while(IsActive(child_thd_id)) {
     UnlockKernel();
     Yield();
     LockKernel();
@@ -1496,10 +1817,10 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadJoin, Controller) {
                       child);
 
   LockKernel();
-  DEBUG_ASSERT(enable_table_[self]);
+  DEBUG_ASSERT(IsEnabled(self));
   JoinInfo *join_info = GetJoinInfo(child);
   if (!join_info->exit) {
-    enable_table_[self] = false;
+    SetEnabled(self, false);
     join_info->wait_queue.push_back(self);
   }
   // schedule point
@@ -1792,7 +2113,7 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadBarrierInit, Controller) {
     wrapper->CallOriginal();
     assert(wrapper->ret_val() == 0);
     LockKernel();
-    DEBUG_ASSERT(enable_table_[self]);
+    DEBUG_ASSERT(IsEnabled(self));
     address_t barrier_addr = (address_t)wrapper->arg0();
     DEBUG_ASSERT(UNIT_DOWN_ALIGN(barrier_addr, unit_size_) == barrier_addr);
     // schedule point
@@ -1804,6 +2125,7 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadBarrierInit, Controller) {
     UnlockKernel();
     if(barrier_info->count == 0) {
       std::cout << "ERROR: inited barrier with 0 participants" << std::endl;
+      bug_kind_ = "barrier_zero";
       ProgramExit(1,0);
       exit(1);
     }
@@ -1851,13 +2173,17 @@ IMPLEMENT_WRAPPER_HANDLER(PthreadBarrierWait, Controller) {
 }
 
 IMPLEMENT_WRAPPER_HANDLER(Sleep, Controller) {
-  if (scheduler_->desc()->HookYieldFunc()) {
+  if (virtual_time_ && FindThread(Self())) {
+    TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_SLEEP,
+               (uint64)wrapper->arg0() * 1000000000, false);
+    wrapper->set_ret_val(0);
+  } else if (scheduler_->desc()->HookYieldFunc()) {
     // simulated function
     thread_id_t self = Self();
     Inst *inst = GetInst(wrapper->ret_addr());
 
     LockKernel();
-    DEBUG_ASSERT(enable_table_[self]);
+    DEBUG_ASSERT(IsEnabled(self));
     // schedule point
     Action *action = Schedule(self, 0, OP_SLEEP, inst);
     action->set_yield(true);
@@ -1868,13 +2194,17 @@ IMPLEMENT_WRAPPER_HANDLER(Sleep, Controller) {
 }
 
 IMPLEMENT_WRAPPER_HANDLER(Usleep, Controller) {
-  if (scheduler_->desc()->HookYieldFunc()) {
+  if (virtual_time_ && FindThread(Self())) {
+    TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_USLEEP,
+               (uint64)wrapper->arg0() * 1000, false);
+    wrapper->set_ret_val(0);
+  } else if (scheduler_->desc()->HookYieldFunc()) {
     // simulated function
     thread_id_t self = Self();
     Inst *inst = GetInst(wrapper->ret_addr());
 
     LockKernel();
-    DEBUG_ASSERT(enable_table_[self]);
+    DEBUG_ASSERT(IsEnabled(self));
     // schedule point
     Action *action = Schedule(self, 0, OP_USLEEP, inst);
     action->set_yield(true);
@@ -1891,7 +2221,7 @@ IMPLEMENT_WRAPPER_HANDLER(SchedYield, Controller) {
     Inst *inst = GetInst(wrapper->ret_addr());
 
     LockKernel();
-    DEBUG_ASSERT(enable_table_[self]);
+    DEBUG_ASSERT(IsEnabled(self));
     // schedule point
     Action *action = Schedule(self, 0, OP_SCHED_YIELD, inst);
     action->set_yield(true);
@@ -1901,6 +2231,129 @@ IMPLEMENT_WRAPPER_HANDLER(SchedYield, Controller) {
   }
 }
 
+IMPLEMENT_WRAPPER_HANDLER(Nanosleep, Controller) {
+  const struct timespec *req = wrapper->arg0();
+  if (!virtual_time_ || !req || !FindThread(Self())) {
+    wrapper->CallOriginal();
+    return;
+  }
+  TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_NANOSLEEP,
+             (uint64)req->tv_sec * 1000000000 + (uint64)req->tv_nsec,
+             false);
+  if (wrapper->arg1()) {
+    wrapper->arg1()->tv_sec = 0;
+    wrapper->arg1()->tv_nsec = 0;
+  }
+  wrapper->set_ret_val(0);
+}
+
+IMPLEMENT_WRAPPER_HANDLER(ClockNanosleep, Controller) {
+  const struct timespec *req = wrapper->arg2();
+  if (!virtual_time_ || !req || !IsVirtualClock(wrapper->arg0()) ||
+      !FindThread(Self())) {
+    wrapper->CallOriginal();
+    return;
+  }
+  TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_NANOSLEEP,
+             (uint64)req->tv_sec * 1000000000 + (uint64)req->tv_nsec,
+             (wrapper->arg1() & TIMER_ABSTIME) != 0);
+  wrapper->set_ret_val(0);
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Gettimeofday, Controller) {
+  wrapper->CallOriginal();
+  if (virtual_time_ && wrapper->ret_val() == 0 && wrapper->arg0()) {
+    uint64 now = ReadClock();
+    wrapper->arg0()->tv_sec = now / 1000000000;
+    wrapper->arg0()->tv_usec = (now % 1000000000) / 1000;
+  }
+}
+
+IMPLEMENT_WRAPPER_HANDLER(ClockGettime, Controller) {
+  wrapper->CallOriginal();
+  if (virtual_time_ && wrapper->ret_val() == 0 && wrapper->arg1() &&
+      IsVirtualClock(wrapper->arg0())) {
+    uint64 now = ReadClock();
+    wrapper->arg1()->tv_sec = now / 1000000000;
+    wrapper->arg1()->tv_nsec = now % 1000000000;
+  }
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Poll, Controller) {
+  int timeout = wrapper->arg2();
+  if (!virtual_time_ || timeout <= 0 || !FindThread(Self())) {
+    // no timeout or an infinite one, really wait
+    wrapper->CallOriginal();
+    return;
+  }
+  // check the fds without blocking
+  wrapper->set_arg2(0);
+  wrapper->CallOriginal();
+  if (wrapper->ret_val() != 0)
+    return;
+  // nothing is ready, let the timeout pass in virtual time and check again
+  TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_NANOSLEEP,
+             (uint64)timeout * 1000000, false);
+  wrapper->CallOriginal();
+}
+
+IMPLEMENT_WRAPPER_HANDLER(Select, Controller) {
+  struct timeval *timeout = wrapper->arg4();
+  if (!virtual_time_ || !timeout ||
+      (timeout->tv_sec == 0 && timeout->tv_usec == 0) ||
+      !FindThread(Self())) {
+    wrapper->CallOriginal();
+    return;
+  }
+  uint64 duration = (uint64)timeout->tv_sec * 1000000000 +
+                    (uint64)timeout->tv_usec * 1000;
+  // select clears the sets when nothing is ready, keep them for the retry
+  fd_set *sets[3] = { wrapper->arg1(), wrapper->arg2(), wrapper->arg3() };
+  fd_set saved[3];
+  for (int i = 0; i < 3; i++) {
+    if (sets[i])
+      saved[i] = *sets[i];
+  }
+  // check the fds without blocking
+  struct timeval zero;
+  zero.tv_sec = 0;
+  zero.tv_usec = 0;
+  wrapper->set_arg4(&zero);
+  wrapper->CallOriginal();
+  if (wrapper->ret_val() != 0)
+    return;
+  // nothing is ready, let the timeout pass in virtual time and check again
+  TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_NANOSLEEP, duration,
+             false);
+  for (int i = 0; i < 3; i++) {
+    if (sets[i])
+      *sets[i] = saved[i];
+  }
+  wrapper->CallOriginal();
+  if (wrapper->ret_val() == 0) {
+    // linux reports the time left
+    timeout->tv_sec = 0;
+    timeout->tv_usec = 0;
+  }
+}
+
+IMPLEMENT_WRAPPER_HANDLER(EpollWait, Controller) {
+  int timeout = wrapper->arg3();
+  if (!virtual_time_ || timeout <= 0 || !FindThread(Self())) {
+    wrapper->CallOriginal();
+    return;
+  }
+  // check the events without blocking
+  wrapper->set_arg3(0);
+  wrapper->CallOriginal();
+  if (wrapper->ret_val() != 0)
+    return;
+  // nothing is ready, let the timeout pass in virtual time and check again
+  TimedSleep(Self(), GetInst(wrapper->ret_addr()), OP_NANOSLEEP,
+             (uint64)timeout * 1000000, false);
+  wrapper->CallOriginal();
+}
+
 IMPLEMENT_WRAPPER_HANDLER(Malloc, Controller) {
   thread_id_t self = Self();
   Inst *inst = GetInst(wrapper->ret_addr());
@@ -2034,12 +2487,15 @@ void Controller::HandleSignalReceived(THREADID tid, INT32 sig,
   
   if(sig != SIGINT) {
     std::cout << "ERROR: signal " << sig << " !!!!" << std::endl;
+    bug_kind_ = "signal";
+  } else {
+    bug_kind_ = "interrupted";
   }
   
-  for(auto& tid_bool : enable_table_) {
-    std::cout << "Stack for thread " << thread_table_[tid_bool.first]->uid() 
+  for(auto slot : slots_) {
+    std::cout << "Stack for thread " << slot->thd->uid() 
         << ":" << std::endl;
-    std::cout << callstack_info_->GetCallStack(tid_bool.first)->ToString();
+    std::cout << GetCallStack(slot->thd_id)->ToString();
   }
   ProgramExit(1,0);
   exit(1);
@@ -2053,7 +2509,7 @@ void Controller::HandleSyscallEntry(THREADID tid, CONTEXT* ctxt,
     {
       if(control_cs_) {
         thread_id_t self = Self();
-        thread_table_[self]->enable_nondet_switches_ = true;
+        GetSlot(self)->thd->enable_nondet_switches_ = true;
         std::cout << "sched_get_priority_max" << std::endl;
       }
       break;
@@ -2062,7 +2518,7 @@ void Controller::HandleSyscallEntry(THREADID tid, CONTEXT* ctxt,
     {
       if(control_cs_) {
         thread_id_t self = Self();
-        thread_table_[self]->enable_nondet_switches_ = false;
+        GetSlot(self)->thd->enable_nondet_switches_ = false;
         std::cout << "sched_get_priority_min" << std::endl;
       }
       break;
@@ -2078,18 +2534,25 @@ void Controller::HandleSyscallEntry(THREADID tid, CONTEXT* ctxt,
 //      //PIN_AssignRegval(&ip, (const UINT64 *)&address, PIN_GetRegvalSize(&ip));
 //      //PIN_SetContextRegval(ctxt, REG_IP, &ip);
 //      PIN_SetContextReg(ctxt, REG_IP, (ADDRINT)address);
-      PIN_SetSyscallNumber(ctxt, std, SYS_getpid);
-      PIN_UnlockClient();
-      ReleaseVmLock();
+      // if some analyzer hooks all syscalls, we are in the pin syscall
+      // callback (rather than an analysis routine), holding its locks
+      bool in_callback = desc_.HookAllSyscalls();
+      if (in_callback) {
+        PIN_SetSyscallNumber(ctxt, std, SYS_getpid);
+        PIN_UnlockClient();
+        ReleaseVmLock();
+      }
       LockKernel();
       program_exiting_ =  true;
       thread_id_t self = Self();
-      enable_table_[self] = false;
+      SetEnabled(self, false);
       Schedule(self, 0, OP_THREAD_END, 0);
       assert(0 && "Got past EXIT"); 
       UnlockKernel();
-      GetVmLock();
-      PIN_LockClient();
+      if (in_callback) {
+        GetVmLock();
+        PIN_LockClient();
+      }
 //      ProgramExit(status,0);
 //      exit(status);
     }
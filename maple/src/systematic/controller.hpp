@@ -22,12 +22,20 @@
 
 #include "core/basictypes.h"
 #include "core/execution_control.hpp"
+#include "core/stat.h"
 #include "race/race.h"
 #include "race/djit.h"
 #include "systematic/scheduler.h"
 #include "systematic/random.h"
 #include "systematic/pct_random.h"
+#include "systematic/replay.h"
+#include "systematic/schedule.h"
 #include "systematic/chess.h"
+#include "systematic/fair.h"
+
+// exit codes of executions ended by the watchdog
+#define STEP_LIMIT_EXIT_CODE 78
+#define LIVELOCK_EXIT_CODE 79
 
 
 namespace systematic {
@@ -55,6 +63,35 @@ class Controller : public ExecutionControl, public ControllerInterface {
     WaitQueue wait_queue;
   };
 
+  // define the controller state of a thread, one slot per thread in
+  // the order they start (slots are cache line aligned to avoid false
+  // sharing between threads that update their own slots)
+  class ThreadSlot {
+   public:
+    typedef std::vector<ThreadSlot *> Vec;
+    typedef std::tr1::unordered_map<thread_id_t, ThreadSlot *> Map;
+
+    ThreadSlot()
+        : idx(0),
+          thd_id(INVALID_THD_ID),
+          thd(NULL),
+          perm_sem(NULL),
+          action(NULL),
+          num_children(0),
+          enabled(false),
+          active(false) {}
+    ~ThreadSlot() {}
+
+    size_t idx; // the dense slot index
+    thread_id_t thd_id;
+    Thread *thd;
+    Semaphore *perm_sem; // the permission to proceed
+    Action *action; // the pending action (NULL if running)
+    Thread::idx_t num_children; // the number of threads created
+    bool enabled;
+    bool active; // whether in free state
+  } __attribute__((aligned(64)));
+
   // define a mutex info
   class MutexInfo {
    public:
@@ -241,6 +278,16 @@ class Controller : public ExecutionControl, public ControllerInterface {
   BarrierInfo *GetBarrierInfo(address_t iaddr, Inst *inst);
   Object *GetObject(address_t iaddr, Inst *inst);
   Thread *FindThread(thread_id_t thd_id);
+  ThreadSlot *FindSlot(thread_id_t thd_id);
+  ThreadSlot *GetSlot(thread_id_t thd_id);
+  ThreadSlot *GetSlot(Thread *thd);
+  bool IsEnabled(thread_id_t thd_id) { return GetSlot(thd_id)->enabled; }
+  bool IsActive(thread_id_t thd_id) { return GetSlot(thd_id)->active; }
+  void SetEnabled(thread_id_t thd_id, bool enabled);
+  void SetEnabled(ThreadSlot *slot, bool enabled);
+  void SetActive(ThreadSlot *slot, bool active);
+  void SetPending(ThreadSlot *slot, Action *action);
+  static void SetBit(std::vector<uint64> *mask, size_t idx, bool value);
   Region::Map::iterator FindRegion(address_t iaddr, Inst *inst);
   void AllocSRegion(address_t addr, size_t size, Image *image);
   void AllocDRegion(address_t addr, size_t size, Inst *inst);
@@ -250,12 +297,23 @@ class Controller : public ExecutionControl, public ControllerInterface {
   void FreeCondInfo(Region *region);
   void FreeBarrierInfo(Region *region);
   Object::idx_t GetCreatorIdx(thread_id_t thd_id, Inst *inst);
+  static uint64 TimeUs();
+  void WriteResult();
+  void CheckWatchdog();
+  void RecordSchedule();
+  void TimedSleep(thread_id_t self, Inst *inst, Operation op,
+                  uint64 time, bool absolute);
+  void WakeSleepers();
+  bool IsVirtualClock(clockid_t clk);
+  uint64 ReadClock();
 
   // settings and flags
   Scheduler *scheduler_; // the scheduler that controls the execution
   RandomScheduler *random_scheduler_;
   ChessScheduler *chess_scheduler_;
   PCTRandomScheduler *pct_scheduler_;
+  ReplayScheduler *replay_scheduler_;
+  RecordedSchedule *schedule_; // the recorded schedule (NULL if not recording)
   Program *program_; // the modeled program
   Execution *execution_; // the current execution of the modeled program
   race::RaceDB *race_db_;
@@ -266,18 +324,39 @@ class Controller : public ExecutionControl, public ControllerInterface {
   bool check_mem_; // whether to check memory out of bounds
   bool control_cs_;
 
+  // throughput timers (in microseconds, reported through stat_out)
+  uint64 setup_start_time_; // when the tool starts setting up
+  uint64 program_start_time_; // when the program starts
+
+  // per execution result record
+  const char *bug_kind_; // the kind of bug found ("none" if no bug)
+  uint64 num_steps_; // the number of visible operations executed
+  bool result_written_;
+
+  // watchdog
+  uint64 max_steps_; // the maximum number of steps (0 for no limit)
+  uint64 livelock_windows_; // the idle windows in a row (0 for no limit)
+  FairControl progress_ctrl_; // tracks the idle windows
+  bool failed_trylock_; // whether the last action is a failed trylock
+
+  // virtual time (in nanoseconds)
+  bool virtual_time_; // whether sleeps, timeouts and clock reads are virtual
+  uint64 vtime_; // the virtual time passed since the program started
+  uint64 vtime_tick_; // the virtual time that passes at each clock read
+  uint64 vtime_base_; // the real time when the program started
+  std::map<thread_id_t, uint64> sleep_deadlines_; // the disabled sleepers
   // global analysis states
   PIN_THREAD_UID scheduler_thd_uid_; // the pin uid for the scheduler thread
   bool volatile program_exiting_; // whether the program is about to exit
   bool next_state_ready_; // whether the next state is ready
   Semaphore *next_state_sem_; // used to notify the scheduler thread
-  std::map<thread_id_t, Semaphore *> perm_sem_table_;
-  std::map<thread_id_t, Thread *> thread_table_;
-  std::map<Thread *, thread_id_t> thread_reverse_table_;
-  std::map<thread_id_t, Action *> action_table_;
-  std::map<thread_id_t, bool> enable_table_;
-  std::map<thread_id_t, bool> active_table_; // whether in free state
-  std::map<thread_id_t, Thread::idx_t> thread_creation_info_;
+  ThreadSlot::Vec slots_; // indexed by slot index
+  ThreadSlot::Map slot_table_; // thread id to slot
+  ThreadSlot::Vec uid_slots_; // indexed by thread uid
+  size_t num_enabled_; // the number of enabled threads
+  size_t num_active_; // the number of threads in free state
+  std::vector<uint64> enabled_mask_; // bit per slot
+  std::vector<uint64> pending_mask_; // bit per slot with a pending action
   CreationInfo::HashMap creation_info_;
   Region::Map region_table_;
   JoinInfo::Map join_info_table_;
@@ -285,7 +364,6 @@ class Controller : public ExecutionControl, public ControllerInterface {
   Thread::Vec  thread_creation_order_;
 
   // racy memory op related
-  std::map<thread_id_t, bool> race_active_table_;
   address_t tls_race_read_addr_[PIN_MAX_THREADS];
   size_t tls_race_read_size_[PIN_MAX_THREADS];
   address_t tls_race_write_addr_[PIN_MAX_THREADS];
@@ -326,6 +404,13 @@ class Controller : public ExecutionControl, public ControllerInterface {
   DECLARE_MEMBER_WRAPPER_HANDLER(Sleep);
   DECLARE_MEMBER_WRAPPER_HANDLER(Usleep);
   DECLARE_MEMBER_WRAPPER_HANDLER(SchedYield);
+  DECLARE_MEMBER_WRAPPER_HANDLER(Nanosleep);
+  DECLARE_MEMBER_WRAPPER_HANDLER(ClockNanosleep);
+  DECLARE_MEMBER_WRAPPER_HANDLER(Gettimeofday);
+  DECLARE_MEMBER_WRAPPER_HANDLER(ClockGettime);
+  DECLARE_MEMBER_WRAPPER_HANDLER(Poll);
+  DECLARE_MEMBER_WRAPPER_HANDLER(Select);
+  DECLARE_MEMBER_WRAPPER_HANDLER(EpollWait);
   
   DECLARE_MEMBER_WRAPPER_HANDLER(Exit);
 
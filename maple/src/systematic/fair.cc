@@ -18,6 +18,8 @@
 
 #include "systematic/fair.h"
 
+#include <algorithm>
+
 #include "core/logging.h"
 
 namespace systematic {
@@ -30,15 +32,20 @@ bool FairControl::Enabled(State *curr_state, Action *next_action) {
   // relatively higher priority that thd (i.e. check whether
   // (thd, x) exists in P such that x is enabled). if yes, return
   // false, otherwise return true
-  for (ThreadRelation::iterator it = p_.begin(); it != p_.end(); ++it) {
-    if (it->first == thd && curr_state->IsEnabled(it->second)) {
-      return false;
-    }
+  if (thd->uid() >= p_.size())
+    return true;
+  if (curr_state != enabled_state_) {
+    enabled_state_ = curr_state;
+    GetEnabled(curr_state, &enabled_);
   }
-  return true;
+  return !p_[thd->uid()].Intersects(enabled_);
 }
 
 void FairControl::Update(State *curr_state) {
+  // get the enabled threads of the current state
+  enabled_state_ = curr_state;
+  GetEnabled(curr_state, &enabled_);
+
   // get the previous state
   State *prev_state = curr_state->Prev();
   if (!prev_state)
@@ -48,134 +55,162 @@ void FairControl::Update(State *curr_state) {
   Action *t_action = prev_state->taken();
   DEBUG_ASSERT(t_action);
   Thread *t = t_action->thd();
+  Thread::uid_t tu = t->uid();
+  Track(tu);
 
   // removes all edges with sink t from P to decrease the
   // relative priority of t (line 13)
-  for (ThreadRelation::iterator pit = p_.begin(); pit != p_.end(); ) {
-    if (pit->second == t)
-      pit = p_.erase(pit);
-    else
-      ++pit;
-  }
+  p_rev_[tu].ForEach([this, tu](Thread::uid_t u) { p_[u].Remove(tu); });
+  p_rev_[tu].Clear();
 
   // updates the auxiliary predicates for each thread
-  // update E[u] (line 15)
-  for (ThreadSetMap::iterator eit = e_.begin(); eit != e_.end(); ++eit) {
-    ThreadSet &eu = eit->second;
-    ThreadSet eu_td; // to delete
-    for (ThreadSet::iterator it = eu.begin(); it != eu.end(); ++it) {
-      if (!curr_state->IsEnabled(*it))
-        eu_td.insert(*it);
-    }
-    for (ThreadSet::iterator it = eu_td.begin(); it != eu_td.end(); ++it) {
-      eu.erase(*it);
-    }
-  }
-  // update D[u] (line 16 - 20)
-  for (ThreadSetMap::iterator dit = d_.begin(); dit != d_.end(); ++dit) {
-    if (dit->first == t) {
-      ThreadSet &du = dit->second;
-      Action::Map *prev_es = prev_state->enabled();
-      for (Action::Map::iterator it = prev_es->begin();
-           it != prev_es->end(); ++it) {
-        Thread *thd = it->first;
-        if (!curr_state->IsEnabled(thd))
-          du.insert(thd);
-      }
-    }
-  }
-  // update S[u] (line 21)
-  for (ThreadSetMap::iterator sit = s_.begin(); sit != s_.end(); ++sit) {
-    ThreadSet &su = sit->second;
-    su.insert(t);
+  tracked_.ForEach([this, tu](Thread::uid_t u) {
+    // update E[u] (line 15)
+    e_[u].Intersect(enabled_);
+    // update S[u] (line 21)
+    s_[u].Add(tu);
+  });
+  // update D[t] (line 16 - 20)
+  if (tracked_.Has(tu)) {
+    ThreadSet disabled;
+    GetEnabled(prev_state, &disabled);
+    disabled.Subtract(enabled_);
+    d_[tu].Union(disabled);
   }
 
   // update P if t is a yield
   if (t_action->IsYieldOp()) {
     // calculate H (line 24)
-    ThreadSet h;
-    ThreadSet &et = e_[t];
-    ThreadSet &dt = d_[t];
-    ThreadSet &st = s_[t];
-    for (ThreadSet::iterator it = et.begin(); it != et.end(); ++it) {
-      h.insert(*it);
-    }
-    for (ThreadSet::iterator it = dt.begin(); it != dt.end(); ++it) {
-      h.insert(*it);
-    }
-    for (ThreadSet::iterator it = st.begin(); it != st.end(); ++it) {
-      h.erase(*it);
-    }
+    ThreadSet h = e_[tu];
+    h.Union(d_[tu]);
+    h.Subtract(s_[tu]);
     // update P (line 25)
-    for (ThreadSet::iterator hit = h.begin(); hit != h.end(); ++hit) {
-      Thread *h = *hit;
-      // check whether (t, h) is in P
-      bool exist = false;
-      for (ThreadRelation::iterator pit = p_.begin(); pit != p_.end(); ++pit) {
-        if (pit->first == t && pit->second == h) {
-          exist = true;
-          break;
-        }
-      }
-      if (!exist) {
-        p_.push_back(ThreadPair(t, h));
-      }
-    }
+    p_[tu].Union(h);
+    h.ForEach([this, tu](Thread::uid_t u) { p_rev_[u].Add(tu); });
     // update E[t] (line 26)
-    et.clear();
-    Action::Map *curr_es = curr_state->enabled();
-    for (Action::Map::iterator it = curr_es->begin();
-         it != curr_es->end(); ++it) {
-      et.insert(it->first);
-    }
+    e_[tu] = enabled_;
     // clear D[t] (line 27)
-    dt.clear();
+    d_[tu].Clear();
     // clear S[t] (line 28)
-    st.clear();
+    s_[tu].Clear();
+    tracked_.Add(tu);
+  }
+}
+
+void FairControl::Track(Thread::uid_t uid) {
+  // make sure the tables have a row for the thread
+  if (uid >= p_.size()) {
+    e_.resize(uid + 1);
+    d_.resize(uid + 1);
+    s_.resize(uid + 1);
+    p_.resize(uid + 1);
+    p_rev_.resize(uid + 1);
+  }
+}
+
+void FairControl::GetEnabled(State *state, ThreadSet *set) {
+  set->Clear();
+  Action::Map *es = state->enabled();
+  for (Action::Map::iterator it = es->begin(); it != es->end(); ++it) {
+    Track(it->first->uid());
+    set->Add(it->first->uid());
+  }
+}
+
+void FairControl::UpdateProgress(Action *taken, bool yielded,
+                                 State *curr_state) {
+  if (MakesProgress(taken)) {
+    yielded_.Clear();
+    idle_windows_ = 0;
+    return;
+  }
+  if (!yielded)
+    return;
+
+  yielded_.Add(taken->thd()->uid());
+  // check whether all the enabled threads have yielded
+  Action::Map *es = curr_state->enabled();
+  for (Action::Map::iterator it = es->begin(); it != es->end(); ++it) {
+    if (!yielded_.Has(it->first->uid()))
+      return;
   }
+  idle_windows_++;
+  yielded_.Clear();
+}
+
+bool FairControl::MakesProgress(Action *action) {
+  if (action->IsYieldOp() || action->IsMutexOp())
+    return false;
+  return action->IsWrite();
 }
 
 std::string FairControl::ToString() {
   std::stringstream ss;
   ss << std::dec;
-  // display E
-  ss << "E:" << std::endl;
-  for (ThreadSetMap::iterator eit = e_.begin(); eit != e_.end(); ++eit) {
-    ss << "  [" << eit->first->uid() << "] ";
-    for (ThreadSet::iterator it = eit->second.begin();
-         it != eit->second.end(); ++it) {
-      ss << (*it)->uid() << " ";
-    }
-    ss << std::endl;
-  }
-  // display D
-  ss << "D:" << std::endl;
-  for (ThreadSetMap::iterator dit = d_.begin(); dit != d_.end(); ++dit) {
-    ss << "  [" << dit->first->uid() << "] ";
-    for (ThreadSet::iterator it = dit->second.begin();
-         it != dit->second.end(); ++it) {
-      ss << (*it)->uid() << " ";
-    }
-    ss << std::endl;
-  }
-  // display S
-  ss << "S:" << std::endl;
-  for (ThreadSetMap::iterator sit = s_.begin(); sit != s_.end(); ++sit) {
-    ss << "  [" << sit->first->uid() << "] ";
-    for (ThreadSet::iterator it = sit->second.begin();
-         it != sit->second.end(); ++it) {
-      ss << (*it)->uid() << " ";
-    }
-    ss << std::endl;
+  // display E, D and S
+  const char *names[] = { "E", "D", "S" };
+  ThreadSetTable *tables[] = { &e_, &d_, &s_ };
+  for (int i = 0; i < 3; i++) {
+    ss << names[i] << ":" << std::endl;
+    ThreadSetTable &table = *tables[i];
+    tracked_.ForEach([&](Thread::uid_t u) {
+      ss << "  [" << u << "] ";
+      table[u].ForEach([&](Thread::uid_t v) { ss << v << " "; });
+      ss << std::endl;
+    });
   }
   // display P
   ss << "P:" << std::endl << "  ";
-  for (ThreadRelation::iterator pit = p_.begin(); pit != p_.end(); ++pit) {
-    ss << "(" << pit->first->uid() << ", " << pit->second->uid() << ") ";
+  for (Thread::uid_t u = 0; u < p_.size(); u++) {
+    p_[u].ForEach([&](Thread::uid_t v) {
+      ss << "(" << u << ", " << v << ") ";
+    });
   }
   ss << std::endl;
   return ss.str();
 }
 
+void FairControl::ThreadSet::Add(Thread::uid_t uid) {
+  size_t w = uid / 64;
+  if (w >= bits_.size())
+    bits_.resize(w + 1, 0);
+  bits_[w] |= (uint64)1 << (uid % 64);
+}
+
+void FairControl::ThreadSet::Remove(Thread::uid_t uid) {
+  size_t w = uid / 64;
+  if (w < bits_.size())
+    bits_[w] &= ~((uint64)1 << (uid % 64));
+}
+
+void FairControl::ThreadSet::Union(const ThreadSet &set) {
+  if (set.bits_.size() > bits_.size())
+    bits_.resize(set.bits_.size(), 0);
+  for (size_t w = 0; w < set.bits_.size(); w++)
+    bits_[w] |= set.bits_[w];
+}
+
+void FairControl::ThreadSet::Intersect(const ThreadSet &set) {
+  if (bits_.size() > set.bits_.size())
+    bits_.resize(set.bits_.size());
+  for (size_t w = 0; w < bits_.size(); w++)
+    bits_[w] &= set.bits_[w];
+}
+
+void FairControl::ThreadSet::Subtract(const ThreadSet &set) {
+  size_t size = std::min(bits_.size(), set.bits_.size());
+  for (size_t w = 0; w < size; w++)
+    bits_[w] &= ~set.bits_[w];
+}
+
+bool FairControl::ThreadSet::Intersects(const ThreadSet &set) const {
+  size_t size = std::min(bits_.size(), set.bits_.size());
+  for (size_t w = 0; w < size; w++) {
+    if (bits_[w] & set.bits_[w])
+      return true;
+  }
+  return false;
+}
+
 } // namespace systematic
 
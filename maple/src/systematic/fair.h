@@ -29,41 +29,102 @@ namespace systematic {
 // the fair schedule control module
 class FairControl {
  public:
-  FairControl() {}
+  FairControl() : enabled_state_(NULL), idle_windows_(0) {}
   ~FairControl() {}
 
   bool Enabled(State *state, Action *action);
   void Update(State *curr_state);
   std::string ToString();
 
+  // livelock detection. an idle window ends when every enabled thread
+  // has yielded since the last action that made progress, so a run of
+  // idle windows indicates that the threads are spinning. the caller
+  // tells whether the taken action yielded (e.g. a failed trylock)
+  void UpdateProgress(Action *taken, bool yielded, State *curr_state);
+  uint64 idle_windows() { return idle_windows_; }
+
  protected:
-  typedef std::set<Thread *> ThreadSet;
-  typedef std::map<Thread *, ThreadSet> ThreadSetMap;
-  typedef std::pair<Thread *, Thread *> ThreadPair;
-  typedef std::list<ThreadPair> ThreadRelation;
+  // a set of threads, one bit per thread uid
+  class ThreadSet {
+   public:
+    ThreadSet() {}
+    ~ThreadSet() {}
+
+    bool Has(Thread::uid_t uid) const {
+      size_t w = uid / 64;
+      return w < bits_.size() && ((bits_[w] >> (uid % 64)) & 1);
+    }
+    void Add(Thread::uid_t uid);
+    void Remove(Thread::uid_t uid);
+    void Clear() { bits_.clear(); }
+    void Union(const ThreadSet &set);
+    void Intersect(const ThreadSet &set);
+    void Subtract(const ThreadSet &set);
+    bool Intersects(const ThreadSet &set) const;
+    // call func(uid) for each thread in the set, in uid order
+    template <typename F> void ForEach(F func) const;
+
+   private:
+    std::vector<uint64> bits_;
+  };
+  typedef std::vector<ThreadSet> ThreadSetTable; // indexed by thread uid
+
+  void Track(Thread::uid_t uid);
+  void GetEnabled(State *state, ThreadSet *set);
+
+  // whether an action makes progress. yields and reads do not. neither
+  // do mutex operations: a failed trylock changes nothing, and a lock and
+  // unlock pair only matters if the critical section makes progress
+  static bool MakesProgress(Action *action);
+
+  // the threads that have an entry in E, D and S (i.e. the threads
+  // that have yielded at least once)
+  ThreadSet tracked_;
 
   // E[t] is the set of threads that have been continuously enabled
   // since the last yield by thread t
-  ThreadSetMap e_;
+  ThreadSetTable e_;
 
   // D[t] is the set of threads that have been disabled by some
   // transition of thread t since the last yield by thread t
-  ThreadSetMap d_;
+  ThreadSetTable d_;
 
   // S[t] is the set fo threads that have been scheduled since
   // the last yield by thraed t
-  ThreadSetMap s_;
+  ThreadSetTable s_;
 
   // represent a priority ordering on threads. specifically, if
   // (t, u) \in P, then t will be scheduled only when t is enabled
   // and u is not enabled at the current state (i.e. t has a
-  // relatively low priority to u)
-  ThreadRelation p_;
+  // relatively low priority to u). p_[t] holds the u's of t, and
+  // p_rev_[u] holds the t's of u (so that edges with sink u can be
+  // removed without scanning the whole relation)
+  ThreadSetTable p_;
+  ThreadSetTable p_rev_;
+
+  // the enabled threads of the last updated state
+  State *enabled_state_;
+  ThreadSet enabled_;
+
+  // the threads that have yielded in the current idle window
+  ThreadSet yielded_;
+  uint64 idle_windows_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(FairControl);
 };
 
+template <typename F>
+void FairControl::ThreadSet::ForEach(F func) const {
+  for (size_t w = 0; w < bits_.size(); w++) {
+    uint64 bits = bits_[w];
+    while (bits) {
+      func((Thread::uid_t)(w * 64 + __builtin_ctzll(bits)));
+      bits &= bits - 1;
+    }
+  }
+}
+
 } // namespace systematic
 
 #endif
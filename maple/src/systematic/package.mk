@@ -3,6 +3,7 @@
 protodefs += \
   systematic/chess.proto \
   systematic/program.proto \
+  systematic/schedule.proto \
   systematic/search.proto
 
 srcs += \
@@ -15,6 +16,9 @@ srcs += \
   systematic/program.pb.cc \
   systematic/random.cc \
   systematic/pct_random.cc \
+  systematic/replay.cc \
+  systematic/schedule.cc \
+  systematic/schedule.pb.cc \
   systematic/scheduler.cc \
   systematic/search.cc \
   systematic/search.pb.cc
@@ -32,6 +36,9 @@ systematic_controller_objs := \
   systematic/program.pb.o \
   systematic/random.o \
   systematic/pct_random.o \
+  systematic/replay.o \
+  systematic/schedule.o \
+  systematic/schedule.pb.o \
   systematic/scheduler.o \
   systematic/search.o \
   systematic/search.pb.o \
@@ -47,6 +54,9 @@ systematic_objs := \
   systematic/program.pb.o \
   systematic/random.o \
   systematic/pct_random.o \
+  systematic/replay.o \
+  systematic/schedule.o \
+  systematic/schedule.pb.o \
   systematic/scheduler.o \
   systematic/search.o \
   systematic/search.pb.o
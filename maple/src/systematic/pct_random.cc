@@ -28,7 +28,8 @@
 namespace systematic {
 
 PCTRandomScheduler::PCTRandomScheduler(ControllerInterface *controller)
-    : Scheduler(controller)
+    : Scheduler(controller),
+      steps_(0)
 {
   // empty
 }
@@ -122,7 +123,7 @@ void PCTRandomScheduler::Explore(State *init_state) {
 
   int yieldPriority = 0;
 
-  unsigned int steps = 0;
+  steps_ = 0;
   // run until no enabled thread
   while (!state->IsTerminal()) {
 
@@ -142,10 +143,13 @@ void PCTRandomScheduler::Explore(State *init_state) {
         } );
 
     action = maxElement->second;
+    // the state (and so maxElement) may be recycled by Execute
+    Thread *max_thd = maxElement->first;
 //    std::cout << "Picked thread " << (maxElement->first->uid()-1) << " with op " << action->op() << std::endl;
 
     if((action->op() == OP_SCHED_YIELD || action->op() == OP_SLEEP
         || action->op() == OP_USLEEP
+        || action->op() == OP_NANOSLEEP
         || action->op() == OP_COND_TIMEDWAIT))
     {
       std::cout << "..Lowering " << (maxElement->first->uid()-1) << std::endl;
@@ -155,9 +159,9 @@ void PCTRandomScheduler::Explore(State *init_state) {
     }
 
     // increment num steps
-    if(enabled->size() > 1 || steps > 0)
+    if(enabled->size() > 1 || steps_ > 0)
     {
-      ++steps;
+      ++steps_;
     }
     // execute the action and move to next state
     state = Execute(state, action);
@@ -165,15 +169,15 @@ void PCTRandomScheduler::Explore(State *init_state) {
     // Are we at a change point?
     for(int i=1; i <= d_-1; ++i)
     {
-      if(steps == changePoints_[i-1])
+      if(steps_ == changePoints_[i-1])
       {
-//        std::cout << "Change point: lowering thread " << (maxElement->first->uid()-1) << std::endl;
-        priorities_.at(maxElement->first->uid()-1) = d_ - i;
+//        std::cout << "Change point: lowering thread " << (max_thd->uid()-1) << std::endl;
+        priorities_.at(max_thd->uid()-1) = d_ - i;
       }
     }
 
   }
-  std::cout << "PCT NUM STEPS: " << steps << std::endl;
+  std::cout << "PCT NUM STEPS: " << steps_ << std::endl;
 }
 
 } // namespace systematic
@@ -38,6 +38,8 @@ class PCTRandomScheduler : public Scheduler {
   int n_;
   int d_;
   int k_;
+  /// the number of steps taken in the current execution
+  unsigned int steps_;
 
   explicit PCTRandomScheduler(ControllerInterface *controller);
   ~PCTRandomScheduler();
@@ -49,6 +51,8 @@ class PCTRandomScheduler : public Scheduler {
   void ProgramStart();
   void ProgramExit();
   void Explore(State *init_state);
+  bool Streamable() { return true; }
+  int NumSteps() { return (int)steps_; }
 
  protected:
 
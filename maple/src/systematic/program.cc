@@ -19,6 +19,7 @@
 
 #include "systematic/program.h"
 
+#include <new>
 #include <sstream>
 #include "core/logging.h"
 
@@ -81,6 +82,23 @@ bool DObject::Match(Object *obj) {
          offset_ == dobj->offset_;
 }
 
+Object::uid_t DObject::ContentUid() {
+  // mix the creation info (fnv-1a over the four fields)
+  uint64 vals[4];
+  vals[0] = creator_->uid();
+  vals[1] = creator_inst_->id();
+  vals[2] = creator_idx_;
+  vals[3] = offset_;
+  uint32 hash_val = 2166136261U;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 8; j++) {
+      hash_val ^= (uint32)((vals[i] >> (j * 8)) & 0xff);
+      hash_val *= 16777619U;
+    }
+  }
+  return hash_val;
+}
+
 Thread *Program::GetMainThread() {
   // main thread always has uid == 1
   Thread *main_thd = FindThread(1);
@@ -161,16 +179,27 @@ DObject *Program::GetDObject(Thread *creator,
   }
   // create a new dynamic object
   DObject *new_dobj = new DObject;
-  new_dobj->uid_ = ++curr_obj_uid_;
   new_dobj->creator_ = creator;
   new_dobj->creator_inst_ = creator_inst;
   new_dobj->creator_idx_ = creator_idx;
   new_dobj->offset_ = offset;
-  obj_uid_table_[new_dobj->uid_] = new_dobj;
-  obj_hash_table_[hash_val].push_back(new_dobj);
+  AddDObject(new_dobj, hash_val);
   return new_dobj;
 }
 
+void Program::AddDObject(DObject *dobj, Object::hash_val_t hash_val) {
+  // the uid is derived from the creation info. on a collision, probe
+  // for the next free uid. this is only stable across runs if the
+  // colliding object is persisted, which is what Retain and Pin ensure
+  // for every object whose uid is referenced by saved info.
+  Object::uid_t uid = dobj->ContentUid() | DOBJECT_UID_BIT;
+  while (obj_uid_table_.find(uid) != obj_uid_table_.end())
+    uid = (uid + 1) | DOBJECT_UID_BIT;
+  dobj->uid_ = uid;
+  obj_uid_table_[dobj->uid_] = dobj;
+  obj_hash_table_[hash_val].push_back(dobj);
+}
+
 Thread *Program::FindThread(Thread::uid_t uid) {
   Thread::UidMap::iterator it = thd_uid_table_.find(uid);
   if (it == thd_uid_table_.end())
@@ -187,6 +216,22 @@ Object *Program::FindObject(Object::uid_t uid) {
     return it->second;
 }
 
+void Program::Retain(Object *obj) {
+  // keep the object in the program database for the next run. info that
+  // is still on disk (even if it is superseded by later updates) must
+  // retain its objects when it is loaded, not only when it is saved
+  DObject *dobj = dynamic_cast<DObject *>(obj);
+  if (dobj)
+    dobj->retained_ = true;
+}
+
+void Program::Pin(Object *obj) {
+  // keep the object in the program database for all the following runs
+  DObject *dobj = dynamic_cast<DObject *>(obj);
+  if (dobj)
+    dobj->pinned_ = true;
+}
+
 void Program::Load(const std::string &db_name, StaticInfo *sinfo) {
   ProgramProto program_proto;
   // load from file
@@ -237,10 +282,9 @@ void Program::Load(const std::string &db_name, StaticInfo *sinfo) {
     DEBUG_ASSERT(dobj->creator_inst_);
     dobj->creator_idx_ = proto->creator_idx();
     dobj->offset_ = proto->offset();
+    dobj->pinned_ = proto->pinned();
     obj_uid_table_[dobj->uid_] = dobj;
     obj_hash_table_[dobj->Hash()].push_back(dobj);
-    if (curr_obj_uid_ < dobj->uid_)
-      curr_obj_uid_ = dobj->uid_;
   }
 }
 
@@ -271,12 +315,18 @@ void Program::Save(const std::string &db_name, StaticInfo *sinfo) {
     }
     DObject *dobj = dynamic_cast<DObject *>(obj);
     if (dobj) {
+      // drop the objects that no saved info refers to, they get the
+      // same uid again when they are created in a later run
+      if (!dobj->retained_ && !dobj->pinned_)
+        continue;
       DObjectProto *proto = program_proto.add_dobject();
       proto->set_uid(dobj->uid_);
       proto->set_creator_uid(dobj->creator_->uid_);
       proto->set_creator_inst_id(dobj->creator_inst_->id());
       proto->set_creator_idx(dobj->creator_idx_);
       proto->set_offset(dobj->offset_);
+      if (dobj->pinned_)
+        proto->set_pinned(true);
       continue;
     }
   }
@@ -287,6 +337,43 @@ void Program::Save(const std::string &db_name, StaticInfo *sinfo) {
   out.close();
 }
 
+EnabledSet::iterator EnabledSet::erase(iterator it) {
+  DEBUG_ASSERT(it >= begin() && it < end());
+  for (iterator next = it + 1; next != end(); ++next)
+    *(next - 1) = *next;
+  size_--;
+  return it;
+}
+
+Action *&EnabledSet::at(Thread *thd) {
+  iterator it = find(thd);
+  DEBUG_ASSERT(it != end());
+  return it->second;
+}
+
+Action *&EnabledSet::operator[](Thread *thd) {
+  iterator it = LowerBound(thd);
+  if (it != end() && it->first == thd)
+    return it->second;
+  // insert a new entry at it
+  size_t pos = it - begin();
+  if (size_ == capacity_) {
+    size_t new_capacity = capacity_ * 2;
+    value_type *new_data = new value_type[new_capacity];
+    for (size_t i = 0; i < size_; i++)
+      new_data[i] = data_[i];
+    if (data_ != inline_)
+      delete [] data_;
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+  for (size_t i = size_; i > pos; i--)
+    data_[i] = data_[i - 1];
+  size_++;
+  data_[pos] = value_type(thd, (Action *)NULL);
+  return data_[pos].second;
+}
+
 bool Action::IsThreadOp() {
   switch (op_) {
     case OP_THREAD_START:
@@ -385,31 +472,67 @@ std::string State::ToString() {
   return ss.str();
 }
 
+Execution::~Execution() {
+  // objects alive in streaming mode are released with the arenas
+  for (State::Vec::iterator it = state_vec_.begin();
+       it != state_vec_.end(); ++it) {
+    (*it)->~State();
+  }
+  for (Action::Vec::iterator it = action_vec_.begin();
+       it != action_vec_.end(); ++it) {
+    (*it)->~Action();
+  }
+}
+
+Action *Execution::NewAction() {
+  Action *action = new (action_arena_.Alloc()) Action;
+  action->exec_ = this;
+  action->idx_ = num_actions_++;
+  if (!streaming_)
+    action_vec_.push_back(action);
+  return action;
+}
+
+State *Execution::NewState() {
+  State *state = new (state_arena_.Alloc()) State;
+  state->exec_ = this;
+  state->idx_ = num_states_++;
+  if (!streaming_)
+    state_vec_.push_back(state);
+  return state;
+}
+
 Action *Execution::CreateAction(Thread *thd,
                                 Object *obj,
                                 Operation op,
                                 Inst *inst) {
-  Action *action = new Action;
-  action->exec_ = this;
-  action->idx_ = action_vec_.size();
+  Action *action = NewAction();
   action->thd_ = thd;
   action->obj_ = obj;
   action->op_ = op;
   action->inst_ = inst;
-  action_vec_.push_back(action);
   return action;
 }
 
 State *Execution::CreateState() {
-  State *state = new State;
-  state->exec_ = this;
-  state->idx_ = state_vec_.size();
-  state_vec_.push_back(state);
-  return state;
+  return NewState();
+}
+
+void Execution::Recycle(State *state) {
+  DEBUG_ASSERT(streaming_);
+  // the taken action has been executed and no other state refers to
+  // it. the other enabled actions are still pending in the next state
+  Action *taken = state->taken_;
+  if (taken) {
+    taken->~Action();
+    action_arena_.Free(taken);
+  }
+  state->~State();
+  state_arena_.Free(state);
 }
 
 State *Execution::Prev(State *state) {
-  if (state->idx_ == 0)
+  if (streaming_ || state->idx_ == 0)
     return NULL;
   else
     return state_vec_[state->idx_ - 1];
@@ -417,7 +540,7 @@ State *Execution::Prev(State *state) {
 
 State *Execution::Next(State *state) {
   size_t next_idx = state->idx_ + 1;
-  if (next_idx >= state_vec_.size())
+  if (streaming_ || next_idx >= state_vec_.size())
     return NULL;
   else
     return state_vec_[next_idx];
@@ -441,14 +564,13 @@ void Execution::Load(const std::string &db_name,
   // load actions
   for (int i = 0; i < exec_proto.action_size(); i++) {
     ActionProto *action_proto = exec_proto.mutable_action(i);
-    Action *action = new Action;
-    action->exec_ = this;
-    action->idx_ = action_vec_.size();
+    Action *action = NewAction();
     action->thd_ = program->FindThread(action_proto->thd_uid());
     DEBUG_ASSERT(action->thd_);
     if (action_proto->has_obj_uid()) {
       action->obj_ = program->FindObject(action_proto->obj_uid());
       DEBUG_ASSERT(action->obj_);
+      program->Pin(action->obj_);
     }
     action->op_ = action_proto->op();
     if (action_proto->has_inst_id()) {
@@ -458,14 +580,11 @@ void Execution::Load(const std::string &db_name,
     action->tc_ = action_proto->tc();
     action->oc_ = action_proto->oc();
     action->yield_ = action_proto->yield();
-    action_vec_.push_back(action);
   }
   // load states
   for (int i = 0; i < exec_proto.state_size(); i++) {
     StateProto *state_proto = exec_proto.mutable_state(i);
-    State *state = new State;
-    state->exec_ = this;
-    state->idx_ = state_vec_.size();
+    State *state = NewState();
     // load enabled
     for (int j = 0; j < state_proto->enabled_size(); j++) {
       size_t idx = state_proto->enabled(j);
@@ -479,7 +598,6 @@ void Execution::Load(const std::string &db_name,
       DEBUG_ASSERT(idx < action_vec_.size());
       state->taken_ = action_vec_[idx];
     }
-    state_vec_.push_back(state);
   }
 }
 
@@ -493,8 +611,10 @@ void Execution::Save(const std::string &db_name,
     Action *action = *it;
     ActionProto *action_proto = exec_proto.add_action();
     action_proto->set_thd_uid(action->thd_->uid());
-    if (action->obj_)
+    if (action->obj_) {
       action_proto->set_obj_uid(action->obj_->uid());
+      program->Pin(action->obj_);
+    }
     action_proto->set_op(action->op_);
     if (action->inst_)
       action_proto->set_inst_id(action->inst_->id());
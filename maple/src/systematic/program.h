@@ -20,6 +20,7 @@
 #ifndef SYSTEMATIC_PROGRAM_H_
 #define SYSTEMATIC_PROGRAM_H_
 
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <set>
@@ -34,6 +35,7 @@ namespace systematic {
 // foward declaration
 class Program;
 class Execution;
+class Action;
 
 // a thread identifier
 class Thread {
@@ -47,6 +49,8 @@ class Thread {
   typedef std::tr1::unordered_map<hash_val_t, Vec> HashMap;
 
   uid_t uid() const { return uid_; }
+  Thread *creator() const { return creator_; }
+  idx_t creator_idx() const { return creator_idx_; }
 
  protected:
   Thread()
@@ -118,24 +122,32 @@ class SObject : public Object {
   DISALLOW_COPY_CONSTRUCTORS(SObject);
 };
 
-// a dynamic program object (by malloc or new)
+// a dynamic program object (by malloc or new). the uid of a dynamic
+// object is computed from its creation info, so that it is the same in
+// every run without being persisted. only the objects that are referenced
+// by persisted info are saved (see Program::Retain and Program::Pin).
 class DObject : public Object {
  protected:
   DObject()
       : creator_(NULL),
         creator_inst_(NULL),
         creator_idx_(0),
-        offset_(0) {}
+        offset_(0),
+        retained_(false),
+        pinned_(false) {}
 
   ~DObject() {}
 
   hash_val_t Hash();
   bool Match(Object *obj);
+  uid_t ContentUid();
 
   Thread *creator_;     // the thread that creates it
   Inst *creator_inst_;  // the inst. that creates the object
   idx_t creator_idx_;   // the idx-th object that is created by creator and inst
   address_t offset_;
+  bool retained_;       // referenced by info loaded or saved in this run
+  bool pinned_;         // referenced by info that is never rewritten
 
  private:
   friend class Program;
@@ -161,10 +173,14 @@ class Program {
                       address_t offset);
   Thread *FindThread(Thread::uid_t uid);
   Object *FindObject(Object::uid_t uid);
+  void Retain(Object *obj);
+  void Pin(Object *obj);
   void Load(const std::string &db_name, StaticInfo *sinfo);
   void Save(const std::string &db_name, StaticInfo *sinfo);
 
  protected:
+  void AddDObject(DObject *dobj, Object::hash_val_t hash_val);
+
   Thread::uid_t curr_thd_uid_;
   Object::uid_t curr_obj_uid_;
   Thread::UidMap thd_uid_table_;
@@ -173,22 +189,108 @@ class Program {
   Object::HashMap obj_hash_table_;
 
  private:
+  // dynamic object uids have this bit set, static object uids do not
+  static const Object::uid_t DOBJECT_UID_BIT = 0x80000000;
+
   DISALLOW_COPY_CONSTRUCTORS(Program);
 };
 
+// the enabled actions of a state, a flat map from threads to actions
+// sorted by thread uid. the first few entries are stored inline so that
+// small programs never touch the heap
+class EnabledSet {
+ public:
+  typedef std::pair<Thread *, Action *> value_type;
+  typedef value_type *iterator;
+
+  EnabledSet() : data_(inline_), size_(0), capacity_(INLINE_SIZE) {}
+  ~EnabledSet() { if (data_ != inline_) delete [] data_; }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  size_t size() { return size_; }
+  bool empty() { return size_ == 0; }
+  void clear() { size_ = 0; }
+  iterator find(Thread *thd);
+  iterator erase(iterator it);
+  Action *&at(Thread *thd);
+  Action *&operator[](Thread *thd);
+
+ protected:
+  static const size_t INLINE_SIZE = 8;
+
+  static bool UidLess(const value_type &entry, Thread *thd);
+  iterator LowerBound(Thread *thd);
+
+  value_type *data_;
+  size_t size_;
+  size_t capacity_;
+  value_type inline_[INLINE_SIZE];
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(EnabledSet);
+};
+
+// a simple arena for objects of one type. objects are carved out of
+// large blocks and freed objects are reused before new memory is
+// touched. the memory is only returned when the arena is destroyed
+template <class T>
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 1024)
+      : block_size_(block_size),
+        next_(block_size),
+        free_list_(NULL) {}
+
+  ~Arena() {
+    for (size_t i = 0; i < blocks_.size(); i++)
+      ::operator delete(blocks_[i]);
+  }
+
+  void *Alloc() {
+    if (free_list_) {
+      FreeNode *node = free_list_;
+      free_list_ = node->next;
+      return node;
+    }
+    if (next_ == block_size_) {
+      blocks_.push_back((char *)::operator new(block_size_ * SLOT_SIZE));
+      next_ = 0;
+    }
+    return blocks_.back() + SLOT_SIZE * next_++;
+  }
+
+  void Free(void *p) {
+    FreeNode *node = (FreeNode *)p;
+    node->next = free_list_;
+    free_list_ = node;
+  }
+
+ protected:
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  static const size_t SLOT_SIZE =
+      sizeof(T) > sizeof(FreeNode) ? sizeof(T) : sizeof(FreeNode);
+
+  size_t block_size_; // the number of objects in a block
+  size_t next_; // the next free slot in the last block
+  std::vector<char *> blocks_;
+  FreeNode *free_list_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(Arena);
+};
+
 // an action performed by the program
 class Action {
  public:
-  class thread_comparator {
-     public:
-        bool operator()(const Thread * x,const Thread * y) { return x->uid() < y->uid(); } 
-  };
-  
   typedef uint64 idx_t;
   typedef std::vector<Action *> Vec;
   typedef std::list<Action *> List;
   typedef std::set<Action *> Set;
-  typedef std::map<Thread *, Action *, thread_comparator> Map;
+  typedef EnabledSet Map;
   
 
   
@@ -276,7 +378,7 @@ class State {
 
   Execution *exec_;     // which execution this state belongs to
   size_t idx_;          // the id-th state in the execution
-  Action::Map enabled_; // enabled threads at the moment
+  Action::Map enabled_; // enabled threads at the moment (sorted by uid)
   Action *taken_;       // the actual taken action from this state
 
  private:
@@ -290,20 +392,39 @@ class Execution {
  public:
   typedef std::vector<Execution *> Vec;
 
-  Execution() {}
-  ~Execution() {}
+  Execution()
+      : streaming_(false),
+        num_actions_(0),
+        num_states_(0) {}
+
+  ~Execution();
 
   Action *CreateAction(Thread *thd, Object *obj, Operation op, Inst *inst);
   State *CreateState();
+  void Recycle(State *state);
   State *Prev(State *state);
   State *Next(State *state);
   State *FindState(size_t idx);
   void Load(const std::string &db_name, StaticInfo *sinfo, Program *program);
   void Save(const std::string &db_name, StaticInfo *sinfo, Program *program);
 
+  // in streaming mode, the execution does not keep its history. states
+  // (and their taken actions) are recycled once they are consumed (see
+  // Recycle), so the memory is constant in the execution length
+  bool streaming() { return streaming_; }
+  void set_streaming(bool streaming) { streaming_ = streaming; }
+
  protected:
-  Action::Vec action_vec_;
-  State::Vec state_vec_;
+  Action *NewAction();
+  State *NewState();
+
+  bool streaming_;
+  size_t num_actions_; // the number of actions created
+  size_t num_states_; // the number of states created
+  Action::Vec action_vec_; // not used in streaming mode
+  State::Vec state_vec_; // not used in streaming mode
+  Arena<Action> action_arena_;
+  Arena<State> state_arena_;
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(Execution);
@@ -318,6 +439,24 @@ inline bool State::IsTerminal() {
   return exec_ && enabled_.empty();
 }
 
+inline bool EnabledSet::UidLess(const value_type &entry, Thread *thd) {
+  return entry.first->uid() < thd->uid();
+}
+
+inline EnabledSet::iterator EnabledSet::LowerBound(Thread *thd) {
+  // threads are mostly added in uid order, so check the back first
+  if (!size_ || UidLess(data_[size_ - 1], thd))
+    return end();
+  return std::lower_bound(begin(), end(), thd, UidLess);
+}
+
+inline EnabledSet::iterator EnabledSet::find(Thread *thd) {
+  iterator it = LowerBound(thd);
+  if (it != end() && it->first == thd)
+    return it;
+  return end();
+}
+
 inline bool State::IsEnabled(Thread *thd) {
   return enabled_.find(thd) != enabled_.end();
 }
@@ -40,6 +40,7 @@ class RandomScheduler : public Scheduler {
   void ProgramStart();
   void ProgramExit();
   void Explore(State *init_state);
+  bool Streamable() { return true; }
 
  protected:
   // helper functions
@@ -0,0 +1,107 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: systematic/replay.cc - The implementation of the replay scheduler
+// which follows a recorded schedule step by step.
+
+#include "systematic/replay.h"
+
+#include <sstream>
+#include "core/logging.h"
+
+namespace systematic {
+
+ReplayScheduler::ReplayScheduler(ControllerInterface *controller)
+    : Scheduler(controller),
+      steps_(0),
+      diverged_(false) {
+  // empty
+}
+
+ReplayScheduler::~ReplayScheduler() {
+  // empty
+}
+
+void ReplayScheduler::Register() {
+  knob()->RegisterBool("enable_replay_scheduler", "whether replay a recorded schedule", "0");
+  knob()->RegisterStr("schedule_in", "the input file that contains the schedule to replay", "schedule.db");
+}
+
+bool ReplayScheduler::Enabled() {
+  return knob()->ValueBool("enable_replay_scheduler");
+}
+
+void ReplayScheduler::Setup() {
+  schedule_.Load(knob()->ValueStr("schedule_in"));
+  std::cout << "[REPLAY] " << schedule_.NumSteps() << " steps" << std::endl;
+  // the knobs that decide which operations are scheduled must match
+  std::stringstream ss;
+  ss << knob()->ValueInt("unit_size");
+  CheckKnob("unit_size", ss.str());
+  CheckKnob("sched_app", knob()->ValueBool("sched_app") ? "1" : "0");
+  CheckKnob("sched_race", knob()->ValueBool("sched_race") ? "1" : "0");
+  CheckKnob("check_mem", knob()->ValueBool("check_mem") ? "1" : "0");
+}
+
+void ReplayScheduler::ProgramStart() {
+  // empty
+}
+
+void ReplayScheduler::ProgramExit() {
+  if (diverged_)
+    std::cout << "[REPLAY] diverged from the recorded schedule" << std::endl;
+}
+
+void ReplayScheduler::Explore(State *init_state) {
+  // start with the initial state
+  State *state = init_state;
+  // run until no enabled thread
+  while (!state->IsTerminal()) {
+    Action *action = PickNext(state);
+    state = Execute(state, action);
+    steps_++;
+  }
+}
+
+void ReplayScheduler::CheckKnob(const std::string &name,
+                                const std::string &value) {
+  std::string recorded = schedule_.GetKnob(name);
+  if (!recorded.empty() && recorded != value) {
+    std::cout << "[REPLAY] warning: " << name << " is " << value
+              << ", recorded with " << recorded << std::endl;
+  }
+}
+
+Action *ReplayScheduler::PickNext(State *state) {
+  Action::Map *enabled = state->enabled();
+  DEBUG_ASSERT(enabled->size() > 0);
+  if (!diverged_ && steps_ < schedule_.NumSteps()) {
+    Thread *thd = schedule_.GetStep(steps_, program());
+    Action::Map::iterator it = thd ? enabled->find(thd) : enabled->end();
+    if (it != enabled->end())
+      return it->second;
+    // the recorded thread is not enabled, run the rest without the
+    // schedule
+    std::cout << "[REPLAY] step " << steps_ << ": recorded thread is not "
+              << "enabled" << std::endl;
+    diverged_ = true;
+  }
+  // past the end of the schedule, keep running the lowest enabled thread
+  return enabled->begin()->second;
+}
+
+} // namespace systematic
+
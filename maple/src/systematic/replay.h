@@ -0,0 +1,60 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: systematic/replay.h - The definition of the replay scheduler
+// which follows a recorded schedule step by step.
+
+#ifndef SYSTEMATIC_REPLAY_H_
+#define SYSTEMATIC_REPLAY_H_
+
+#include "core/basictypes.h"
+#include "systematic/scheduler.h"
+#include "systematic/schedule.h"
+
+namespace systematic {
+
+class ReplayScheduler : public Scheduler {
+ public:
+  explicit ReplayScheduler(ControllerInterface *controller);
+  ~ReplayScheduler();
+
+  // overrided virtual functions
+  void Register();
+  bool Enabled();
+  void Setup();
+  void ProgramStart();
+  void ProgramExit();
+  void Explore(State *init_state);
+  bool Streamable() { return true; }
+  int NumSteps() { return (int)steps_; }
+
+ protected:
+  // helper functions
+  void CheckKnob(const std::string &name, const std::string &value);
+  Action *PickNext(State *state);
+
+  RecordedSchedule schedule_;
+  size_t steps_;    // the number of steps taken in the current execution
+  bool diverged_;   // whether the execution left the recorded schedule
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(ReplayScheduler);
+};
+
+} // namespace systematic
+
+#endif
+
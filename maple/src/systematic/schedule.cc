@@ -0,0 +1,128 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: systematic/schedule.cc - The implementation of a recorded
+// schedule.
+
+#include "systematic/schedule.h"
+
+#include <cstdio>
+#include <fstream>
+#include "core/logging.h"
+
+namespace systematic {
+
+void RecordedSchedule::Record(Thread *thd) {
+  steps_.push_back(thd->uid());
+  threads_.insert(thd);
+}
+
+void RecordedSchedule::SetKnob(const std::string &name,
+                               const std::string &value) {
+  knobs_[name] = value;
+}
+
+std::string RecordedSchedule::GetKnob(const std::string &name) {
+  std::map<std::string, std::string>::iterator it = knobs_.find(name);
+  if (it == knobs_.end())
+    return "";
+  return it->second;
+}
+
+Thread *RecordedSchedule::GetStep(size_t idx, Program *program) {
+  DEBUG_ASSERT(idx < steps_.size());
+  return Resolve(steps_[idx], program);
+}
+
+Thread *RecordedSchedule::Resolve(Thread::uid_t uid,
+                                  Program *program) {
+  Thread::UidMap::iterator it = resolved_.find(uid);
+  if (it != resolved_.end())
+    return it->second;
+  Thread *thd = NULL;
+  CreatorMap::iterator cit = creators_.find(uid);
+  if (cit == creators_.end()) {
+    thd = NULL;
+  } else if (cit->second.first == 0) {
+    thd = program->GetMainThread();
+  } else {
+    Thread *creator = Resolve(cit->second.first, program);
+    if (creator)
+      thd = program->GetThread(creator, cit->second.second);
+  }
+  resolved_[uid] = thd;
+  return thd;
+}
+
+void RecordedSchedule::Load(const std::string &db_name) {
+  ScheduleProto schedule_proto;
+  std::fstream in(db_name.c_str(), std::ios::in | std::ios::binary);
+  // replaying an empty schedule would silently diverge, so a missing or
+  // corrupted schedule is fatal
+  if (!in.is_open()) {
+    fprintf(stderr, "failed to open the schedule %s\n", db_name.c_str());
+    assert(0);
+  }
+  if (!schedule_proto.ParseFromIstream(&in)) {
+    fprintf(stderr, "failed to parse the schedule %s\n", db_name.c_str());
+    assert(0);
+  }
+  in.close();
+  for (int i = 0; i < schedule_proto.knob_size(); i++) {
+    const ScheduleKnobProto &proto = schedule_proto.knob(i);
+    knobs_[proto.name()] = proto.value();
+  }
+  for (int i = 0; i < schedule_proto.thread_size(); i++) {
+    const ThreadProto &proto = schedule_proto.thread(i);
+    creators_[proto.uid()] = std::make_pair(proto.creator_uid(),
+                                            proto.creator_idx());
+  }
+  for (int i = 0; i < schedule_proto.step_size(); i++)
+    steps_.push_back(schedule_proto.step(i));
+}
+
+void RecordedSchedule::Save(const std::string &db_name) {
+  ScheduleProto schedule_proto;
+  for (std::map<std::string, std::string>::iterator it = knobs_.begin();
+       it != knobs_.end(); ++it) {
+    ScheduleKnobProto *proto = schedule_proto.add_knob();
+    proto->set_name(it->first);
+    proto->set_value(it->second);
+  }
+  // save the creation info of the threads and their creators
+  Thread::Set saved;
+  for (Thread::Set::iterator it = threads_.begin(); it != threads_.end();
+       ++it) {
+    for (Thread *thd = *it; thd && !saved.count(thd); thd = thd->creator()) {
+      saved.insert(thd);
+      ThreadProto *proto = schedule_proto.add_thread();
+      proto->set_uid(thd->uid());
+      if (thd->creator()) {
+        proto->set_creator_uid(thd->creator()->uid());
+        proto->set_creator_idx(thd->creator_idx());
+      }
+    }
+  }
+  for (size_t i = 0; i < steps_.size(); i++)
+    schedule_proto.add_step(steps_[i]);
+  std::fstream out(db_name.c_str(),
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  schedule_proto.SerializeToOstream(&out);
+  out.close();
+}
+
+} // namespace systematic
+
@@ -0,0 +1,66 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+// File: systematic/schedule.h - The definition of a recorded schedule,
+// the sequence of threads chosen by the scheduler in an execution.
+
+#ifndef SYSTEMATIC_SCHEDULE_H_
+#define SYSTEMATIC_SCHEDULE_H_
+
+#include <map>
+#include <vector>
+
+#include "core/basictypes.h"
+#include "systematic/program.h"
+#include "systematic/schedule.pb.h"
+
+namespace systematic {
+
+class RecordedSchedule {
+ public:
+  RecordedSchedule() {}
+  ~RecordedSchedule() {}
+
+  void Record(Thread *thd);
+  void SetKnob(const std::string &name, const std::string &value);
+  std::string GetKnob(const std::string &name); // "" if not recorded
+  size_t NumSteps() { return steps_.size(); }
+  // the thread of the idx-th step in the current program, the thread is
+  // identified by its creation info, so uids need not match across runs
+  Thread *GetStep(size_t idx, Program *program);
+  void Load(const std::string &db_name);
+  void Save(const std::string &db_name);
+
+ protected:
+  typedef std::map<Thread::uid_t, std::pair<Thread::uid_t, Thread::idx_t> >
+      CreatorMap;
+
+  Thread *Resolve(Thread::uid_t uid, Program *program);
+
+  std::vector<Thread::uid_t> steps_;
+  std::map<std::string, std::string> knobs_;
+  Thread::Set threads_;  // the threads recorded in this run
+  CreatorMap creators_;  // the creation info of the loaded threads
+  Thread::UidMap resolved_;
+
+ private:
+  DISALLOW_COPY_CONSTRUCTORS(RecordedSchedule);
+};
+
+} // namespace systematic
+
+#endif
+
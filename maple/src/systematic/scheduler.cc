@@ -42,6 +42,9 @@ State *Scheduler::Execute(State *state, Action *action) {
   state->set_taken(action);
   // execute the action, and get the next state
   State *next_state = controller_->Execute(state, action);
+  // the consumed state is not needed any more in streaming mode
+  if (execution()->streaming())
+    execution()->Recycle(state);
   // set counters for enabled actions
   SetActionCounters(next_state);
   return next_state;
@@ -57,6 +57,14 @@ class Scheduler {
   virtual void ProgramExit() = 0;
   virtual void Explore(State *init_state) = 0;
 
+  // whether the scheduler never looks back at consumed states, so
+  // that they can be recycled (see Execution::Recycle)
+  virtual bool Streamable() { return false; }
+
+  // per execution results (-1 if not tracked by the scheduler)
+  virtual int NumPreemptions() { return -1; }
+  virtual int NumSteps() { return -1; }
+
   // the main entry of the scheduler
   void Main(State *init_state);
 
@@ -19,6 +19,9 @@
 
 #include "systematic/search.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 #include "core/logging.h"
 
@@ -101,6 +104,7 @@ SearchNode *SearchInfo::GetNextNode(State *state) {
       node->enabled_[it->first] = new ActionInfo(it->second);
     }
     stack_.push_back(node);
+    Touch(node->idx_);
   } else {
     // return an existing node
     node = stack_[cursor_];
@@ -120,6 +124,7 @@ void SearchInfo::UpdateForNext() {
       break;
     stack_.pop_back();
   }
+  Touch(stack_.size());
   if (stack_.empty())
     done_ = true;
   num_runs_ += 1;
@@ -159,40 +164,11 @@ void SearchInfo::Load(const std::string &db_name,
   // load general info
   done_ = info_proto.done();
   num_runs_ = info_proto.num_runs();
+  log_id_ = info_proto.log_id();
   // load search stack
   for (int i = 0; i < info_proto.node_size(); i++) {
     SearchNodeProto *node_proto = info_proto.mutable_node(i);
-    SearchNode *node = new SearchNode;
-    node->info_ = this;
-    node->idx_ = stack_.size();
-    // load sel
-    node->sel_ = program->FindThread(node_proto->sel());
-    DEBUG_ASSERT(node->sel_);
-    // load backtrack set
-    for (int j = 0; j < node_proto->backtrack_size(); j++) {
-      Thread *thd = program->FindThread(node_proto->backtrack(j));
-      DEBUG_ASSERT(thd);
-      node->backtrack_.insert(thd);
-    }
-    // load done set
-    for (int j = 0; j < node_proto->done_size(); j++) {
-      Thread *thd = program->FindThread(node_proto->done(j));
-      DEBUG_ASSERT(thd);
-      node->done_.insert(thd);
-    }
-    // load enabled set
-    for (int j = 0; j < node_proto->enabled_size(); j++) {
-      ActionInfoProto *action_info_proto = node_proto->mutable_enabled(j);
-      ActionInfo *action_info = new ActionInfo;
-      action_info->thd_ = program->FindThread(action_info_proto->thd_uid());
-      if (action_info_proto->has_obj_uid())
-        action_info->obj_ = program->FindObject(action_info_proto->obj_uid());
-      action_info->op_ = action_info_proto->op();
-      if (action_info_proto->has_inst_id())
-        action_info->inst_ = sinfo->FindInst(action_info_proto->inst_id());
-      node->enabled_[action_info->thd_] = action_info;
-    }
-    stack_.push_back(node);
+    stack_.push_back(LoadNode(node_proto, sinfo, program));
   }
 //  std::cout << "Loading: " << std::endl;
   for(uint32 i : info_proto.preempted_insts()) {
@@ -201,46 +177,196 @@ void SearchInfo::Load(const std::string &db_name,
 //    std::cout << "  " << i << std::endl;
     insts_prempted_.insert(inst);
   }
+  // apply the updates saved after the snapshot
+  LoadLog(db_name + ".log", sinfo, program);
+  db_name_ = db_name;
+  dirty_idx_ = stack_.size();
+  insts_saved_ = insts_prempted_;
 }
 
 void SearchInfo::Save(const std::string &db_name,
                       StaticInfo *sinfo,
                       Program *program) {
-  SearchInfoProto info_proto;
-  // save general info
-  info_proto.set_done(done_);
-  info_proto.set_num_runs(num_runs_);
-  // save search stack
+  // the program database is rewritten in every run, so the objects of
+  // all the nodes need to be retained, not only the saved ones
   for (SearchNode::Vec::iterator it = stack_.begin(); it != stack_.end(); ++it){
     SearchNode *node = *it;
-    SearchNodeProto *node_proto = info_proto.add_node();
-    // save sel
-    node_proto->set_sel(node->sel_->uid());
-    // save backtrack
-    for (Thread::Set::iterator bit = node->backtrack_.begin();
-         bit != node->backtrack_.end(); ++bit) {
-      Thread *thd = *bit;
-      node_proto->add_backtrack(thd->uid());
-    }
-    // save done
-    for (Thread::Set::iterator dit = node->done_.begin();
-         dit != node->done_.end(); ++dit) {
-      Thread *thd = *dit;
-      node_proto->add_done(thd->uid());
-    }
-    // save enabled
     for (ActionInfo::Map::iterator eit = node->enabled_.begin();
          eit != node->enabled_.end(); ++eit) {
-      ActionInfo *action_info = eit->second;
-      ActionInfoProto *action_info_proto = node_proto->add_enabled();
-      action_info_proto->set_thd_uid(action_info->thd_->uid());
-      if (action_info->obj_)
-        action_info_proto->set_obj_uid(action_info->obj_->uid());
-      action_info_proto->set_op(action_info->op_);
-      if (action_info->inst_)
-        action_info_proto->set_inst_id(action_info->inst_->id());
+      if (eit->second->obj_)
+        program->Retain(eit->second->obj_);
+    }
+  }
+
+  std::string log_name = db_name + ".log";
+  if (db_name != db_name_ || num_updates_ >= compact_interval_) {
+    // write the whole stack and start a new log. the entries of the old
+    // log carry the old log id, so they are skipped if the old log is
+    // still there after a crash
+    log_id_++;
+    SaveSnapshot(db_name);
+    std::remove(log_name.c_str());
+    num_updates_ = 0;
+  } else {
+    SaveLog(log_name);
+    num_updates_ += 1;
+  }
+  db_name_ = db_name;
+  dirty_idx_ = stack_.size();
+  insts_saved_ = insts_prempted_;
+}
+
+SearchNode *SearchInfo::LoadNode(SearchNodeProto *node_proto,
+                                 StaticInfo *sinfo,
+                                 Program *program) {
+  SearchNode *node = new SearchNode;
+  node->info_ = this;
+  node->idx_ = stack_.size();
+  // load sel
+  node->sel_ = program->FindThread(node_proto->sel());
+  DEBUG_ASSERT(node->sel_);
+  // load backtrack set
+  for (int j = 0; j < node_proto->backtrack_size(); j++) {
+    Thread *thd = program->FindThread(node_proto->backtrack(j));
+    DEBUG_ASSERT(thd);
+    node->backtrack_.insert(thd);
+  }
+  // load done set
+  for (int j = 0; j < node_proto->done_size(); j++) {
+    Thread *thd = program->FindThread(node_proto->done(j));
+    DEBUG_ASSERT(thd);
+    node->done_.insert(thd);
+  }
+  // load enabled set
+  for (int j = 0; j < node_proto->enabled_size(); j++) {
+    ActionInfoProto *action_info_proto = node_proto->mutable_enabled(j);
+    ActionInfo *action_info = new ActionInfo;
+    action_info->thd_ = program->FindThread(action_info_proto->thd_uid());
+    if (action_info_proto->has_obj_uid()) {
+      action_info->obj_ = program->FindObject(action_info_proto->obj_uid());
+      DEBUG_ASSERT(action_info->obj_);
+      // the node may be popped later, but the snapshot or the log still
+      // refers to the object until the next compaction
+      program->Retain(action_info->obj_);
     }
+    action_info->op_ = action_info_proto->op();
+    if (action_info_proto->has_inst_id())
+      action_info->inst_ = sinfo->FindInst(action_info_proto->inst_id());
+    node->enabled_[action_info->thd_] = action_info;
+  }
+  return node;
+}
+
+void SearchInfo::SaveNode(SearchNode *node, SearchNodeProto *node_proto) {
+  // save sel
+  node_proto->set_sel(node->sel_->uid());
+  // save backtrack
+  for (Thread::Set::iterator bit = node->backtrack_.begin();
+       bit != node->backtrack_.end(); ++bit) {
+    Thread *thd = *bit;
+    node_proto->add_backtrack(thd->uid());
+  }
+  // save done
+  for (Thread::Set::iterator dit = node->done_.begin();
+       dit != node->done_.end(); ++dit) {
+    Thread *thd = *dit;
+    node_proto->add_done(thd->uid());
   }
+  // save enabled
+  for (ActionInfo::Map::iterator eit = node->enabled_.begin();
+       eit != node->enabled_.end(); ++eit) {
+    ActionInfo *action_info = eit->second;
+    ActionInfoProto *action_info_proto = node_proto->add_enabled();
+    action_info_proto->set_thd_uid(action_info->thd_->uid());
+    if (action_info->obj_)
+      action_info_proto->set_obj_uid(action_info->obj_->uid());
+    action_info_proto->set_op(action_info->op_);
+    if (action_info->inst_)
+      action_info_proto->set_inst_id(action_info->inst_->id());
+  }
+}
+
+void SearchInfo::Truncate(size_t size) {
+  while (stack_.size() > size) {
+    SearchNode *node = stack_.back();
+    for (ActionInfo::Map::iterator it = node->enabled_.begin();
+         it != node->enabled_.end(); ++it)
+      delete it->second;
+    delete node;
+    stack_.pop_back();
+  }
+}
+
+void SearchInfo::LoadLog(const std::string &log_name,
+                         StaticInfo *sinfo,
+                         Program *program) {
+  // each entry is a 4-byte size followed by a SearchUpdateProto
+  std::fstream in(log_name.c_str(), std::ios::in | std::ios::binary);
+  if (!in.is_open())
+    return;
+  std::string buf;
+  uint32 size = 0;
+  while (in.read((char *)&size, sizeof(size))) {
+    buf.resize(size);
+    if (size > 0 && !in.read(&buf[0], size))
+      break; // partially written entry
+    SearchUpdateProto update_proto;
+    if (!update_proto.ParseFromString(buf))
+      break;
+    if (update_proto.log_id() != log_id_)
+      continue; // written before the snapshot
+    DEBUG_ASSERT(update_proto.prefix() <= stack_.size());
+    Truncate(update_proto.prefix());
+    for (int i = 0; i < update_proto.node_size(); i++) {
+      SearchNodeProto *node_proto = update_proto.mutable_node(i);
+      stack_.push_back(LoadNode(node_proto, sinfo, program));
+    }
+    done_ = update_proto.done();
+    num_runs_ = update_proto.num_runs();
+    for (int i = 0; i < update_proto.preempted_insts_size(); i++) {
+      Inst *inst = sinfo->FindInst(update_proto.preempted_insts(i));
+      DEBUG_ASSERT(inst);
+      insts_prempted_.insert(inst);
+    }
+    num_updates_ += 1;
+  }
+  in.close();
+}
+
+void SearchInfo::SaveLog(const std::string &log_name) {
+  SearchUpdateProto update_proto;
+  size_t prefix = dirty_idx_ < stack_.size() ? dirty_idx_ : stack_.size();
+  update_proto.set_prefix(prefix);
+  for (size_t i = prefix; i < stack_.size(); i++)
+    SaveNode(stack_[i], update_proto.add_node());
+  update_proto.set_done(done_);
+  update_proto.set_num_runs(num_runs_);
+  update_proto.set_log_id(log_id_);
+  for (Inst::Set::iterator it = insts_prempted_.begin();
+       it != insts_prempted_.end(); ++it) {
+    if (insts_saved_.find(*it) == insts_saved_.end())
+      update_proto.add_preempted_insts((*it)->id());
+  }
+  // append to file
+  std::string buf;
+  update_proto.SerializeToString(&buf);
+  uint32 size = buf.size();
+  std::fstream out(log_name.c_str(),
+                   std::ios::out | std::ios::app | std::ios::binary);
+  out.write((const char *)&size, sizeof(size));
+  out.write(buf.data(), buf.size());
+  out.close();
+}
+
+void SearchInfo::SaveSnapshot(const std::string &db_name) {
+  SearchInfoProto info_proto;
+  // save general info
+  info_proto.set_done(done_);
+  info_proto.set_num_runs(num_runs_);
+  info_proto.set_log_id(log_id_);
+  // save search stack
+  for (SearchNode::Vec::iterator it = stack_.begin(); it != stack_.end(); ++it)
+    SaveNode(*it, info_proto.add_node());
   
 //  std::cout << "Saving: " << std::endl;
   for(auto i : insts_prempted_) {
@@ -248,11 +374,18 @@ void SearchInfo::Save(const std::string &db_name,
 //    std::cout << "  " << i->id() << std::endl;
   }
   
-  // save to file
-  std::fstream out(db_name.c_str(),
+  // save to a temporary file first so that a crash never leaves a
+  // partially written snapshot behind
+  std::string tmp_name = db_name + ".tmp";
+  std::fstream out(tmp_name.c_str(),
                    std::ios::out | std::ios::trunc | std::ios::binary);
   info_proto.SerializeToOstream(&out);
   out.close();
+  if (rename(tmp_name.c_str(), db_name.c_str()) != 0) {
+    fprintf(stderr, "failed to save the search info %s: %s\n",
+            db_name.c_str(), strerror(errno));
+    assert(0);
+  }
 }
 
 bool SearchInfo::CheckDivergence(SearchNode *node, State *state) {
@@ -80,10 +80,10 @@ class SearchNode {
 
   Thread *sel() { return sel_; }
   size_t idx() { return idx_; }
-  void set_sel(Thread *thd) { sel_ = thd; }
+  void set_sel(Thread *thd);
 
  protected:
-  SearchNode() : info_(NULL), idx_(0) {}
+  SearchNode() : info_(NULL), idx_(0), sel_(NULL) {}
   ~SearchNode() {}
 
   SearchInfo *info_;
@@ -99,10 +99,21 @@ class SearchNode {
   DISALLOW_COPY_CONSTRUCTORS(SearchNode);
 };
 
-// define the search info (dfs search)
+// define the search info (dfs search). the search stack is saved as a
+// snapshot (db_name) plus a log of updates (db_name.log). each update
+// holds the nodes that changed since the previous save, so a run only
+// writes the part of the stack below the point it backtracked to. the
+// log is folded into the snapshot every compact_interval saves.
 class SearchInfo {
  public:
-  SearchInfo() : done_(false), num_runs_(0), cursor_(0) {}
+  SearchInfo()
+      : done_(false),
+        num_runs_(0),
+        cursor_(0),
+        dirty_idx_(0),
+        num_updates_(0),
+        compact_interval_(0),
+        log_id_(0) {}
   ~SearchInfo() {}
 
   bool Done() { return done_; }
@@ -114,16 +125,32 @@ class SearchInfo {
   void UpdateForNext();
   void Load(const std::string &db_name, StaticInfo *sinfo, Program *program);
   void Save(const std::string &db_name, StaticInfo *sinfo, Program *program);
+  void Touch(size_t idx);
+  void set_compact_interval(int interval) { compact_interval_ = interval; }
 
  protected:
   // helper functions
   bool CheckDivergence(SearchNode *node, State *state);
+  SearchNode *LoadNode(SearchNodeProto *node_proto, StaticInfo *sinfo,
+                       Program *program);
+  void SaveNode(SearchNode *node, SearchNodeProto *node_proto);
+  void Truncate(size_t size);
+  void LoadLog(const std::string &log_name, StaticInfo *sinfo,
+               Program *program);
+  void SaveLog(const std::string &log_name);
+  void SaveSnapshot(const std::string &db_name);
 
   bool done_;
   int num_runs_;
   SearchNode::Vec stack_;
   size_t cursor_;
   Inst::Set insts_prempted_;
+  std::string db_name_;     // the file the search info is loaded from
+  size_t dirty_idx_;        // the first node changed since the last save
+  int num_updates_;         // the number of updates in the log
+  int compact_interval_;    // max updates in the log (0 means no log)
+  uint32 log_id_;           // entries of other logs are stale
+  Inst::Set insts_saved_;   // the preempted insts that are already saved
 
  private:
   DISALLOW_COPY_CONSTRUCTORS(SearchInfo);
@@ -139,11 +166,19 @@ inline bool SearchNode::IsDone(Thread *thd) {
 }
 
 inline void SearchNode::AddDone(Thread *thd) {
-  done_.insert(thd);
+  if (done_.insert(thd).second)
+    info_->Touch(idx_);
 }
 
 inline void SearchNode::AddBacktrack(Thread *thd) {
-  backtrack_.insert(thd);
+  if (backtrack_.insert(thd).second)
+    info_->Touch(idx_);
+}
+
+inline void SearchNode::set_sel(Thread *thd) {
+  if (sel_ != thd)
+    info_->Touch(idx_);
+  sel_ = thd;
 }
 
 inline SearchNode *SearchNode::Prev() {
@@ -154,6 +189,11 @@ inline SearchNode *SearchNode::Next() {
   return info_->Next(this);
 }
 
+inline void SearchInfo::Touch(size_t idx) {
+  if (idx < dirty_idx_)
+    dirty_idx_ = idx;
+}
+
 } // namespace systematic
 
 #endif
@@ -18,27 +18,81 @@
 
 #include "tracer/loader.h"
 
+#include <algorithm>
+
 #include "core/cmdline_knob.h"
 #include "core/debug_analyzer.h"
 
 #define CALL_ANALYSIS_FUNC(func,...) \
-    for (AnalyzerContainer::iterator it = analyzers_.begin(); \
-         it != analyzers_.end(); ++it) { \
+    for (AnalyzerContainer::iterator it = analyzers->begin(); \
+         it != analyzers->end(); ++it) { \
       (*it)->func(__VA_ARGS__); \
     }
 
 #define CALL_ANALYSIS_FUNC2(type,func,...) \
-    for (AnalyzerContainer::iterator it = analyzers_.begin(); \
-         it != analyzers_.end(); ++it) { \
+    for (AnalyzerContainer::iterator it = analyzers->begin(); \
+         it != analyzers->end(); ++it) { \
       if ((*it)->desc()->Hook##type()) \
         (*it)->func(__VA_ARGS__); \
     }
 
+// the number of entries sent to a shard at a time
+#define SHARD_BATCH_SIZE 4096
+// the number of batches that can be queued for a shard
+#define SHARD_QUEUE_DEPTH 16
+
 namespace tracer {
 
+Loader::Shard::Shard(int id)
+    : id_(id),
+      curr_batch_(new EntryBatch),
+      items_sem_(0),
+      slots_sem_(SHARD_QUEUE_DEPTH) {
+  curr_batch_->reserve(SHARD_BATCH_SIZE);
+}
+
+Loader::Shard::~Shard() {
+  delete curr_batch_;
+}
+
+LogEntryProto *Loader::Shard::Append(LogEntryProto *proto) {
+  // flush before appending so that the returned entry can be modified
+  if (curr_batch_->size() >= SHARD_BATCH_SIZE)
+    Flush();
+  curr_batch_->push_back(*proto);
+  return &curr_batch_->back();
+}
+
+void Loader::Shard::Flush() {
+  if (curr_batch_->empty())
+    return;
+  Push(curr_batch_);
+  curr_batch_ = new EntryBatch;
+  curr_batch_->reserve(SHARD_BATCH_SIZE);
+}
+
+void Loader::Shard::Push(EntryBatch *batch) {
+  slots_sem_.Wait();
+  lock_.Lock();
+  queue_.push_back(batch);
+  lock_.Unlock();
+  items_sem_.Post();
+}
+
+Loader::EntryBatch *Loader::Shard::Pop() {
+  items_sem_.Wait();
+  lock_.Lock();
+  EntryBatch *batch = queue_.front();
+  queue_.pop_front();
+  lock_.Unlock();
+  slots_sem_.Post();
+  return batch;
+}
+
 Loader::Loader()
     : trace_log_(NULL),
-      debug_analyzer_(NULL) {
+      debug_analyzer_(NULL),
+      shard_unit_(0) {
   // empty
 }
 
@@ -46,6 +100,8 @@ void Loader::HandlePreSetup() {
   OfflineTool::HandlePreSetup();
 
   knob_->RegisterStr("trace_log_path", "the trace log path", "trace-log");
+  knob_->RegisterInt("num_shards", "the number of threads replaying the trace (memory accesses are partitioned by address)", "1");
+  knob_->RegisterInt("shard_unit", "the size of the address ranges assigned to shards (power of 2)", "64");
 
   debug_analyzer_ = new DebugAnalyzer;
   debug_analyzer_->Register();
@@ -65,173 +121,278 @@ void Loader::HandlePostSetup() {
 }
 
 void Loader::HandleStart() {
-  while (true) {
-    trace_log_->OpenForRead();
-    EventLoop();
-    trace_log_->CloseForRead();
-  }
+  StartShards();
+  trace_log_->OpenForRead();
+  EventLoop();
+  trace_log_->CloseForRead();
+  StopShards();
+}
+
+void Loader::HandleShardSetup(int shard_id, AnalyzerContainer *analyzers) {
+  // empty
+}
+
+void Loader::HandleShardMerge(int shard_id, AnalyzerContainer *analyzers) {
+  // empty
 }
 
 void Loader::EventLoop() {
   while (trace_log_->HasNextEntry()) {
     LogEntry entry = trace_log_->NextEntry();
-    HandleEvent(&entry);
+    if (shards_.empty())
+      HandleEvent(&analyzers_, &entry);
+    else
+      DispatchEvent(&entry);
   }
 }
 
+void Loader::StartShards() {
+  int num_shards = knob_->ValueInt("num_shards");
+  if (num_shards <= 1)
+    return;
+
+  shard_unit_ = (address_t)knob_->ValueInt("shard_unit");
+  if (shard_unit_ == 0 || (shard_unit_ & (shard_unit_ - 1)))
+    shard_unit_ = 64;
+
+  for (int i = 0; i < num_shards; i++) {
+    Shard *shard = new Shard(i);
+    HandleShardSetup(i, &shard->analyzers_);
+    shards_.push_back(shard);
+  }
+  for (ShardVec::iterator it = shards_.begin(); it != shards_.end(); ++it) {
+    if (pthread_create(&(*it)->thread_, NULL, __ShardMain, *it))
+      assert(0);
+  }
+}
+
+void Loader::StopShards() {
+  // a NULL batch marks the end of the trace
+  for (ShardVec::iterator it = shards_.begin(); it != shards_.end(); ++it) {
+    (*it)->Flush();
+    (*it)->Push(NULL);
+  }
+  for (ShardVec::iterator it = shards_.begin(); it != shards_.end(); ++it) {
+    pthread_join((*it)->thread_, NULL);
+    HandleShardMerge((*it)->id_, &(*it)->analyzers_);
+    delete *it;
+  }
+  shards_.clear();
+}
+
+void Loader::DispatchEvent(LogEntry *e) {
+  // analyzers added to the loader itself see all the events in order
+  if (!analyzers_.empty())
+    HandleEvent(&analyzers_, e);
+
+  switch (e->type()) {
+    case LOG_ENTRY_BEFORE_MEM_READ:
+    case LOG_ENTRY_AFTER_MEM_READ:
+    case LOG_ENTRY_BEFORE_MEM_WRITE:
+    case LOG_ENTRY_AFTER_MEM_WRITE:
+      RouteMemEvent(e);
+      break;
+    default:
+      for (ShardVec::iterator it = shards_.begin(); it != shards_.end(); ++it)
+        (*it)->Append(e->proto_);
+      break;
+  }
+}
+
+void Loader::RouteMemEvent(LogEntry *e) {
+  address_t start = e->arg(0);
+  address_t end = start + e->arg(1);
+  address_t mask = ~(shard_unit_ - 1);
+  if (end <= start || ((end - 1) & mask) == (start & mask)) {
+    GetShard(start)->Append(e->proto_);
+    return;
+  }
+
+  // split the accesses that cross the partition boundaries
+  while (start < end) {
+    address_t next = std::min((start & mask) + shard_unit_, end);
+    LogEntryProto *proto = GetShard(start)->Append(e->proto_);
+    proto->set_arg(0, start);
+    proto->set_arg(1, next - start);
+    start = next;
+  }
+}
+
+Loader::Shard *Loader::GetShard(address_t addr) {
+  return shards_[(addr / shard_unit_) % shards_.size()];
+}
+
+void Loader::ShardMain(Shard *shard) {
+  while (true) {
+    EntryBatch *batch = shard->Pop();
+    if (!batch)
+      break;
+    for (EntryBatch::iterator it = batch->begin(); it != batch->end(); ++it) {
+      LogEntry entry(&(*it));
+      HandleEvent(&shard->analyzers_, &entry);
+    }
+    delete batch;
+  }
+}
+
+void *Loader::__ShardMain(void *arg) {
+  ((Loader *)tool_)->ShardMain((Shard *)arg);
+  return NULL;
+}
+
 void Loader::AddAnalyzer(Analyzer *analyzer) {
   analyzers_.push_back(analyzer);
   desc_.Merge(analyzer->desc());
 }
 
-void Loader::HandleEvent(LogEntry *e) {
+void Loader::HandleEvent(AnalyzerContainer *analyzers, LogEntry *e) {
   switch (e->type()) {
     case LOG_ENTRY_PROGRAM_START:
-      HandleProgramStart(e);
+      HandleProgramStart(analyzers, e);
       break;
     case LOG_ENTRY_PROGRAM_EXIT:
-      HandleProgramExit(e);
+      HandleProgramExit(analyzers, e);
       break;
     case LOG_ENTRY_IMAGE_LOAD:
-      HandleImageLoad(e);
+      HandleImageLoad(analyzers, e);
       break;
     case LOG_ENTRY_IMAGE_UNLOAD:
-      HandleImageUnload(e);
+      HandleImageUnload(analyzers, e);
       break;
     case LOG_ENTRY_SYSCALL_ENTRY:
-      HandleSyscallEntry(e);
+      HandleSyscallEntry(analyzers, e);
       break;
     case LOG_ENTRY_SYSCALL_EXIT:
-      HandleSyscallExit(e);
+      HandleSyscallExit(analyzers, e);
       break;
     case LOG_ENTRY_SIGNAL_RECEIVED:
-      HandleSignalReceived(e);
+      HandleSignalReceived(analyzers, e);
       break;
     case LOG_ENTRY_THREAD_START:
-      HandleThreadStart(e);
+      HandleThreadStart(analyzers, e);
       break;
     case LOG_ENTRY_THREAD_EXIT:
-      HandleThreadExit(e);
+      HandleThreadExit(analyzers, e);
       break;
     case LOG_ENTRY_MAIN:
-      HandleMain(e);
+      HandleMain(analyzers, e);
       break;
     case LOG_ENTRY_THREAD_MAIN:
-      HandleThreadMain(e);
+      HandleThreadMain(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_MEM_READ:
-      HandleBeforeMemRead(e);
+      HandleBeforeMemRead(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_MEM_READ:
-      HandleAfterMemRead(e);
+      HandleAfterMemRead(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_MEM_WRITE:
-      HandleBeforeMemWrite(e);
+      HandleBeforeMemWrite(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_MEM_WRITE:
-      HandleAfterMemWrite(e);
+      HandleAfterMemWrite(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_ATOMIC_INST:
-      HandleBeforeAtomicInst(e);
+      HandleBeforeAtomicInst(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_ATOMIC_INST:
-      HandleAfterAtomicInst(e);
+      HandleAfterAtomicInst(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_CREATE:
-      HandleBeforePthreadCreate(e);
+      HandleBeforePthreadCreate(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_CREATE:
-      HandleAfterPthreadCreate(e);
+      HandleAfterPthreadCreate(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_JOIN:
-      HandleBeforePthreadJoin(e);
+      HandleBeforePthreadJoin(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_JOIN:
-      HandleAfterPthreadJoin(e);
+      HandleAfterPthreadJoin(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_MUTEX_TRYLOCK:
-      HandleBeforePthreadMutexTryLock(e);
+      HandleBeforePthreadMutexTryLock(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_MUTEX_TRYLOCK:
-      HandleAfterPthreadMutexTryLock(e);
+      HandleAfterPthreadMutexTryLock(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_MUTEX_LOCK:
-      HandleBeforePthreadMutexLock(e);
+      HandleBeforePthreadMutexLock(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_MUTEX_LOCK:
-      HandleAfterPthreadMutexLock(e);
+      HandleAfterPthreadMutexLock(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_MUTEX_UNLOCK:
-      HandleBeforePthreadMutexUnlock(e);
+      HandleBeforePthreadMutexUnlock(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_MUTEX_UNLOCK:
-      HandleAfterPthreadMutexUnlock(e);
+      HandleAfterPthreadMutexUnlock(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_COND_SIGNAL:
-      HandleBeforePthreadCondSignal(e);
+      HandleBeforePthreadCondSignal(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_COND_SIGNAL:
-      HandleAfterPthreadCondSignal(e);
+      HandleAfterPthreadCondSignal(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_COND_BROADCAST:
-      HandleBeforePthreadCondBroadcast(e);
+      HandleBeforePthreadCondBroadcast(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_COND_BROADCAST:
-      HandleAfterPthreadCondBroadcast(e);
+      HandleAfterPthreadCondBroadcast(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_COND_WAIT:
-      HandleBeforePthreadCondWait(e);
+      HandleBeforePthreadCondWait(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_COND_WAIT:
-      HandleAfterPthreadCondWait(e);
+      HandleAfterPthreadCondWait(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_COND_TIMEDWAIT:
-      HandleBeforePthreadCondTimedwait(e);
+      HandleBeforePthreadCondTimedwait(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_COND_TIMEDWAIT:
-      HandleAfterPthreadCondTimedwait(e);
+      HandleAfterPthreadCondTimedwait(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_BARRIER_INIT:
-      HandleBeforePthreadBarrierInit(e);
+      HandleBeforePthreadBarrierInit(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_BARRIER_INIT:
-      HandleAfterPthreadBarrierInit(e);
+      HandleAfterPthreadBarrierInit(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_PTHREAD_BARRIER_WAIT:
-      HandleBeforePthreadBarrierWait(e);
+      HandleBeforePthreadBarrierWait(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_PTHREAD_BARRIER_WAIT:
-      HandleAfterPthreadBarrierWait(e);
+      HandleAfterPthreadBarrierWait(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_MALLOC:
-      HandleBeforeMalloc(e);
+      HandleBeforeMalloc(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_MALLOC:
-      HandleAfterMalloc(e);
+      HandleAfterMalloc(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_CALLOC:
-      HandleBeforeCalloc(e);
+      HandleBeforeCalloc(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_CALLOC:
-      HandleAfterCalloc(e);
+      HandleAfterCalloc(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_REALLOC:
-      HandleBeforeRealloc(e);
+      HandleBeforeRealloc(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_REALLOC:
-      HandleAfterRealloc(e);
+      HandleAfterRealloc(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_FREE:
-      HandleBeforeFree(e);
+      HandleBeforeFree(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_FREE:
-      HandleAfterFree(e);
+      HandleAfterFree(analyzers, e);
       break;
     case LOG_ENTRY_BEFORE_VALLOC:
-      HandleBeforeValloc(e);
+      HandleBeforeValloc(analyzers, e);
       break;
     case LOG_ENTRY_AFTER_VALLOC:
-      HandleAfterValloc(e);
+      HandleAfterValloc(analyzers, e);
       break;
     default:
       DEBUG_FMT_PRINT_SAFE("e->type() = %d\n", e->type());
@@ -240,15 +401,15 @@ void Loader::HandleEvent(LogEntry *e) {
   }
 }
 
-void Loader::HandleProgramStart(LogEntry *e) {
+void Loader::HandleProgramStart(AnalyzerContainer *analyzers, LogEntry *e) {
   CALL_ANALYSIS_FUNC(ProgramStart);
 }
 
-void Loader::HandleProgramExit(LogEntry *e) {
+void Loader::HandleProgramExit(AnalyzerContainer *analyzers, LogEntry *e) {
   CALL_ANALYSIS_FUNC(ProgramExit);
 }
 
-void Loader::HandleImageLoad(LogEntry *e) {
+void Loader::HandleImageLoad(AnalyzerContainer *analyzers, LogEntry *e) {
   image_id_type image_id = (image_id_type)e->arg(0);
   Image *image = sinfo_->FindImage(image_id);
   DEBUG_ASSERT(image);
@@ -262,7 +423,7 @@ void Loader::HandleImageLoad(LogEntry *e) {
                      data_start, data_size, bss_start, bss_size);
 }
 
-void Loader::HandleImageUnload(LogEntry *e) {
+void Loader::HandleImageUnload(AnalyzerContainer *analyzers, LogEntry *e) {
   image_id_type image_id = (image_id_type)e->arg(0);
   Image *image = sinfo_->FindImage(image_id);
   DEBUG_ASSERT(image);
@@ -276,52 +437,60 @@ void Loader::HandleImageUnload(LogEntry *e) {
                      data_start, data_size, bss_start, bss_size);
 }
 
-void Loader::HandleSyscallEntry(LogEntry *e) {
+void Loader::HandleSyscallEntry(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   int syscall_num = e->arg(0);
-  CALL_ANALYSIS_FUNC2(Syscall, SyscallEntry, self, curr_thd_clk, syscall_num);
+  for (AnalyzerContainer::iterator it = analyzers->begin();
+       it != analyzers->end(); ++it) {
+    if ((*it)->desc()->HookSyscall(syscall_num))
+      (*it)->SyscallEntry(self, curr_thd_clk, syscall_num);
+  }
 }
 
-void Loader::HandleSyscallExit(LogEntry *e) {
+void Loader::HandleSyscallExit(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   int syscall_num = e->arg(0);
-  CALL_ANALYSIS_FUNC2(Syscall, SyscallExit, self, curr_thd_clk, syscall_num);
+  for (AnalyzerContainer::iterator it = analyzers->begin();
+       it != analyzers->end(); ++it) {
+    if ((*it)->desc()->HookSyscall(syscall_num))
+      (*it)->SyscallExit(self, curr_thd_clk, syscall_num);
+  }
 }
 
-void Loader::HandleSignalReceived(LogEntry *e) {
+void Loader::HandleSignalReceived(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   int signal_num = e->arg(0);
   CALL_ANALYSIS_FUNC2(Signal, SignalReceived, self, curr_thd_clk, signal_num)
 }
 
-void Loader::HandleThreadStart(LogEntry *e) {
+void Loader::HandleThreadStart(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   thread_id_t parent = e->arg(0);
   CALL_ANALYSIS_FUNC(ThreadStart, self, parent);
 }
 
-void Loader::HandleThreadExit(LogEntry *e) {
+void Loader::HandleThreadExit(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   CALL_ANALYSIS_FUNC(ThreadExit, self, curr_thd_clk);
 }
 
-void Loader::HandleMain(LogEntry *e) {
+void Loader::HandleMain(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   CALL_ANALYSIS_FUNC2(MainFunc, Main, self, curr_thd_clk);
 }
 
-void Loader::HandleThreadMain(LogEntry *e) {
+void Loader::HandleThreadMain(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   CALL_ANALYSIS_FUNC2(MainFunc, ThreadMain, self, curr_thd_clk);
 }
 
-void Loader::HandleBeforeMemRead(LogEntry *e) {
+void Loader::HandleBeforeMemRead(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -332,7 +501,7 @@ void Loader::HandleBeforeMemRead(LogEntry *e) {
                       inst, addr, size);
 }
 
-void Loader::HandleAfterMemRead(LogEntry *e) {
+void Loader::HandleAfterMemRead(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -343,7 +512,7 @@ void Loader::HandleAfterMemRead(LogEntry *e) {
                       inst, addr, size);
 }
 
-void Loader::HandleBeforeMemWrite(LogEntry *e) {
+void Loader::HandleBeforeMemWrite(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -354,7 +523,7 @@ void Loader::HandleBeforeMemWrite(LogEntry *e) {
                       inst, addr, size);
 }
 
-void Loader::HandleAfterMemWrite(LogEntry *e) {
+void Loader::HandleAfterMemWrite(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -365,7 +534,7 @@ void Loader::HandleAfterMemWrite(LogEntry *e) {
                       inst, addr, size);
 }
 
-void Loader::HandleBeforeAtomicInst(LogEntry *e) {
+void Loader::HandleBeforeAtomicInst(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -376,7 +545,7 @@ void Loader::HandleBeforeAtomicInst(LogEntry *e) {
                       inst, type, addr);
 }
 
-void Loader::HandleAfterAtomicInst(LogEntry *e) {
+void Loader::HandleAfterAtomicInst(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -387,7 +556,8 @@ void Loader::HandleAfterAtomicInst(LogEntry *e) {
                       inst, type, addr);
 }
 
-void Loader::HandleBeforePthreadCreate(LogEntry *e) {
+void Loader::HandleBeforePthreadCreate(AnalyzerContainer *analyzers,
+                                       LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -396,7 +566,8 @@ void Loader::HandleBeforePthreadCreate(LogEntry *e) {
                       curr_thd_clk, inst);
 }
 
-void Loader::HandleAfterPthreadCreate(LogEntry *e) {
+void Loader::HandleAfterPthreadCreate(AnalyzerContainer *analyzers,
+                                      LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -406,7 +577,8 @@ void Loader::HandleAfterPthreadCreate(LogEntry *e) {
                       curr_thd_clk, inst, child_thd_id);
 }
 
-void Loader::HandleBeforePthreadJoin(LogEntry *e) {
+void Loader::HandleBeforePthreadJoin(AnalyzerContainer *analyzers,
+                                     LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -416,7 +588,7 @@ void Loader::HandleBeforePthreadJoin(LogEntry *e) {
                       curr_thd_clk, inst, child_thd_id);
 }
 
-void Loader::HandleAfterPthreadJoin(LogEntry *e) {
+void Loader::HandleAfterPthreadJoin(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -426,7 +598,8 @@ void Loader::HandleAfterPthreadJoin(LogEntry *e) {
                       curr_thd_clk, inst, child_thd_id);
 }
 
-void Loader::HandleBeforePthreadMutexTryLock(LogEntry *e) {
+void Loader::HandleBeforePthreadMutexTryLock(AnalyzerContainer *analyzers,
+                                             LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -436,7 +609,8 @@ void Loader::HandleBeforePthreadMutexTryLock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr);
 }
 
-void Loader::HandleAfterPthreadMutexTryLock(LogEntry *e) {
+void Loader::HandleAfterPthreadMutexTryLock(AnalyzerContainer *analyzers,
+                                            LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -447,7 +621,8 @@ void Loader::HandleAfterPthreadMutexTryLock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr, ret_val);
 }
 
-void Loader::HandleBeforePthreadMutexLock(LogEntry *e) {
+void Loader::HandleBeforePthreadMutexLock(AnalyzerContainer *analyzers,
+                                          LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -457,7 +632,8 @@ void Loader::HandleBeforePthreadMutexLock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr);
 }
 
-void Loader::HandleAfterPthreadMutexLock(LogEntry *e) {
+void Loader::HandleAfterPthreadMutexLock(AnalyzerContainer *analyzers,
+                                         LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -467,7 +643,8 @@ void Loader::HandleAfterPthreadMutexLock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr);
 }
 
-void Loader::HandleBeforePthreadMutexUnlock(LogEntry *e) {
+void Loader::HandleBeforePthreadMutexUnlock(AnalyzerContainer *analyzers,
+                                            LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -477,7 +654,8 @@ void Loader::HandleBeforePthreadMutexUnlock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr);
 }
 
-void Loader::HandleAfterPthreadMutexUnlock(LogEntry *e) {
+void Loader::HandleAfterPthreadMutexUnlock(AnalyzerContainer *analyzers,
+                                           LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -487,7 +665,8 @@ void Loader::HandleAfterPthreadMutexUnlock(LogEntry *e) {
                       curr_thd_clk, inst, mutex_addr);
 }
 
-void Loader::HandleBeforePthreadCondSignal(LogEntry *e) {
+void Loader::HandleBeforePthreadCondSignal(AnalyzerContainer *analyzers,
+                                           LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -497,7 +676,8 @@ void Loader::HandleBeforePthreadCondSignal(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr);
 }
 
-void Loader::HandleAfterPthreadCondSignal(LogEntry *e) {
+void Loader::HandleAfterPthreadCondSignal(AnalyzerContainer *analyzers,
+                                          LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -507,7 +687,8 @@ void Loader::HandleAfterPthreadCondSignal(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr);
 }
 
-void Loader::HandleBeforePthreadCondBroadcast(LogEntry *e) {
+void Loader::HandleBeforePthreadCondBroadcast(AnalyzerContainer *analyzers,
+                                              LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -517,7 +698,8 @@ void Loader::HandleBeforePthreadCondBroadcast(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr);
 }
 
-void Loader::HandleAfterPthreadCondBroadcast(LogEntry *e) {
+void Loader::HandleAfterPthreadCondBroadcast(AnalyzerContainer *analyzers,
+                                             LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -527,7 +709,8 @@ void Loader::HandleAfterPthreadCondBroadcast(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr);
 }
 
-void Loader::HandleBeforePthreadCondWait(LogEntry *e) {
+void Loader::HandleBeforePthreadCondWait(AnalyzerContainer *analyzers,
+                                         LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -538,7 +721,8 @@ void Loader::HandleBeforePthreadCondWait(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr, mutex_addr);
 }
 
-void Loader::HandleAfterPthreadCondWait(LogEntry *e) {
+void Loader::HandleAfterPthreadCondWait(AnalyzerContainer *analyzers,
+                                        LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -549,7 +733,8 @@ void Loader::HandleAfterPthreadCondWait(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr, mutex_addr);
 }
 
-void Loader::HandleBeforePthreadCondTimedwait(LogEntry *e) {
+void Loader::HandleBeforePthreadCondTimedwait(AnalyzerContainer *analyzers,
+                                              LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -560,7 +745,8 @@ void Loader::HandleBeforePthreadCondTimedwait(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr, mutex_addr);
 }
 
-void Loader::HandleAfterPthreadCondTimedwait(LogEntry *e) {
+void Loader::HandleAfterPthreadCondTimedwait(AnalyzerContainer *analyzers,
+                                             LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -571,7 +757,8 @@ void Loader::HandleAfterPthreadCondTimedwait(LogEntry *e) {
                       curr_thd_clk, inst, cond_addr, mutex_addr);
 }
 
-void Loader::HandleBeforePthreadBarrierInit(LogEntry *e) {
+void Loader::HandleBeforePthreadBarrierInit(AnalyzerContainer *analyzers,
+                                            LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -582,7 +769,8 @@ void Loader::HandleBeforePthreadBarrierInit(LogEntry *e) {
                       curr_thd_clk, inst, addr, count);
 }
 
-void Loader::HandleAfterPthreadBarrierInit(LogEntry *e) {
+void Loader::HandleAfterPthreadBarrierInit(AnalyzerContainer *analyzers,
+                                           LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -593,7 +781,8 @@ void Loader::HandleAfterPthreadBarrierInit(LogEntry *e) {
                       curr_thd_clk, inst, addr, count);
 }
 
-void Loader::HandleBeforePthreadBarrierWait(LogEntry *e) {
+void Loader::HandleBeforePthreadBarrierWait(AnalyzerContainer *analyzers,
+                                            LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -603,7 +792,8 @@ void Loader::HandleBeforePthreadBarrierWait(LogEntry *e) {
                       curr_thd_clk, inst, barrier_addr);
 }
 
-void Loader::HandleAfterPthreadBarrierWait(LogEntry *e) {
+void Loader::HandleAfterPthreadBarrierWait(AnalyzerContainer *analyzers,
+                                           LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -613,7 +803,7 @@ void Loader::HandleAfterPthreadBarrierWait(LogEntry *e) {
                       curr_thd_clk, inst, barrier_addr);
 }
 
-void Loader::HandleBeforeMalloc(LogEntry *e) {
+void Loader::HandleBeforeMalloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -623,7 +813,7 @@ void Loader::HandleBeforeMalloc(LogEntry *e) {
                       curr_thd_clk, inst, size);
 }
 
-void Loader::HandleAfterMalloc(LogEntry *e) {
+void Loader::HandleAfterMalloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -634,7 +824,7 @@ void Loader::HandleAfterMalloc(LogEntry *e) {
                       curr_thd_clk, inst, size, ret_val);
 }
 
-void Loader::HandleBeforeCalloc(LogEntry *e) {
+void Loader::HandleBeforeCalloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -645,7 +835,7 @@ void Loader::HandleBeforeCalloc(LogEntry *e) {
                       curr_thd_clk, inst, nmemb, size);
 }
 
-void Loader::HandleAfterCalloc(LogEntry *e) {
+void Loader::HandleAfterCalloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -657,7 +847,7 @@ void Loader::HandleAfterCalloc(LogEntry *e) {
                       curr_thd_clk, inst, nmemb, size, ret_val);
 }
 
-void Loader::HandleBeforeRealloc(LogEntry *e) {
+void Loader::HandleBeforeRealloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -668,7 +858,7 @@ void Loader::HandleBeforeRealloc(LogEntry *e) {
                       curr_thd_clk, inst, ptr, size);
 }
 
-void Loader::HandleAfterRealloc(LogEntry *e) {
+void Loader::HandleAfterRealloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -680,7 +870,7 @@ void Loader::HandleAfterRealloc(LogEntry *e) {
                       curr_thd_clk, inst, ptr, size, ret_val);
 }
 
-void Loader::HandleBeforeFree(LogEntry *e) {
+void Loader::HandleBeforeFree(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -690,7 +880,7 @@ void Loader::HandleBeforeFree(LogEntry *e) {
                       curr_thd_clk, inst, ptr);
 }
 
-void Loader::HandleAfterFree(LogEntry *e) {
+void Loader::HandleAfterFree(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -700,7 +890,7 @@ void Loader::HandleAfterFree(LogEntry *e) {
                       curr_thd_clk, inst, ptr);
 }
 
-void Loader::HandleBeforeValloc(LogEntry *e) {
+void Loader::HandleBeforeValloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
@@ -710,7 +900,7 @@ void Loader::HandleBeforeValloc(LogEntry *e) {
                       curr_thd_clk, inst, size);
 }
 
-void Loader::HandleAfterValloc(LogEntry *e) {
+void Loader::HandleAfterValloc(AnalyzerContainer *analyzers, LogEntry *e) {
   thread_id_t self = e->thd_id();
   timestamp_t curr_thd_clk = e->thd_clk();
   Inst *inst = sinfo_->FindInst(e->inst_id());
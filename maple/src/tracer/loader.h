@@ -19,7 +19,9 @@
 #ifndef TRACER_LOADER_H_
 #define TRACER_LOADER_H_
 
+#include <deque>
 #include <list>
+#include <vector>
 
 #include "core/basictypes.h"
 #include "core/sync.h"
@@ -40,70 +42,139 @@ class Loader : public OfflineTool {
 
  protected:
   typedef std::list<Analyzer *> AnalyzerContainer;
+  typedef std::vector<LogEntryProto> EntryBatch;
+
+  // A replay shard owns its own analyzer instances and replays them on a
+  // separate thread. It receives the memory accesses that fall into its
+  // address partition and all the other (synchronization) events.
+  class Shard {
+   public:
+    explicit Shard(int id);
+    ~Shard();
+
+    LogEntryProto *Append(LogEntryProto *proto);
+    void Flush();
+    void Push(EntryBatch *batch);
+    EntryBatch *Pop();
+
+    int id_;
+    pthread_t thread_;
+    AnalyzerContainer analyzers_;
+    EntryBatch *curr_batch_;
+    std::deque<EntryBatch *> queue_;
+    SysMutex lock_;
+    SysSemaphore items_sem_;
+    SysSemaphore slots_sem_;
+
+   private:
+    DISALLOW_COPY_CONSTRUCTORS(Shard);
+  };
+
+  typedef std::vector<Shard *> ShardVec;
+
+  virtual Mutex *CreateMutex() { return new SysMutex; }
 
   virtual void HandlePreSetup();
   virtual void HandlePostSetup();
   virtual void HandleStart();
-  virtual void HandleProgramStart(LogEntry *e);
-  virtual void HandleProgramExit(LogEntry *e);
-  virtual void HandleImageLoad(LogEntry *e);
-  virtual void HandleImageUnload(LogEntry *e);
-  virtual void HandleSyscallEntry(LogEntry *e);
-  virtual void HandleSyscallExit(LogEntry *e);
-  virtual void HandleSignalReceived(LogEntry *e);
-  virtual void HandleThreadStart(LogEntry *e);
-  virtual void HandleThreadExit(LogEntry *e);
-  virtual void HandleMain(LogEntry *e);
-  virtual void HandleThreadMain(LogEntry *e);
-  virtual void HandleBeforeMemRead(LogEntry *e);
-  virtual void HandleAfterMemRead(LogEntry *e);
-  virtual void HandleBeforeMemWrite(LogEntry *e);
-  virtual void HandleAfterMemWrite(LogEntry *e);
-  virtual void HandleBeforeAtomicInst(LogEntry *e);
-  virtual void HandleAfterAtomicInst(LogEntry *e);
-  virtual void HandleBeforePthreadCreate(LogEntry *e);
-  virtual void HandleAfterPthreadCreate(LogEntry *e);
-  virtual void HandleBeforePthreadJoin(LogEntry *e);
-  virtual void HandleAfterPthreadJoin(LogEntry *e);
-  virtual void HandleBeforePthreadMutexTryLock(LogEntry *e);
-  virtual void HandleAfterPthreadMutexTryLock(LogEntry *e);
-  virtual void HandleBeforePthreadMutexLock(LogEntry *e);
-  virtual void HandleAfterPthreadMutexLock(LogEntry *e);
-  virtual void HandleBeforePthreadMutexUnlock(LogEntry *e);
-  virtual void HandleAfterPthreadMutexUnlock(LogEntry *e);
-  virtual void HandleBeforePthreadCondSignal(LogEntry *e);
-  virtual void HandleAfterPthreadCondSignal(LogEntry *e);
-  virtual void HandleBeforePthreadCondBroadcast(LogEntry *e);
-  virtual void HandleAfterPthreadCondBroadcast(LogEntry *e);
-  virtual void HandleBeforePthreadCondWait(LogEntry *e);
-  virtual void HandleAfterPthreadCondWait(LogEntry *e);
-  virtual void HandleBeforePthreadCondTimedwait(LogEntry *e);
-  virtual void HandleAfterPthreadCondTimedwait(LogEntry *e);
-  virtual void HandleBeforePthreadBarrierInit(LogEntry *e);
-  virtual void HandleAfterPthreadBarrierInit(LogEntry *e);
-  virtual void HandleBeforePthreadBarrierWait(LogEntry *e);
-  virtual void HandleAfterPthreadBarrierWait(LogEntry *e);
-  virtual void HandleBeforeMalloc(LogEntry *e);
-  virtual void HandleAfterMalloc(LogEntry *e);
-  virtual void HandleBeforeCalloc(LogEntry *e);
-  virtual void HandleAfterCalloc(LogEntry *e);
-  virtual void HandleBeforeRealloc(LogEntry *e);
-  virtual void HandleAfterRealloc(LogEntry *e);
-  virtual void HandleBeforeFree(LogEntry *e);
-  virtual void HandleAfterFree(LogEntry *e);
-  virtual void HandleBeforeValloc(LogEntry *e);
-  virtual void HandleAfterValloc(LogEntry *e);
+  virtual void HandleProgramStart(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleProgramExit(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleImageLoad(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleImageUnload(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleSyscallEntry(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleSyscallExit(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleSignalReceived(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleThreadStart(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleThreadExit(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleMain(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleThreadMain(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeMemRead(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterMemRead(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeMemWrite(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterMemWrite(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeAtomicInst(AnalyzerContainer *analyzers,
+                                      LogEntry *e);
+  virtual void HandleAfterAtomicInst(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforePthreadCreate(AnalyzerContainer *analyzers,
+                                         LogEntry *e);
+  virtual void HandleAfterPthreadCreate(AnalyzerContainer *analyzers,
+                                        LogEntry *e);
+  virtual void HandleBeforePthreadJoin(AnalyzerContainer *analyzers,
+                                       LogEntry *e);
+  virtual void HandleAfterPthreadJoin(AnalyzerContainer *analyzers,
+                                      LogEntry *e);
+  virtual void HandleBeforePthreadMutexTryLock(AnalyzerContainer *analyzers,
+                                               LogEntry *e);
+  virtual void HandleAfterPthreadMutexTryLock(AnalyzerContainer *analyzers,
+                                              LogEntry *e);
+  virtual void HandleBeforePthreadMutexLock(AnalyzerContainer *analyzers,
+                                            LogEntry *e);
+  virtual void HandleAfterPthreadMutexLock(AnalyzerContainer *analyzers,
+                                           LogEntry *e);
+  virtual void HandleBeforePthreadMutexUnlock(AnalyzerContainer *analyzers,
+                                              LogEntry *e);
+  virtual void HandleAfterPthreadMutexUnlock(AnalyzerContainer *analyzers,
+                                             LogEntry *e);
+  virtual void HandleBeforePthreadCondSignal(AnalyzerContainer *analyzers,
+                                             LogEntry *e);
+  virtual void HandleAfterPthreadCondSignal(AnalyzerContainer *analyzers,
+                                            LogEntry *e);
+  virtual void HandleBeforePthreadCondBroadcast(AnalyzerContainer *analyzers,
+                                                LogEntry *e);
+  virtual void HandleAfterPthreadCondBroadcast(AnalyzerContainer *analyzers,
+                                               LogEntry *e);
+  virtual void HandleBeforePthreadCondWait(AnalyzerContainer *analyzers,
+                                           LogEntry *e);
+  virtual void HandleAfterPthreadCondWait(AnalyzerContainer *analyzers,
+                                          LogEntry *e);
+  virtual void HandleBeforePthreadCondTimedwait(AnalyzerContainer *analyzers,
+                                                LogEntry *e);
+  virtual void HandleAfterPthreadCondTimedwait(AnalyzerContainer *analyzers,
+                                               LogEntry *e);
+  virtual void HandleBeforePthreadBarrierInit(AnalyzerContainer *analyzers,
+                                              LogEntry *e);
+  virtual void HandleAfterPthreadBarrierInit(AnalyzerContainer *analyzers,
+                                             LogEntry *e);
+  virtual void HandleBeforePthreadBarrierWait(AnalyzerContainer *analyzers,
+                                              LogEntry *e);
+  virtual void HandleAfterPthreadBarrierWait(AnalyzerContainer *analyzers,
+                                             LogEntry *e);
+  virtual void HandleBeforeMalloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterMalloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeCalloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterCalloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeRealloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterRealloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeFree(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterFree(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleBeforeValloc(AnalyzerContainer *analyzers, LogEntry *e);
+  virtual void HandleAfterValloc(AnalyzerContainer *analyzers, LogEntry *e);
+
+  // per shard hooks: create the analyzers of a shard before the replay
+  // starts and merge their results after the replay finishes
+  virtual void HandleShardSetup(int shard_id, AnalyzerContainer *analyzers);
+  virtual void HandleShardMerge(int shard_id, AnalyzerContainer *analyzers);
 
   void EventLoop();
-  void HandleEvent(LogEntry *e);
+  void HandleEvent(AnalyzerContainer *analyzers, LogEntry *e);
   void AddAnalyzer(Analyzer *analyzer);
+  void StartShards();
+  void StopShards();
+  void DispatchEvent(LogEntry *e);
+  void RouteMemEvent(LogEntry *e);
+  Shard *GetShard(address_t addr);
+  void ShardMain(Shard *shard);
 
   TraceLog *trace_log_;
   AnalyzerContainer analyzers_;
   Descriptor desc_;
   DebugAnalyzer *debug_analyzer_;
+  ShardVec shards_;
+  address_t shard_unit_;
 
  private:
+  static void *__ShardMain(void *arg);
+
   DISALLOW_COPY_CONSTRUCTORS(Loader);
 };
 
@@ -90,6 +90,7 @@ class LogEntry {
 
  private:
   friend class TraceLog;
+  friend class Loader;
 };
 
 typedef uint64 trace_log_uid_t;
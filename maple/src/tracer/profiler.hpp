@@ -39,6 +39,9 @@ class Profiler : public ExecutionControl {
   bool HandleIgnoreMemAccess(IMG img);
 
   RecorderAnalyzer *recorder_;
+  // knobs used after setup
+  BoolKnobHandle ignore_lib_;
+  BoolKnobHandle ignore_ic_pthread_;
 
   DISALLOW_COPY_CONSTRUCTORS(Profiler);
 };
@@ -0,0 +1,66 @@
+"""Copyright 2011 The University of Michigan
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Authors - Jie Yu (jieyu@umich.edu)
+"""
+
+from maple.core import logging
+from maple.core import static_info
+from maple.idiom import iroot
+from maple.idiom import memo
+
+"""
+Expected Results:
+-----------------
+Replaying the trace in 4 shards predicts exactly the same set of iroots as
+replaying it in 1 shard. iroot ids may differ between the two runs, so the
+iroots are compared by their idioms and events.
+"""
+
+def num_shards():
+    return [1, 4]
+
+def setup_recorder(recorder):
+    recorder.knobs['ignore_lib'] = True
+
+def setup_loader(loader):
+    loader.knobs['shard_unit'] = 64
+
+def predicted_set(loader):
+    sinfo = static_info.StaticInfo()
+    sinfo.load(loader.knobs['sinfo_in'])
+    iroot_db = iroot.iRootDB(sinfo)
+    iroot_db.load(loader.knobs['iroot_out'])
+    memo_db = memo.Memo(sinfo, iroot_db)
+    memo_db.load(loader.knobs['memo_out'])
+    results = set()
+    for iroot_info in memo_db.predicted_set:
+        r = iroot_info.iroot()
+        events = []
+        for idx in range(len(r.proto.event_id)):
+            e = r.event(idx)
+            events.append((e.inst().id(), e.type()))
+        results.add((r.idiom(), tuple(events)))
+    return results
+
+def verify(loaders):
+    expected = predicted_set(loaders[1])
+    if len(expected) == 0:
+        logging.msg('nothing predicted\n')
+        return False
+    for num_shards, loader in loaders.iteritems():
+        if predicted_set(loader) != expected:
+            logging.msg('predicted set mismatch (%d shards)\n' % num_shards)
+            return False
+    return True
@@ -0,0 +1,61 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+
+#define NUM_THREADS 2
+
+// heap mutexes, so that the search nodes refer to dynamic objects
+pthread_mutex_t *mutex0 = NULL;
+pthread_mutex_t *mutex1 = NULL;
+
+pthread_mutex_t *new_mutex() {
+  static pthread_mutex_t init = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_t *mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
+  *mutex = init;
+  return mutex;
+}
+
+void *thread0(void *arg) {
+  int res;
+  res = pthread_mutex_lock(mutex0);
+  res = pthread_mutex_unlock(mutex0);
+  return NULL;
+}
+
+void *thread1(void *arg) {
+  int res;
+  res = pthread_mutex_lock(mutex1);
+  res = pthread_mutex_unlock(mutex1);
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  pthread_t tids[NUM_THREADS];
+  mutex0 = new_mutex();
+  mutex1 = new_mutex();
+  pthread_create(&tids[0], NULL, thread0, NULL);
+  pthread_create(&tids[1], NULL, thread1, NULL);
+  pthread_join(tids[0], NULL);
+  pthread_join(tids[1], NULL);
+  free(mutex0);
+  free(mutex1);
+  return 0;
+}
+
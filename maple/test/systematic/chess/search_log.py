@@ -0,0 +1,83 @@
+"""Copyright 2011 The University of Michigan
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Authors - Jie Yu (jieyu@umich.edu)
+"""
+
+import os
+import struct
+from maple.core import logging
+from maple.core import static_info
+from maple.systematic import program
+from maple.systematic import search
+from maple.regression import common
+
+def source_name():
+    return __name__ + common.cxx_ext()
+
+def setup_controller(controller):
+    controller.debug = True
+    controller.knobs['por'] = False
+    controller.knobs['fair'] = False
+    controller.knobs['pb_limit'] = 1
+    # compact rarely, so that the log holds nodes popped in later runs
+    controller.knobs['search_compact'] = 3
+
+def setup_testcase(testcase):
+    testcase.mode = 'finish'
+
+def persisted_nodes(db_name):
+    # all the nodes on disk: the snapshot and every live log entry,
+    # including the nodes that later entries overwrite
+    info = search.search_pb2().SearchInfoProto()
+    f = open(db_name, 'rb')
+    info.ParseFromString(f.read())
+    f.close()
+    nodes = list(info.node)
+    log_name = db_name + '.log'
+    if not os.path.exists(log_name):
+        return nodes
+    f = open(log_name, 'rb')
+    data = f.read()
+    f.close()
+    pos = 0
+    while pos + 4 <= len(data):
+        size = struct.unpack('<I', data[pos:pos+4])[0]
+        update = search.search_pb2().SearchUpdateProto()
+        update.ParseFromString(data[pos+4:pos+4+size])
+        pos += 4 + size
+        if update.log_id == info.log_id:
+            nodes.extend(update.node)
+    return nodes
+
+def verify(controller, testcase):
+    if testcase.is_fatal():
+        return False
+    sinfo = static_info.StaticInfo()
+    sinfo.load(controller.knobs['sinfo_out'])
+    prog = program.Program(sinfo)
+    prog.load(controller.knobs['program_out'])
+    search_info = search.SearchInfo(sinfo, prog)
+    search_info.load(controller.knobs['search_out'])
+    if search_info.num_runs() != 8:
+        return False
+    # every object the search info refers to must be in the program db
+    for node_proto in persisted_nodes(controller.knobs['search_out']):
+        for enabled_proto in node_proto.enabled:
+            if not enabled_proto.HasField('obj_uid'):
+                continue
+            if enabled_proto.obj_uid not in prog.object_map:
+                return False
+    return True
+
@@ -0,0 +1,50 @@
+// Copyright 2011 The University of Michigan
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors - Jie Yu (jieyu@umich.edu)
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+
+#define NUM_THREADS 3
+#define NUM_ITERS 2
+
+pthread_mutex_t mutex0 = PTHREAD_MUTEX_INITIALIZER;
+int order[NUM_THREADS * NUM_ITERS];
+int num_entered = 0;
+
+void *thread(void *arg) {
+  int id = (int)(long)arg;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    pthread_mutex_lock(&mutex0);
+    order[num_entered++] = id;
+    pthread_mutex_unlock(&mutex0);
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  pthread_t tids[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; i++)
+    pthread_create(&tids[i], NULL, thread, (void *)(long)i);
+  for (int i = 0; i < NUM_THREADS; i++)
+    pthread_join(tids[i], NULL);
+  // the order depends on the schedule
+  for (int i = 0; i < NUM_THREADS * NUM_ITERS; i++)
+    printf("%d", order[i]);
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,58 @@
+"""Copyright 2011 The University of Michigan
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Authors - Jie Yu (jieyu@umich.edu)
+"""
+
+from maple.core import proto
+from maple.regression import common
+
+def source_name():
+    return __name__ + common.cxx_ext()
+
+def load_schedule(db_name):
+    schedule = proto.module('systematic.schedule_pb2').ScheduleProto()
+    f = open(db_name, 'rb')
+    schedule.ParseFromString(f.read())
+    f.close()
+    return schedule
+
+def program_output(output_path):
+    # the last line printed by the test program
+    f = open(output_path, 'r')
+    lines = [l.strip() for l in f.readlines() if l.strip().isdigit()]
+    f.close()
+    return lines[-1] if lines else None
+
+def verify(record, replay, missing):
+    # replaying a missing schedule must fail instead of running free
+    if not missing.test.is_fatal():
+        return False
+    if record.test.is_fatal() or replay.test.is_fatal():
+        return False
+    f = open(replay.output_path, 'r')
+    diverged = 'diverged' in f.read()
+    f.close()
+    if diverged:
+        return False
+    record_schedule = load_schedule(record.controller.knobs['schedule_out'])
+    replay_schedule = load_schedule(replay.controller.knobs['schedule_out'])
+    if len(record_schedule.step) == 0:
+        return False
+    if list(record_schedule.step) != list(replay_schedule.step):
+        return False
+    output = program_output(record.output_path)
+    if output == None or output != program_output(replay.output_path):
+        return False
+    return True
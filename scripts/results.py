@@ -0,0 +1,141 @@
+#! /usr/bin/env python
+
+# Loads the per execution result records (*.results.jsonl) written by the
+# runner into an indexed store, so that tabulation does not need to scan
+# the text logs. The parsed records are cached in a pickle next to the
+# results and only files that changed since the last load are re-read.
+#
+# Result file names follow the log file names:
+#   date--suite--test--boundType--boundValue--.results.jsonl
+# where boundValue is "bound" or "bound,seed,startIndex" (pct and random).
+
+import os
+import sys
+import json
+import csv
+from os import path
+
+import cPickle as pickle
+
+cacheName = "results.idx"
+
+# bug kinds that do not count as finding a bug (step_limit and livelock
+# are executions ended by the controller watchdog)
+notBugs = ["none", "interrupted", "step_limit", "livelock"]
+
+def isBuggy(record):
+    return record["bug"] not in notBugs
+
+class RunResults(object):
+    # the records of one (benchmark, boundType, bound), by schedule index
+    def __init__(self):
+        self.records = []
+
+    def add(self, records):
+        self.records.extend(records)
+        self.records.sort(key=lambda r: r["index"])
+
+    def numSchedules(self):
+        return len(self.records)
+
+    def numBuggy(self):
+        return sum(1 for r in self.records if isBuggy(r))
+
+    def numBeforeBuggy(self):
+        # the number of schedules up to and including the first buggy one
+        for i, r in enumerate(self.records):
+            if isBuggy(r):
+                return i + 1
+        return -1
+
+    def maxOf(self, field):
+        return max([r.get(field, -1) for r in self.records] + [-1])
+
+class ResultsStore(object):
+    def __init__(self):
+        # (suite--test, boundType, bound) -> RunResults
+        self.runs = {}
+        # file name -> ((mtime, size), key, records)
+        self.files = {}
+
+    def benchmarks(self):
+        return sorted(set(k[0] for k in self.runs))
+
+    def get(self, name, boundType, bound):
+        return self.runs.get((name, boundType, bound))
+
+    def bounds(self, name, boundType):
+        return sorted(k[2] for k in self.runs
+                      if k[0] == name and k[1] == boundType)
+
+    def rebuild(self):
+        self.runs = {}
+        for (stamp, key, records) in self.files.values():
+            if key not in self.runs:
+                self.runs[key] = RunResults()
+            self.runs[key].add(records)
+
+def parseKey(filename):
+    parts = filename.split("--")
+    name = parts[1] + "--" + parts[2]
+    bound = int(parts[4].split(",")[0])
+    return (name, parts[3], bound)
+
+def readRecords(filename):
+    records = []
+    with open(filename, 'r') as f:
+        for line in f:
+            line = line.strip()
+            if len(line) > 0:
+                records.append(json.loads(line))
+    return records
+
+def load(resultsdir):
+    cache = path.join(resultsdir, cacheName)
+    store = ResultsStore()
+    if path.exists(cache):
+        # only the parsed files are cached (plain data, no classes)
+        with open(cache, 'rb') as f:
+            store.files = pickle.load(f)
+
+    seen = set()
+    changed = False
+    for root, dirs, files in os.walk(resultsdir):
+        for f in files:
+            if not f.endswith(".results.jsonl"):
+                continue
+            full = path.join(root, f)
+            seen.add(full)
+            st = os.stat(full)
+            stamp = (st.st_mtime, st.st_size)
+            if full in store.files and store.files[full][0] == stamp:
+                continue
+            store.files[full] = (stamp, parseKey(f), readRecords(full))
+            changed = True
+    for full in store.files.keys():
+        if full not in seen:
+            del store.files[full]
+            changed = True
+
+    if changed or not path.exists(cache):
+        with open(cache, 'wb') as f:
+            pickle.dump(store.files, f, pickle.HIGHEST_PROTOCOL)
+    store.rebuild()
+    return store
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print "USAGE: ", sys.argv[0], "resultsdir"
+        sys.exit(1)
+
+    store = load(sys.argv[1])
+    writer = csv.writer(sys.stdout)
+    writer.writerow(["name", "boundType", "bound", "schedules", "buggy",
+                     "beforeBuggy", "maxSteps", "maxThreads",
+                     "maxPreemptions"])
+    for (name, boundType, bound) in sorted(store.runs.keys()):
+        run = store.runs[(name, boundType, bound)]
+        writer.writerow([name, boundType, bound, run.numSchedules(),
+                         run.numBuggy(), run.numBeforeBuggy(),
+                         run.maxOf("steps"), run.maxOf("threads"),
+                         run.maxOf("preemptions")])
@@ -107,6 +107,32 @@ def commandLine ():
                           help="Which benchmark to execute.",
                           default=-1)
     
+    cmdline.add_argument("-sl",
+                         "--steplimit",
+                          action="store",
+                          type=int,
+                          help="End an execution after this many scheduling steps (0 for no limit).",
+                          default=0)
+    
+    cmdline.add_argument("-ll",
+                         "--livelock",
+                          action="store",
+                          type=int,
+                          help="End an execution after this many idle windows in a row, where every enabled thread yields without progress (0 to disable).",
+                          default=0)
+    
+    cmdline.add_argument("-vt",
+                         "--virtualtime",
+                          action="store_true",
+                          help="Model sleeps, poll/select timeouts and clock reads with a virtual clock instead of waiting in real time.",
+                          default=False)
+    
+    cmdline.add_argument("-tp",
+                         "--throughput",
+                          action="store_true",
+                          help="Write a throughput report (schedules/s, visible ops/s, per execution costs) for each benchmark.",
+                          default=False)
+    
     return cmdline.parse_args()
 
 def call_check(cmd, qsubargs):
@@ -127,6 +153,12 @@ if __name__ == "__main__":
     outdir = path.join(os.environ["ROOT"],"benchmarks","__results",time.strftime("%Y-%m-%d-%H-%M-%S"))
     mkdir_p(outdir)
 
+    if args.throughput:
+        os.environ["throughput"]="1"
+    os.environ["step_limit"]=str(args.steplimit)
+    os.environ["livelock_windows"]=str(args.livelock)
+    os.environ["virtual_time"]="1" if args.virtualtime else "0"
+
     limit = int(args.limit)
     seed = 0
     numJobs = int(args.numjobs)
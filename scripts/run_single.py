@@ -69,9 +69,23 @@ class Command(object):
         return self.process.returncode
 
 
+def resultsfilename(outfile):
+    return path.splitext(outfile)[0] + ".results.jsonl"
+
 def getExecutionInfo(outfile):
     numExecutions = 0
     timeout = False
+    resultsfile = resultsfilename(outfile)
+    if path.exists(resultsfile):
+        # one record per finished execution; the timeout marker is at
+        # the end of the log
+        with open(resultsfile, 'r') as f:
+            numExecutions = sum(1 for line in f if line.strip())
+        with open(outfile, 'r') as f:
+            f.seek(0, os.SEEK_END)
+            f.seek(max(f.tell() - 4096, 0))
+            timeout = "TIMEOUT OCCURRED" in f.read()
+        return numExecutions, timeout
     with open(outfile, 'r') as f:
         for line in f:
             if line.startswith("finished execution"):
@@ -90,6 +104,10 @@ def run(test, timeout, outfile):
     sys.stdout.flush()
     os.environ["timeout"] = str(timeout)
     fulloutfile = outfile
+    # the runner writes its result records and throughput report next to
+    # the output file
+    os.environ["results_out"] = resultsfilename(fulloutfile)
+    os.environ["throughput_out"] = path.splitext(fulloutfile)[0] + ".throughput.json"
     if os.environ["cluster"]=="1":
         outfile = path.join(os.environ["TMPDIR"], path.basename(outfile))
     command = Command(cmd)
@@ -151,6 +169,8 @@ if __name__ == "__main__":
     os.environ["start_index"]=str(startIndex)
     os.environ["seed"]=str(seed)
     
+    os.environ["throughput_name"]=suite+"/"+test
+    
     if mode == "race":
         os.environ["mode"]="race" 
         for i in range(min,max):
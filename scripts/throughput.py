@@ -0,0 +1,45 @@
+#! /usr/bin/env python
+
+# Summarizes the throughput reports written by run_many.py --throughput.
+# Prints one CSV row per benchmark run, slowest (fewest schedules/s) first.
+
+import os
+import sys
+import json
+import csv
+from os import path
+
+columns = ["name", "mode", "executions", "run_seconds",
+           "schedules_per_second", "visible_ops", "visible_ops_per_second"]
+
+perExecutionColumns = ["wall_us", "fixed_us", "pin_us", "us_startup",
+                       "us_program_load", "us_race_load", "us_sched_load",
+                       "us_program", "us_handoff", "us_sched_save",
+                       "us_program_save", "us_race_save"]
+
+def readReports(resultsdir):
+    reports = []
+    for root, dirs, files in os.walk(resultsdir):
+        for f in files:
+            if f.endswith(".throughput.json"):
+                with open(path.join(root, f), 'r') as fd:
+                    report = json.load(fd)
+                report["file"] = f
+                reports.append(report)
+    return reports
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print "USAGE: ", sys.argv[0], "resultsdir"
+        sys.exit(1)
+
+    reports = readReports(sys.argv[1])
+    reports.sort(key=lambda r: r["schedules_per_second"])
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(columns + perExecutionColumns + ["file"])
+    for r in reports:
+        row = [r.get(c, "") for c in columns]
+        row += [r["per_execution"].get(c, "") for c in perExecutionColumns]
+        row.append(r["file"])
+        writer.writerow(row)